@@ -63,6 +63,16 @@ SOURCES += main.cpp\
     b9printercomm.cpp \
     b9projector.cpp \
     b9edit/SliceEditView.cpp \
+    b9edit/sliceundobuffer.cpp \
+    b9edit/sliceprefetchcache.cpp \
+    b9edit/slicebatch.cpp \
+    b9edit/sliceimporter.cpp \
+    b9edit/sliceexporter.cpp \
+    b9edit/slicemorphology.cpp \
+    b9edit/sliceislandfinder.cpp \
+    b9edit/svgsliceimporter.cpp \
+    b9edit/slcsliceimporter.cpp \
+    b9edit/polygonfill.cpp \
     b9edit/floodfill.cpp \
     b9edit/DrawingContext.cpp \
     b9edit/b9edit.cpp \
@@ -73,6 +83,17 @@ SOURCES += main.cpp\
     dlgmaterialsmanager.cpp \
     b9matcat.cpp \
     b9print.cpp \
+    b9exposurescheduler.cpp \
+    b9printtelemetry.cpp \
+    b9framecache.cpp \
+    b9cyclemodel.cpp \
+    b9cycleplanner.cpp \
+    b9firmwaresim.cpp \
+    b9printer.cpp \
+    b9printcontroller.cpp \
+    b9logwriter.cpp \
+    b9printjournal.cpp \
+    b9exposureplan.cpp \
     b9layout/worldview.cpp \
     b9layout/utilityfunctions.cpp \
     b9layout/triangulate.cpp \
@@ -99,6 +120,16 @@ HEADERS  += mainwindow.h \
     b9printercomm.h \
     b9projector.h \
     b9edit/SliceEditView.h \
+    b9edit/sliceundobuffer.h \
+    b9edit/sliceprefetchcache.h \
+    b9edit/slicebatch.h \
+    b9edit/sliceimporter.h \
+    b9edit/sliceexporter.h \
+    b9edit/slicemorphology.h \
+    b9edit/sliceislandfinder.h \
+    b9edit/svgsliceimporter.h \
+    b9edit/slcsliceimporter.h \
+    b9edit/polygonfill.h \
     b9edit/floodfill.h \
     b9edit/DrawingContext.h \
     b9edit/b9edit.h \
@@ -109,6 +140,17 @@ HEADERS  += mainwindow.h \
     dlgmaterialsmanager.h \
     b9matcat.h \
     b9print.h \
+    b9exposurescheduler.h \
+    b9printtelemetry.h \
+    b9framecache.h \
+    b9cyclemodel.h \
+    b9cycleplanner.h \
+    b9firmwaresim.h \
+    b9printer.h \
+    b9printcontroller.h \
+    b9logwriter.h \
+    b9printjournal.h \
+    b9exposureplan.h \
     b9layout/worldview.h \
     b9layout/utlilityfunctions.h \
     b9layout/triangulate.h \
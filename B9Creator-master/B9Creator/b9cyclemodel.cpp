@@ -0,0 +1,168 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QStringList>
+#include <QtDebug>
+#include "b9cyclemodel.h"
+
+double B9CycleParts::nominalMS()
+{
+    double dMS = m_dDelayMS;
+    QMapIterator<int, double> z(m_vZ);
+    while(z.hasNext()){z.next(); dMS += z.value();}
+    QMapIterator<int, double> v(m_vVat);
+    while(v.hasNext()){v.next(); dMS += v.value();}
+    return dMS;
+}
+
+void B9CycleModel::reset()
+{
+    m_vZFactor.clear();
+    m_vVatFactor.clear();
+    m_vZCount.clear();
+    m_vVatCount.clear();
+    m_dOverheadMS = 0.0;
+    m_iCycles = 0;
+}
+
+void B9CycleModel::loadSettings(QSettings* pSettings)
+{
+    reset();
+    pSettings->beginGroup("CycleModel");
+    m_dOverheadMS = pSettings->value("OverheadMS",0.0).toDouble();
+    m_iCycles = pSettings->value("Cycles",0).toInt();
+    // stored as "speed:factor:count" entries
+    QStringList vZ = pSettings->value("Z").toStringList();
+    for(int i=0; i<vZ.size(); i++){
+        QStringList vEntry = vZ[i].split(':');
+        if(vEntry.size()!=3) continue;
+        m_vZFactor[vEntry[0].toInt()] = vEntry[1].toDouble();
+        m_vZCount[vEntry[0].toInt()] = vEntry[2].toInt();
+    }
+    QStringList vVat = pSettings->value("Vat").toStringList();
+    for(int i=0; i<vVat.size(); i++){
+        QStringList vEntry = vVat[i].split(':');
+        if(vEntry.size()!=3) continue;
+        m_vVatFactor[vEntry[0].toInt()] = vEntry[1].toDouble();
+        m_vVatCount[vEntry[0].toInt()] = vEntry[2].toInt();
+    }
+    pSettings->endGroup();
+}
+
+void B9CycleModel::saveSettings(QSettings* pSettings)
+{
+    QStringList vZ, vVat;
+    QMapIterator<int, double> z(m_vZFactor);
+    while(z.hasNext()){
+        z.next();
+        vZ.append(QString::number(z.key())+":"+QString::number(z.value(),'f',4)+":"+QString::number(m_vZCount.value(z.key())));
+    }
+    QMapIterator<int, double> v(m_vVatFactor);
+    while(v.hasNext()){
+        v.next();
+        vVat.append(QString::number(v.key())+":"+QString::number(v.value(),'f',4)+":"+QString::number(m_vVatCount.value(v.key())));
+    }
+    pSettings->beginGroup("CycleModel");
+    pSettings->setValue("OverheadMS",m_dOverheadMS);
+    pSettings->setValue("Cycles",m_iCycles);
+    pSettings->setValue("Z",vZ);
+    pSettings->setValue("Vat",vVat);
+    pSettings->endGroup();
+}
+
+double B9CycleModel::factor(QMap<int, double> &vFactor, QMap<int, int> &vCount, int iSpd)
+{
+    // Speeds we've measured are used as is, others are interpolated from the nearest measured speeds
+    if(vCount.value(iSpd)>0) return vFactor.value(iSpd);
+    if(vFactor.isEmpty()) return 1.0;
+    QMap<int, double>::const_iterator hi = vFactor.lowerBound(iSpd);
+    if(hi==vFactor.constEnd()) return (hi-1).value();
+    if(hi==vFactor.constBegin()) return hi.value();
+    QMap<int, double>::const_iterator lo = hi-1;
+    double dT = (double)(iSpd - lo.key())/(double)(hi.key() - lo.key());
+    return lo.value() + dT*(hi.value() - lo.value());
+}
+
+double B9CycleModel::estimateMS(B9CycleParts* pParts)
+{
+    double dMS = pParts->m_dDelayMS + m_dOverheadMS;
+    QMapIterator<int, double> z(pParts->m_vZ);
+    while(z.hasNext()){z.next(); dMS += zFactor(z.key())*z.value();}
+    QMapIterator<int, double> v(pParts->m_vVat);
+    while(v.hasNext()){v.next(); dMS += vatFactor(v.key())*v.value();}
+    return dMS;
+}
+
+bool B9CycleModel::learnCycle(B9CycleParts* pParts, double dMeasuredMS)
+{
+    double dNominalMS = pParts->nominalMS();
+    if(dNominalMS<=0.0 || dMeasuredMS<=0.0) return false;
+    // Stopped, jammed or paused cycles tell us nothing about travel times
+    if(dMeasuredMS > dNominalMS*CYCLEMODELMAXFACTOR + CYCLEMODELMAXOVERHEADMS || dMeasuredMS < dNominalMS*CYCLEMODELMINFACTOR*0.5){
+        qDebug() << "Cycle Model:  ignoring cycle of" << dMeasuredMS << "ms, nominal" << dNominalMS << "ms";
+        return false;
+    }
+
+    // Normalized LMS step, each term moves in proportion to its share of the cycle
+    // The overhead term is scaled to seconds so it doesn't soak up all of the error
+    double dErrorMS = dMeasuredMS - estimateMS(pParts);
+    double dNorm = 1000.0*1000.0;
+    QMapIterator<int, double> z(pParts->m_vZ);
+    while(z.hasNext()){z.next(); dNorm += z.value()*z.value();}
+    QMapIterator<int, double> v(pParts->m_vVat);
+    while(v.hasNext()){v.next(); dNorm += v.value()*v.value();}
+    double dStep = CYCLEMODELRATE*dErrorMS/dNorm;
+
+    z.toFront();
+    while(z.hasNext()){
+        z.next();
+        double dFactor = qBound(CYCLEMODELMINFACTOR, zFactor(z.key()) + dStep*z.value(), CYCLEMODELMAXFACTOR);
+        m_vZFactor[z.key()] = dFactor;
+        m_vZCount[z.key()]++;
+    }
+    v.toFront();
+    while(v.hasNext()){
+        v.next();
+        double dFactor = qBound(CYCLEMODELMINFACTOR, vatFactor(v.key()) + dStep*v.value(), CYCLEMODELMAXFACTOR);
+        m_vVatFactor[v.key()] = dFactor;
+        m_vVatCount[v.key()]++;
+    }
+    m_dOverheadMS = qBound(0.0, m_dOverheadMS + dStep*1000.0*1000.0, CYCLEMODELMAXOVERHEADMS);
+    m_iCycles++;
+    return true;
+}
@@ -0,0 +1,100 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9CYCLEMODEL_H
+#define B9CYCLEMODEL_H
+
+#include <QMap>
+#include <QSettings>
+
+#define CYCLEMODELRATE 0.3      // learning rate, how far one measured cycle moves the model
+#define CYCLEMODELMINFACTOR 0.5 // learned factors are kept within this range of the nominal timing
+#define CYCLEMODELMAXFACTOR 3.0
+#define CYCLEMODELMAXOVERHEADMS 5000.0
+
+/******************************************************
+B9CycleParts holds the nominal (data sheet) timing of
+one release cycle, split up by what the model learns:
+Z travel and vat travel per speed setting, and fixed
+delays (breathe, settle) which are known exactly.
+******************************************************/
+class B9CycleParts {
+public:
+    B9CycleParts(){m_dDelayMS = 0.0;}
+    void addZMove(int iSpd, double dNominalMS){if(dNominalMS>0.0) m_vZ[iSpd] += dNominalMS;}
+    void addVatMove(int iSpd, double dNominalMS){if(dNominalMS>0.0) m_vVat[iSpd] += dNominalMS;}
+    void addDelay(double dMS){m_dDelayMS += dMS;}
+    double nominalMS();
+
+    QMap<int, double> m_vZ;   // nominal ms of Z travel, keyed by speed setting
+    QMap<int, double> m_vVat; // nominal ms of vat travel, keyed by speed setting
+    double m_dDelayMS;
+};
+
+/******************************************************
+B9CycleModel learns how this printer's Z and vat travel
+times compare to the nominal ones, per speed setting,
+plus a fixed overhead per cycle.  Every measured cycle
+refines it (normalized least mean squares) and it is
+persisted along with the cycle settings.
+******************************************************/
+class B9CycleModel {
+public:
+    B9CycleModel(){reset();}
+    void reset();
+    void loadSettings(QSettings* pSettings);
+    void saveSettings(QSettings* pSettings);
+
+    double zFactor(int iSpd){return factor(m_vZFactor, m_vZCount, iSpd);}
+    double vatFactor(int iSpd){return factor(m_vVatFactor, m_vVatCount, iSpd);}
+    double overheadMS(){return m_dOverheadMS;}
+    int cyclesLearned(){return m_iCycles;}
+
+    double estimateMS(B9CycleParts* pParts);  // learned duration of the cycle
+    bool learnCycle(B9CycleParts* pParts, double dMeasuredMS);  // false if the measurement looked bogus and was ignored
+
+private:
+    double factor(QMap<int, double> &vFactor, QMap<int, int> &vCount, int iSpd);
+
+    QMap<int, double> m_vZFactor, m_vVatFactor; // measured/nominal, per speed setting
+    QMap<int, int> m_vZCount, m_vVatCount;      // cycles that taught each speed
+    double m_dOverheadMS;
+    int m_iCycles;
+};
+
+#endif // B9CYCLEMODEL_H
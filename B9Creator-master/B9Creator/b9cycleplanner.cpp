@@ -0,0 +1,150 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QStringList>
+#include <qmath.h>
+#include "b9cycleplanner.h"
+
+static bool areaLessThan(const B9CycleParams &a, const B9CycleParams &b)
+{
+    return a.dAreaMM2 < b.dAreaMM2;
+}
+
+void B9CyclePlanner::setFactoryCurve()
+{
+    // Small cross sections release easily, large ones get the standard settings and then gentler ones
+    setCurveText("0, 0, 0, 0, 100, 100, 100, 100\n"
+                 "500, 0, 0.5, 0, 85, 85, 100, 100\n"
+                 "2000, 0.5, 1, 1, 70, 70, 100, 100");
+}
+
+void B9CyclePlanner::loadSettings(QSettings* pSettings)
+{
+    m_bEnabled = pSettings->value("AreaAdaptiveCycle",false).toBool();
+    QString sCurve = pSettings->value("AreaCycleCurve").toString();
+    if(sCurve.isEmpty() || !setCurveText(sCurve)) setFactoryCurve();
+}
+
+void B9CyclePlanner::saveSettings(QSettings* pSettings)
+{
+    pSettings->setValue("AreaAdaptiveCycle",m_bEnabled);
+    pSettings->setValue("AreaCycleCurve",curveText());
+}
+
+QString B9CyclePlanner::curveText()
+{
+    QString sText;
+    for(int i=0; i<m_vCurve.size(); i++){
+        const B9CycleParams &p = m_vCurve[i];
+        sText += QString::number(p.dAreaMM2)+", "+QString::number(p.dBreatheClosed)+", "+QString::number(p.dSettleOpen)+", "+
+                QString::number(p.dOverLift)+", "+QString::number(p.iRSpd)+", "+QString::number(p.iLSpd)+", "+
+                QString::number(p.iOpenSpd)+", "+QString::number(p.iCloseSpd);
+        if(i<m_vCurve.size()-1) sText += "\n";
+    }
+    return sText;
+}
+
+bool B9CyclePlanner::setCurveText(QString sText, QString* pError)
+{
+    QList<B9CycleParams> vCurve;
+    QStringList vLines = sText.split('\n', QString::SkipEmptyParts);
+    for(int i=0; i<vLines.size(); i++){
+        if(vLines[i].trimmed().isEmpty()) continue;
+        QStringList vFields = vLines[i].split(',');
+        bool bOk = vFields.size()==8;
+        double dValues[8];
+        for(int f=0; f<8 && bOk; f++) dValues[f] = vFields[f].trimmed().toDouble(&bOk);
+        if(bOk) bOk = dValues[0]>=0.0 && dValues[1]>=0.0 && dValues[2]>=0.0 && dValues[3]>=0.0;
+        for(int f=4; f<8 && bOk; f++) bOk = dValues[f]>=0.0 && dValues[f]<=100.0;
+        if(!bOk){
+            if(pError) *pError = "Row "+QString::number(i+1)+" needs 8 values: area (mm^2), breathe (s), settle (s), overlift (mm), raise, lower, open and close speeds (0-100%)";
+            return false;
+        }
+        B9CycleParams p;
+        p.dAreaMM2 = dValues[0];
+        p.dBreatheClosed = dValues[1];
+        p.dSettleOpen = dValues[2];
+        p.dOverLift = dValues[3];
+        p.iRSpd = (int)dValues[4];
+        p.iLSpd = (int)dValues[5];
+        p.iOpenSpd = (int)dValues[6];
+        p.iCloseSpd = (int)dValues[7];
+        vCurve.append(p);
+    }
+    if(vCurve.isEmpty()){
+        if(pError) *pError = "The curve needs at least one row";
+        return false;
+    }
+    qSort(vCurve.begin(), vCurve.end(), areaLessThan);
+    m_vCurve = vCurve;
+    return true;
+}
+
+B9CycleParams B9CyclePlanner::planLayer(double dAreaMM2, double dPerimeterMM)
+{
+    B9CycleParams vPlan;
+    if(m_vCurve.isEmpty()) return vPlan;
+
+    // Linear interpolation along the curve, clamped at either end
+    int i = 0;
+    while(i<m_vCurve.size() && m_vCurve[i].dAreaMM2 < dAreaMM2) i++;
+    if(i==0) vPlan = m_vCurve.first();
+    else if(i==m_vCurve.size()) vPlan = m_vCurve.last();
+    else {
+        const B9CycleParams &lo = m_vCurve[i-1];
+        const B9CycleParams &hi = m_vCurve[i];
+        double dT = (dAreaMM2 - lo.dAreaMM2)/(hi.dAreaMM2 - lo.dAreaMM2);
+        vPlan.dBreatheClosed = lo.dBreatheClosed + dT*(hi.dBreatheClosed - lo.dBreatheClosed);
+        vPlan.dSettleOpen = lo.dSettleOpen + dT*(hi.dSettleOpen - lo.dSettleOpen);
+        vPlan.dOverLift = lo.dOverLift + dT*(hi.dOverLift - lo.dOverLift);
+        vPlan.iRSpd = qRound(lo.iRSpd + dT*(hi.iRSpd - lo.iRSpd));
+        vPlan.iLSpd = qRound(lo.iLSpd + dT*(hi.iLSpd - lo.iLSpd));
+        vPlan.iOpenSpd = qRound(lo.iOpenSpd + dT*(hi.iOpenSpd - lo.iOpenSpd));
+        vPlan.iCloseSpd = qRound(lo.iCloseSpd + dT*(hi.iCloseSpd - lo.iCloseSpd));
+    }
+    vPlan.dAreaMM2 = dAreaMM2;
+
+    // Resin refills from the edges, so what matters is area per length of perimeter compared to a square of the same area
+    if(dAreaMM2>0.0 && dPerimeterMM>0.0){
+        double dShape = (dAreaMM2/dPerimeterMM)/(qSqrt(dAreaMM2)/4.0);
+        dShape = qBound(0.25, dShape, 1.0);
+        vPlan.dBreatheClosed *= dShape;
+        vPlan.dSettleOpen *= dShape;
+    }
+    return vPlan;
+}
@@ -0,0 +1,85 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9CYCLEPLANNER_H
+#define B9CYCLEPLANNER_H
+
+#include <QList>
+#include <QString>
+#include <QSettings>
+
+// One set of release cycle parameters, as sent with the D, E, J, K, L, W and X commands
+struct B9CycleParams {
+    B9CycleParams(){dAreaMM2=dBreatheClosed=dSettleOpen=dOverLift=0.0; iRSpd=iLSpd=iOpenSpd=iCloseSpd=100;}
+    double dAreaMM2;        // lit area this row of the curve applies to, unused outside the curve
+    double dBreatheClosed;  // seconds
+    double dSettleOpen;     // seconds
+    double dOverLift;       // mm
+    int iRSpd, iLSpd, iOpenSpd, iCloseSpd;  // percent
+};
+
+/******************************************************
+B9CyclePlanner picks the release cycle parameters for
+each layer from its lit area, interpolating along a
+user edited curve.  Breathe and settle are shortened
+for long, thin cross sections, where resin refills
+from the perimeter much sooner than for a compact
+shape of the same area.
+******************************************************/
+class B9CyclePlanner {
+public:
+    B9CyclePlanner(){setFactoryCurve(); m_bEnabled = false;}
+    void loadSettings(QSettings* pSettings);
+    void saveSettings(QSettings* pSettings);
+    void setFactoryCurve();
+
+    bool isEnabled(){return m_bEnabled;}
+    void setEnabled(bool bEnabled){m_bEnabled = bEnabled;}
+
+    B9CycleParams planLayer(double dAreaMM2, double dPerimeterMM);
+
+    // The curve as text, one row per line: area mm^2, breathe s, settle s, overlift mm, raise %, lower %, open %, close %
+    QString curveText();
+    bool setCurveText(QString sText, QString* pError = NULL); // leaves the curve alone and returns false on a bad row
+
+private:
+    QList<B9CycleParams> m_vCurve;  // sorted by area
+    bool m_bEnabled;
+};
+
+#endif // B9CYCLEPLANNER_H
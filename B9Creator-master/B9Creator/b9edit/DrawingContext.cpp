@@ -86,61 +86,80 @@ void DrawingContext::GenerateLogicImage()
 	if(pActiveImage == NULL || pLowerImage == NULL)
 		return;
 
-	int x;
-	int y;
-    int white = QColor(255,255,255).rgb();
-    int grey = QColor(190,190,190).rgb();
-    int black = QColor(0,0,0).rgb();
-    int red = QColor(255,0,0).rgb();
+    const QRgb white = qRgb(255,255,255);
+    const QRgb grey = qRgb(190,190,190);
+    const QRgb black = qRgb(0,0,0);
+    const QRgb red = qRgb(255,0,0);
+    QImage lower = lowerImage32();
+    toImage32(pActiveImage);
 	int width = pActiveImage->width();
 	int height = pActiveImage->height();
-	
-	
-	
-	for(x=0;x<width;x++)
+	int lowerWidth = qMin(width, lower.width());
+
+	//lit pixels turn red where the layer below is black (unsupported), grey where it is lit.
+	//row by row over the raw scanlines, the inner loop has no branches so the compiler can vectorize it.
+	for(int y=0;y<height;y++)
 	{
-		for(y=0;y<height;y++)
+		QRgb* pUp = (QRgb*)pActiveImage->scanLine(y);
+		int x = 0;
+		if(y < lower.height())
 		{
-			if(pActiveImage->pixel(x,y) == white || pActiveImage->pixel(x,y) == red || pActiveImage->pixel(x,y) == grey)
-			{		
-				if(pLowerImage->pixel(x,y) == black)
-				{
-					pActiveImage->setPixel(x,y,red);	
-				}
-				else
-				{
-					pActiveImage->setPixel(x,y,grey);
-				}
+			const QRgb* pLow = (const QRgb*)lower.constScanLine(y);
+			for(;x<lowerWidth;x++)
+			{
+				QRgb c = pUp[x];
+				bool lit = (c == white) | (c == red) | (c == grey);
+				QRgb logic = (pLow[x] == black) ? red : grey;
+				pUp[x] = lit ? logic : c;
 			}
 		}
+		for(;x<width;x++)
+		{
+			//nothing below us here
+			QRgb c = pUp[x];
+			if((c == white) | (c == red))
+				pUp[x] = grey;
+		}
 	}
 }
 void DrawingContext::GenerateGreenImage()
 {
 	if(pActiveImage == NULL || pLowerImage == NULL)
 		return;
-	int x;
-	int y;
-    int white = QColor(255,255,255).rgb();
-    int black = QColor(0,0,0).rgb();
-    int green = QColor(0,100,0).rgb();
-	int width = pActiveImage->width();
-	int height = pActiveImage->height();
 
-	for(x=0;x<width;x++)
+    const QRgb white = qRgb(255,255,255);
+    const QRgb black = qRgb(0,0,0);
+    const QRgb green = qRgb(0,100,0);
+    QImage lower = lowerImage32();
+    toImage32(pActiveImage);
+	int width = qMin(pActiveImage->width(), lower.width());
+	int height = qMin(pActiveImage->height(), lower.height());
+
+	//dark pixels over a lit pixel below turn green.
+	for(int y=0;y<height;y++)
 	{
-		for(y=0;y<height;y++)
+		QRgb* pUp = (QRgb*)pActiveImage->scanLine(y);
+		const QRgb* pLow = (const QRgb*)lower.constScanLine(y);
+		for(int x=0;x<width;x++)
 		{
-			if(pActiveImage->pixel(x,y) == black)
-			{		
-				if(pLowerImage->pixel(x,y) == white)
-				{
-					pActiveImage->setPixel(x,y,green);	
-				}
-			}
+			QRgb c = pUp[x];
+			pUp[x] = ((c == black) & (pLow[x] == white)) ? green : c;
 		}
 	}
 }
+void DrawingContext::toImage32(QImage* img)
+{
+	//the kernels read and write QRgb words straight from the scanlines
+	if(img->format() != QImage::Format_ARGB32_Premultiplied && img->format() != QImage::Format_ARGB32 && img->format() != QImage::Format_RGB32)
+		*img = img->convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+QImage DrawingContext::lowerImage32()
+{
+	//shallow copy unless it has to be converted, the lower image is only read
+	QImage lower = *pLowerImage;
+	toImage32(&lower);
+	return lower;
+}
 ///////////////////////////////////////
 //Private
 ///////////////////////////////////
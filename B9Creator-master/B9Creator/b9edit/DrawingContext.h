@@ -78,6 +78,8 @@ protected:
 
 private:
 	void drawLineTo(const QPoint &endPoint);
+	void toImage32(QImage* img);//converts img to a 32 bit format if it is not one
+	QImage lowerImage32();//pLowerImage in a 32 bit format
 
 	
 	bool scribbling; //true when the mouse is down and is scribbling
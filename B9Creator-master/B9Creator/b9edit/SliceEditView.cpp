@@ -39,6 +39,7 @@
 #include <QtGui>
 #include "SliceEditView.h"
 #include <QClipboard>
+#include "loadingbar.h"
 
 /////////////////////////////////
 //Public
@@ -50,10 +51,10 @@ SliceEditView::SliceEditView(QWidget *parent, Qt::WFlags flags) : QMainWindow(pa
 	bGrid = false;
 	supportMode = false;
 	pCPJ = NULL;
-	backupIndx = 0;
 	m_xOffset = 0;
 	m_yOffset = 0;
 	currSlice = 0;
+	nextCandidate = 0;
 
     setWindowIcon(QIcon(":/B9JobBuilder/icons/edit.png"));
 	setStatusBar(0);
@@ -70,6 +71,9 @@ SliceEditView::SliceEditView(QWidget *parent, Qt::WFlags flags) : QMainWindow(pa
 	SetDrawTool("penfill");
 	ui.actionPrepare_Base_Gap->setEnabled(false);
 	ui.menuSupports->setEnabled(false);
+	ui.actionNext_Unsupported->setEnabled(false);
+	ui.actionSupport_Unsupported->setEnabled(false);
+	ui.actionRemove_Added_Supports->setEnabled(false);
 	
 
 	ui.scrollArea->setWidget(pDrawingContext);
@@ -147,6 +151,7 @@ void SliceEditView::TogSupportMode()
 		SetDrawTool("currTool");
 		pCPJ->showSupports(false);
 		DeCompressIntoContext();
+		undoBuffer.setBaseline(currSlice, topImg);//we may have moved while supports were shown
 	}
 	UpdateWidgets();
 }
@@ -165,11 +170,6 @@ void SliceEditView::GoToSlice(int slicenumber)
 	{
 		return;
 	}
-	if(slicenumber != currSlice)
-	{
-		ClearUndoBuffer();
-	}	
-	
 	currSlice = slicenumber;
 	setWindowTitle("Slice Manager - " + GetEditMode() + ": " + QString().number(currSlice+1) + " / " + QString().number(pCPJ->getTotalLayers()));
 	DeCompressIntoContext();
@@ -185,7 +185,8 @@ void SliceEditView::GoToSlice(int slicenumber)
 	
 	if(!supportMode)
 	{
-		SaveToUndoBuffer(); //when moving on to a new slice, always save the state it's in to a buffer.
+		//when moving on to a slice, always take the state it's in as the baseline, later edits are diffed against it.
+		undoBuffer.setBaseline(currSlice, topImg);
 	}
 
 	greenTimer.start();
@@ -199,21 +200,51 @@ void SliceEditView::DeCompressIntoContext()
 	{pCPJ->showSupports(0);}
 
 
-	pCPJ->inflateCurrentSlice(&topImg, m_xOffset, m_yOffset, true);
+	sliceCache.setJob(pCPJ, m_xOffset, m_yOffset);
+	sliceCache.show(currSlice); // before we insert, so the pair we are about to draw is pinned
+	InflateSlice(currSlice, &topImg);
 	pDrawingContext->SetUpperImg(&topImg);
 	
 	if(currSlice <= 0)//make "base" image
 	{
-		botImg = QImage(topImg.width(),topImg.height(),QImage::Format_RGB16);
+		botImg = QImage(topImg.width(),topImg.height(),QImage::Format_ARGB32_Premultiplied);
 		botImg.fill(QColor(255,255,255));
 	}
 	else
 	{
 		pCPJ->setCurrentSlice(currSlice - 1);
-		pCPJ->inflateCurrentSlice(&botImg, m_xOffset, m_yOffset, true);
+		InflateSlice(currSlice - 1, &botImg);
 	}
 		
 	pDrawingContext->SetLowerImg(&botImg);
+	sliceCache.prefetchAround(currSlice);
+}
+void SliceEditView::InflateSlice(int slicenumber, QImage* pImg)
+{
+	//same as inflateCurrentSlice, but the bare slice comes from the cache when we have it
+	if(slicenumber < 0 || slicenumber >= pCPJ->getTotalLayers())
+		return;
+	if(!sliceCache.fetch(slicenumber, pImg))
+	{
+		CrushedPrintJob::inflateCopy(pCPJ->copySlice(slicenumber), pImg, m_xOffset, m_yOffset, true);
+		sliceCache.insert(slicenumber, *pImg);
+	}
+	pCPJ->renderSliceExtras(slicenumber, pImg, m_xOffset, m_yOffset);
+}
+void SliceEditView::InvalidateSliceCache(int slicenumber)
+{
+	sliceCache.invalidate(slicenumber);
+}
+void SliceEditView::ClearSliceCache()
+{
+	sliceCache.clear();
+	//what was found unsupported was found on the old job
+	supportCandidates.clear();
+	nextCandidate = 0;
+	addedSupports.clear();
+	ui.actionNext_Unsupported->setEnabled(false);
+	ui.actionSupport_Unsupported->setEnabled(false);
+	ui.actionRemove_Added_Supports->setEnabled(false);
 }
 void SliceEditView::RefreshContext(bool alreadywhite)
 {
@@ -257,6 +288,8 @@ void SliceEditView::PromptBaseOptions()
 void SliceEditView::PrepareBase(int baselayers, int filledlayers)
 {
 	currSlice += baselayers - pCPJ->getBase();
+	ClearUndoBuffer();//slice numbers move with the base, the history no longer lines up.
+	ClearSliceCache();
 	
 	pCPJ->setBase(baselayers);
 	pCPJ->setFilled(filledlayers);
@@ -294,6 +327,128 @@ void SliceEditView::DeleteAllSupports()
 	}
 
 	pCPJ->DeleteAllSupports();
+	addedSupports.clear();
+	ui.actionRemove_Added_Supports->setEnabled(false);
+	DeCompressIntoContext();
+	pDrawingContext->GenerateLogicImage();
+	RefreshWithGreen();
+	pBuilder->SetDirty();
+}
+void SliceEditView::FindUnsupported()
+{
+	QSettings settings;
+	int reach = settings.value("SupportReach",2).toInt();//pixels a layer holds up past the one below by itself
+	int minoverhang = settings.value("SupportMinOverhang",64).toInt();//smaller overhangs are left alone
+
+	//progress bar
+	LoadingBar bar(0,pCPJ->getTotalLayers()-SliceIslandFinder::firstLayer(pCPJ),this);
+	bar.setDescription("Finding Unsupported Areas...");
+
+	SliceIslandFinder finder;
+	QObject::connect(&finder,SIGNAL(progress(int)),&bar,SLOT(setValue(int)));
+	QObject::connect(&bar,SIGNAL(rejected()),&finder,SLOT(cancel()));
+	if(!finder.run(pCPJ, reach, minoverhang))
+		return;
+
+	supportCandidates = finder.candidates();
+	nextCandidate = 0;
+	int islands = 0;
+	while(islands < supportCandidates.count() && supportCandidates[islands].bIsland)
+		islands++;
+	ui.actionNext_Unsupported->setEnabled(!supportCandidates.isEmpty());
+	ui.actionSupport_Unsupported->setEnabled(!supportCandidates.isEmpty());
+
+	QMessageBox::information(this, tr("Slice Manager"),
+				tr("Found %1 islands and %2 overhangs.").arg(islands).arg(supportCandidates.count() - islands));
+	GoToNextUnsupported();
+}
+void SliceEditView::GoToNextUnsupported()
+{
+	if(supportCandidates.isEmpty())
+		return;
+	if(nextCandidate >= supportCandidates.count())
+		nextCandidate = 0;
+	SupportCandidate candidate = supportCandidates[nextCandidate];
+	nextCandidate++;
+
+	GoToSlice(candidate.iLayer);
+	ui.horizontalSlider->setValue(currSlice);
+	ui.scrollArea->ensureVisible(candidate.vPoint.x(), candidate.vPoint.y(), ui.scrollArea->width()/2, ui.scrollArea->height()/2);
+	setWindowTitle(windowTitle() + QString(" - %1 %2 of %3, %4 pixels at %5, %6")
+				.arg(candidate.bIsland ? tr("Island") : tr("Overhang"))
+				.arg(nextCandidate).arg(supportCandidates.count()).arg(candidate.iArea)
+				.arg(candidate.vPoint.x()).arg(candidate.vPoint.y()));
+}
+void SliceEditView::SupportAllUnsupported()
+{
+	if(supportCandidates.isEmpty())
+		return;
+
+	//islands are ranked first
+	int islands = 0;
+	while(islands < supportCandidates.count() && supportCandidates[islands].bIsland)
+		islands++;
+	int overhangs = supportCandidates.count() - islands;
+
+	QMessageBox msgBox(QMessageBox::Question, tr("Slice Manager"),
+				tr("Add a support under each of the %1 islands and %2 overhangs found?\n"
+				   "Tools > Supports > Remove Added Supports takes them away again.").arg(islands).arg(overhangs), QMessageBox::NoButton, this);
+	QPushButton* allButton = msgBox.addButton(tr("Support All (%1)").arg(supportCandidates.count()), QMessageBox::AcceptRole);
+	QPushButton* islandsButton = NULL;
+	if(islands > 0 && overhangs > 0)
+		islandsButton = msgBox.addButton(tr("Islands Only (%1)").arg(islands), QMessageBox::AcceptRole);
+	msgBox.addButton(QMessageBox::Cancel);
+	msgBox.exec();
+	int count;
+	if(msgBox.clickedButton() == allButton)
+		count = supportCandidates.count();
+	else if(islandsButton != NULL && msgBox.clickedButton() == islandsButton)
+		count = islands;
+	else
+		return;
+
+	QCursor prevC = pDrawingContext->cursor();
+	pDrawingContext->setCursor(QCursor(Qt::WaitCursor));
+
+	//each support ends on the layer below the area it holds up, as when placed by hand
+	addedSupports.clear();
+	for(int i = 0; i < count; i++)
+		addedSupports.append(pCPJ->AddSupport(supportCandidates[i].iLayer - 1, supportCandidates[i].vPoint, pDrawingContext->supportSize, st_CIRCLE, pDrawingContext->fastsupportmode));
+	supportCandidates = supportCandidates.mid(count);//what was left out can still be visited
+	nextCandidate = 0;
+	ui.actionNext_Unsupported->setEnabled(!supportCandidates.isEmpty());
+	ui.actionSupport_Unsupported->setEnabled(!supportCandidates.isEmpty());
+	ui.actionRemove_Added_Supports->setEnabled(!addedSupports.isEmpty());
+
+	DeCompressIntoContext();
+	pDrawingContext->GenerateLogicImage();
+	RefreshWithGreen();
+	pDrawingContext->setCursor(prevC);
+
+	pBuilder->SetDirty();
+}
+
+void SliceEditView::RemoveAddedSupports()
+{
+	if(addedSupports.isEmpty())
+		return;
+
+	QMessageBox::StandardButton ret;
+	ret = QMessageBox::warning(this, tr("Slice Manager"),
+				tr("Remove the %1 supports placed by Support All Found Areas?").arg(addedSupports.count()),
+					QMessageBox::Yes | QMessageBox::No);
+	
+	if(ret == QMessageBox::No)
+	{
+		return;
+	}
+
+	//any already deleted by hand are simply not found
+	for(int i = 0; i < addedSupports.count(); i++)
+		pCPJ->RemoveSupport(addedSupports[i]);
+	addedSupports.clear();
+	ui.actionRemove_Added_Supports->setEnabled(false);
+
 	DeCompressIntoContext();
 	pDrawingContext->GenerateLogicImage();
 	RefreshWithGreen();
@@ -303,50 +458,66 @@ void SliceEditView::DeleteAllSupports()
 //undo
 void SliceEditView::ClearUndoBuffer()
 {
-	imgBackup.clear();
-	backupIndx = -1;
+	undoBuffer.clear();
 }
 void SliceEditView::SaveToUndoBuffer()
 {
-	int i;
-	for(i = imgBackup.size() - 1; i > backupIndx; i--)
+	//add to the list of undos, only what changed since the last save of this slice is kept.
+	undoBuffer.save(currSlice, topImg);
+}
+void SliceEditView::DropSliceUndo(int slicenumber)
+{
+	QMessageBox::StandardButton ret;
+	ret = QMessageBox::warning(this, tr("Slice Manager"),
+				tr("Slice %1 was changed outside of its edit history, so its %2 undo step(s) can't be applied.\n"
+				   "Discard them? The other slices keep their history.").arg(slicenumber+1).arg(undoBuffer.sliceEdits(slicenumber)),
+					QMessageBox::Yes | QMessageBox::No);
+
+	if(ret == QMessageBox::No)
 	{
-		imgBackup.removeAt(i);
+		return;
 	}
-	//add to the list of undos.
-	imgBackup.append(topImg);
-	if(imgBackup.size() > 25)
-		{imgBackup.removeFirst();}
-	backupIndx = imgBackup.size() - 1;
+
+	undoBuffer.dropSlice(slicenumber);
+	if(slicenumber == currSlice)
+		undoBuffer.setBaseline(currSlice, topImg);
 }
 void SliceEditView::Undo()
 {
-	if(!supportMode)
+	if(!supportMode && undoBuffer.canUndo())
 	{
-		if(backupIndx >= 1)
-		{	
-			backupIndx--;
-			topImg = imgBackup[backupIndx];
-			pDrawingContext->SetUpperImg(&topImg);
-			RefreshContext(1);
-			modified = true;
-			ReCompress();
-			pDrawingContext->update();
+		//the history covers the whole job, go to the slice the edit was made on first.
+		if(undoBuffer.undoSlice() != currSlice)
+		{
+			GoToSlice(undoBuffer.undoSlice());
+			UpdateWidgets();
+		}
+		if(!undoBuffer.undo(&topImg))
+		{
+			DropSliceUndo(currSlice);//the slice was changed behind our back.
+			return;
 		}
+		pDrawingContext->SetUpperImg(&topImg);
+		RefreshContext(1);
+		modified = true;
+		ReCompress();
+		pDrawingContext->update();
 	}
 }
 void SliceEditView::Redo()
 {
-	if(!supportMode)
+	if(!supportMode && undoBuffer.canRedo())
 	{
-		backupIndx++;
-		if(backupIndx >= imgBackup.size())
+		if(undoBuffer.redoSlice() != currSlice)
 		{
-			backupIndx = imgBackup.size() - 1;
+			GoToSlice(undoBuffer.redoSlice());
+			UpdateWidgets();
+		}
+		if(!undoBuffer.redo(&topImg))
+		{
+			DropSliceUndo(currSlice);
 			return;
 		}
-
-		topImg = imgBackup[backupIndx];
 		pDrawingContext->SetUpperImg(&topImg);
 		RefreshContext(1);
 		modified = true;
@@ -43,6 +43,9 @@
 #include "DrawingContext.h"
 #include "b9edit.h"
 #include "crushbitmap.h"
+#include "sliceundobuffer.h"
+#include "sliceprefetchcache.h"
+#include "sliceislandfinder.h"
 #include <QImage>
 #include <QColor>
 #include <QTimer>
@@ -68,6 +71,8 @@ public slots:
 	void TogSupportMode();
 	void GoToSlice(int slicenumber); //Begins the proccess of displaying the next slice..
 	void DeCompressIntoContext();
+	void InvalidateSliceCache(int slicenumber);//the slice was re-crushed, inflate it again when next shown
+	void ClearSliceCache();//the job was replaced
 	void ReCompress();
 	void RefreshContext(bool alreadywhite);			//Refreshes
 	void UpdateWidgets(); //updates the window title, slider, etc...
@@ -80,10 +85,15 @@ public slots:
 	//supports
 	void AddSupport(QPoint pos, int size, SupportType type, int fastmode); //creates a new support by startin
 	void DeleteAllSupports();
+	void FindUnsupported();//looks over the whole job for islands and overhangs
+	void GoToNextUnsupported();//shows the next one found, best candidates first
+	void SupportAllUnsupported();//asks, then places a support under every one found, or under the islands only
+	void RemoveAddedSupports();//takes away what the last SupportAllUnsupported placed
 
 	//undo
 	void ClearUndoBuffer();
 	void SaveToUndoBuffer();
+	void DropSliceUndo(int slicenumber);//the slice no longer matches its history, asks before forgetting that slice's edits
 	void Undo();
 	void Redo();
 
@@ -151,8 +161,14 @@ private:
 
 	QTimer greenTimer;
 
-	QList<QImage> imgBackup;//list of images for undo, redo
-	int backupIndx;
+	void InflateSlice(int slicenumber, QImage* pImg);//from the prefetch cache if it's there
+	SlicePrefetchCache sliceCache;//inflated slices around the current one
+
+	SliceUndoBuffer undoBuffer;//edits of every slice for undo, redo
+
+	QList<SupportCandidate> supportCandidates;//from the last FindUnsupported, ranked
+	int nextCandidate;
+	QList<SimpleSupport> addedSupports;//placed by the last SupportAllUnsupported
 };
 
 #endif // SliceEditView_H
@@ -40,7 +40,13 @@
 #include "loadingbar.h"
 #include <QFileInfo>
 #include <QFile>
-#include <QSvgRenderer> // see copyright distribution notice on qt's website!
+#include <QDir>
+#include <QSet>
+#include "sliceimporter.h"
+#include "sliceexporter.h"
+#include "svgsliceimporter.h"
+#include "slcsliceimporter.h"
+#include "slicemorphology.h"
 
 //Public
 B9Edit::B9Edit(QWidget *parent, Qt::WFlags flags, QString infile)
@@ -138,6 +144,7 @@ void B9Edit::newJob()
 	dirtied = false;
 	cPJ.clearAll();
     cPJ.DeleteAllSupports();
+	pEditView->ClearSliceCache();
 	updateSliceIndicator();
 	updateWindowTitle();
 	pEditView->UpdateWidgets();
@@ -193,6 +200,7 @@ void B9Edit::openJob(QString infile)
 	updateSliceIndicator();
 	updateWindowTitle();
 	pEditView->ClearUndoBuffer();
+	pEditView->ClearSliceCache();
 	pEditView->GoToSlice(0);
     pEditView->UpdateWidgets();
 
@@ -256,7 +264,6 @@ void B9Edit::importSlices()//button access , branches to firstfile() or loadsvg(
 void B9Edit::importSlicesFromFirstFile(QString firstfile)
 {
 	int i;
-	int n;
 	bool hasExt = false;
 	QString extension; //include the '.'
 	QString shortenedStr;
@@ -294,140 +301,58 @@ void B9Edit::importSlicesFromFirstFile(QString firstfile)
 	startingnumber = number.toInt();
 	qDebug() << "Starting Number: " << startingnumber;
 	
-	//Probe to see how many files there are.
+	//Probe to see how many files there are, from one listing of the folder rather than a lookup per file.
+	QFileInfo prefix(shortenedStr);
+	QSet<QString> present = QSet<QString>::fromList(prefix.dir().entryList(QDir::Files));
+	QStringList files;
 	endingnumber = startingnumber;
-	while(QFileInfo(shortenedStr + QString::number(endingnumber) + extension).isFile())
+	while(present.contains(prefix.fileName() + QString::number(endingnumber) + extension))
 	{
+		files.append(shortenedStr + QString::number(endingnumber) + extension);
 		endingnumber++;
 	}
 
 	//make a new instance of the loadingbar.
-	LoadingBar load(0,endingnumber,this);
+	LoadingBar load(0,files.count(),this);
 	load.setDescription("Importing Images...");
-	QObject::connect(&load,SIGNAL(rejected()),this,SLOT(CancelLoading()));
-	
-	QImage img;
-	cPJ.clearAll();
-	n = startingnumber;
-	while(img.load(shortenedStr + QString::number(n) + extension))
-	{
-		cPJ.addImage(&img);
-		n++;
-		load.setValue(n - startingnumber);
 
-		if(!continueLoading)//break out of the loading loop
-		{
-			continueLoading = true;
-			cPJ.clearAll();
-			break;
-		}
-		//give the app the ability to procces events
-		QApplication::processEvents();
-	}
+	//load and crush on all cores, the job is only replaced once every slice is in.
+	SliceImporter importer;
+	QObject::connect(&importer,SIGNAL(progress(int)),&load,SLOT(setValue(int)));
+	QObject::connect(&load,SIGNAL(rejected()),&importer,SLOT(cancel()));
+	if(!importer.run(files))
+		return;//cancelled, the job we had is untouched
+
+	cPJ.clearAll();
+	importer.addTo(&cPJ);
 
 	updateSliceIndicator();
 	pEditView->ClearUndoBuffer();
+	pEditView->ClearSliceCache();
 	pEditView->GoToSlice(0);
 	pEditView->UpdateWidgets();
 	dirtied = true;
 }
 void B9Edit::importSlicesFromSvg(QString file, double pixelsizemicrons)
 {
-	int layers = 0;
-	double xsizemm = 0.0;
-	double ysizemm = 0.0;
-	double x = 0;
-	double y = 0;
-    bool inverted = false;
-
-	QSvgRenderer SvgRender;
-	
-	
-	if(!SvgRender.load(file))
+	//read the layer polygons in one pass over the file.
+	SvgSliceImporter importer;
+	if(!importer.parse(file))
 	{
 		QMessageBox msgBox;
-		msgBox.setText("Unable to import SVG file.");
+		msgBox.setText(importer.errorString());
 		msgBox.exec();
 		return;
 	}
-	if(!SvgRender.elementExists("layer0"))
+	if(!importer.hasFillColors())
 	{
 		QMessageBox msgBox;
-		msgBox.setText("SVG file does not contain compatible layer information\nUnable to import.");
+		msgBox.setText("Could not determine color scheme\nImage may be inverted.");
 		msgBox.exec();
+		qDebug() << "Can't find the fill of a slic3r:type=\"contour\"";
 		return;
 	}
-
-    //do a quick search for the word "slic3r:type="contour"" and then the following "style="fill:"
-    //to figure out whether the image is inverted or not.
-    QString buff = "";
-    QFile searchfile(file);
-    searchfile.open(QIODevice::ReadOnly);
-    QTextStream searchstream(&searchfile);
-
-
-    while(buff != "slic3r:type=\"contour\"" && !searchstream.atEnd())
-    {
-        searchstream >> buff;
-    }
-    if(!searchstream.atEnd())//we must have found it.
-    {
-        while(buff != "style=\"fill:" && !searchstream.atEnd())
-        {
-            searchstream >> buff;
-        }
-        if(!searchstream.atEnd())
-        {
-            searchstream >> buff;
-            if(buff == "white\"")
-            {
-                inverted = false;
-            }
-            else
-            {
-                inverted = true;
-            }
-        }
-        else
-        {
-            QMessageBox msgBox;
-            msgBox.setText("Could not determine color scheme\nImage may be inverted.");
-            msgBox.exec();
-            qDebug() << "Can't find style=\"fill";
-            return;
-        }
-    }
-    else
-    {
-        QMessageBox msgBox;
-        msgBox.setText("Could not determine color scheme\nImage may be inverted.");
-        msgBox.exec();
-        qDebug() << "Can't find slic3r:type";
-        return;
-    }
-    searchfile.close();
-    //END SEARCH SECTION
-	
-	
-	//begin looping to figure out how many layers there are in the svg file.
-	while(SvgRender.elementExists("layer" + QString().number(layers)))
-	{
-		x = SvgRender.boundsOnElement("layer" + QString().number(layers)).right();
-		y = SvgRender.boundsOnElement("layer" + QString().number(layers)).bottom();
-
-		if(x > xsizemm)
-			xsizemm = x;
-
-		if(y > ysizemm)
-			ysizemm = y;
-
-		layers++;
-		QApplication::processEvents();
-	}
-
-
-
-	if(xsizemm <= 0 || ysizemm <= 0)
+	if(importer.bounds().right() <= 0 || importer.bounds().bottom() <= 0)
 	{
 		QMessageBox msgBox;
 		msgBox.setText("Bad bounds in SVG file.");
@@ -469,66 +394,33 @@ void B9Edit::importSlicesFromSvg(QString file, double pixelsizemicrons)
     emit setName(cPJ.getName());
 
 	//make a new instance of the loadingbar.
-	LoadingBar load(0,layers,this);
+	LoadingBar load(0,importer.layerCount(),this);
 	load.setDescription("Importing SVG...");
-	QObject::connect(&load,SIGNAL(rejected()),this,SLOT(CancelLoading()));
-
-	
-    QImage img(double(xsizemm)/pixelsizemm,double(ysizemm)/pixelsizemm,QImage::Format_ARGB32);
-
-	QPainter painter(&img);
-
-	cPJ.clearAll();
-
-    for( int i = 0; i <= layers; i++)
-	{
-        if(!inverted) img.fill(Qt::black); else img.fill(Qt::white);
-		QRectF realelementbounds = SvgRender.boundsOnElement("layer" + QString().number(i));
-
-        QRectF pixelbounds(realelementbounds.left()/pixelsizemm, realelementbounds.top()/pixelsizemm, realelementbounds.width()/pixelsizemm, realelementbounds.height()/pixelsizemm);
-
-        painter.begin(&img);
 
-        SvgRender.render(&painter, "layer" + QString().number(i),pixelbounds);
-
-        painter.end();
-
-        if(inverted) img.invertPixels();
-
-        img = img.mirrored (false, true);
-        cPJ.addImage(&img);
-		load.setValue(load.GetValue()+1);
-		QApplication::processEvents();
-        if(!continueLoading)
-		{
-			continueLoading = true;
-			cPJ.clearAll();
-			break;
-		}
-	}
+	//rasterize and crush the layers on all cores, the job is only replaced once every layer is in.
+	importer.setPixelSize(pixelsizemm);
+	QObject::connect(&importer,SIGNAL(progress(int)),&load,SLOT(setValue(int)));
+	QObject::connect(&load,SIGNAL(rejected()),&importer,SLOT(cancel()));
+	bool finished = importer.run(importer.layerCount());
+	cPJ.clearAll();//a cancelled import leaves an empty job, as it always has
+	if(finished)
+		importer.addTo(&cPJ);
 
 	updateSliceIndicator();
 	pEditView->ClearUndoBuffer();
+	pEditView->ClearSliceCache();
 	pEditView->GoToSlice(0);
 	pEditView->UpdateWidgets();
 	dirtied = true;
 }
 void B9Edit::importSlicesFromSlc(QString file, double pixelsizemicrons)
 {
-    quint8 readbyte;
-    quint32 readfloat;
-    float x;
-    float y;
-    float* pfloat;
-
-    const int maxheadersize = 2048;
-    int headersize = 0;
-
-    QFile slcfile(file);
-    if(!slcfile.open(QIODevice::ReadOnly))
+    //map the file and index its layers and bounds in one pass.
+    SlcSliceImporter importer;
+    if(!importer.open(file))
     {
         QMessageBox msgBox;
-        msgBox.setText("Unable to open SLC file..");
+        msgBox.setText(importer.errorString());
         msgBox.exec();
         return;
     }
@@ -564,327 +456,22 @@ void B9Edit::importSlicesFromSlc(QString file, double pixelsizemicrons)
         emit setName(cPJ.getName());
     //////////
 
-    QDataStream slcstream(&slcfile);
-    QTextStream slctextstream(&slcfile);
-    slcstream.setByteOrder(QDataStream::LittleEndian);
-    QString headertext;
-    QString fileunits;
-    cPJ.clearAll();
-
-
-
-    //Header Section:
-    int unitit = 0;
-    while(headersize <= maxheadersize)//readbyte != 0x1a && readbyte != 0x0d && readbyte != 0x0a)
-    {
-       slctextstream >> headertext;
-       unitit++;
-       if(headertext == "-UNIT")
-       {
-           slctextstream >> fileunits;
-           qDebug() << fileunits;
-           break;
-       }
-       if(unitit >= 10)
-       {
-           break;
-       }
-    }
-
-    slctextstream.device()->reset();
-
-    while(headersize <= maxheadersize)//readbyte != 0x1a && readbyte != 0x0d && readbyte != 0x0a)
-    {
-       slcstream >> readbyte;
-       headersize++;
-       if(readbyte == 0x0d)
-       {
-           slcstream >> readbyte;
-           headersize++;
-           if(readbyte == 0x0a)
-           {
-               slcstream >>readbyte;
-               headersize++;
-               if(readbyte == 0x1a)
-               {
-                   break;
-               }
-           }
-       }
-    }
-
-    //3D reserved section:
-    qDebug() << "Skipping " << slcstream.skipRawData(256) << " bytes";
-
-
-    //Sample table section:
-    slcstream >> readbyte;
-    int tableentries = (int)readbyte;
-    qDebug() << "Table Entries: " << tableentries;
-
-    for(int t = 0; t < tableentries; t++)
-    {
-        slcstream >> readfloat;
-        slcstream >> readfloat;
-        slcstream >> readfloat;
-        slcstream >> readfloat;
-
-    }
-
-    //Contuour section:
-    quint32 numslices = 0;
-    quint32 numboundries = 0;
-    quint32 numvertices = 0;
-    quint32 numgaps = 0;
-    quint32 minzlevel = 0;
-
-    QVector2D maxb(-99999,-99999);
-    QVector2D minb(99999,99999);
-
-    double scalefactor = 1.0;
-
-    if(fileunits == "INCH")
-        scalefactor = 25.4;
-
-    qint64 returnpos = slcstream.device()->pos();
-    //FIRST PASS
-    //the first pass we need to compute the bounds
-    bool boundsdetermined = false;
-    while(numboundries != 0xffffffff)
-    {
-
-        slcstream >> minzlevel;
-        slcstream >> numboundries;
-        if(numboundries == 0xffffffff)
-        {
-            break;
-        }
-        numslices++;
-        //fill the new loops with vertices!
-        for(unsigned b = 0; b < numboundries; b++)
-        {
-            slcstream >> numvertices;
-            slcstream >> numgaps;
-            for(uint v = 0; v < numvertices; v++)
-            {
-                slcstream >> readfloat;//x cord
-                pfloat = (float*)&readfloat;
-                x = *pfloat;
-
-                slcstream >> readfloat;//y cord
-                pfloat = (float*)&readfloat;
-                y = *pfloat;
-
-                if(x > maxb.x())
-                    maxb.setX(x);
-                if(y > maxb.y())
-                    maxb.setY(y);
-                if(x < minb.x())
-                    minb.setX(x);
-                if(y < minb.y())
-                    minb.setY(y);
-
-                boundsdetermined = true;
-            }
-        }
-    }
-
-
-    if(!boundsdetermined)
-    {
-        QMessageBox msgBox;
-        msgBox.setText("Invalid File");
-        msgBox.exec();
-        return;
-    }
-
-
-
-
-
-
-    maxb*=scalefactor;
-    minb*=scalefactor;
-
-    slcstream.device()->seek(returnpos);
-    numboundries = 0;
-
     //make a new instance of the loadingbar.
-    LoadingBar load(0,numslices,this);
+    LoadingBar load(0,importer.layerCount(),this);
     load.setDescription("Importing SLC..");
-    QObject::connect(&load,SIGNAL(rejected()),this,SLOT(CancelLoading()));
-
-
-    QImage img((maxb - minb).x()/pixelsizemm,(maxb - minb).y()/pixelsizemm,QImage::Format_ARGB32);
-
-    qDebug() << maxb << " " << minb;
-
-    double x1;
-    double y1;
-    double x2;
-    double y2;
-    double Dot;
-    double Cross;
-    double diff;
-    double totalAngle;
-    //SECOND PASS, actual formation.
-    while(numboundries != 0xffffffff)
-    {
-        slcstream >> minzlevel;
-        slcstream >> numboundries;
-        if(numboundries == 0xffffffff)
-        {
-            break;
-        }
-        QPainter painter(&img);
-        painter.setCompositionMode(QPainter::CompositionMode_Plus);
-        painter.setRenderHint(QPainter::Antialiasing,false);
-
-        QBrush fillbrush(QColor(1,0,0));
-        QBrush voidbrush(QColor(0,1,0));
-        //fill the new loops with vertices!
-        img.fill(Qt::black);
-
-
-        for(unsigned b = 0; b < numboundries; b++)
-        {
-            slcstream >> numvertices;
-            slcstream >> numgaps;
-            QPointF* points = new QPointF[numvertices+1];
-
-            totalAngle = 0;
-            QPointF firstpoint;
-            for(uint v = 0; v <= numvertices; v++)
-            {
-
-                if(v == numvertices)
-                {
-                   x = firstpoint.x();
-                   y = firstpoint.y();
-
-                }
-                else
-                {
-
-                    slcstream >> readfloat;//x cord
-                    pfloat = (float*)&readfloat;
-                    x = *pfloat*scalefactor;
-
-                    slcstream >> readfloat;//y cord
-                    pfloat = (float*)&readfloat;
-                    y = *pfloat*scalefactor;
-
-
-                 }
-
-                if(v == 1)
-                {
-                    firstpoint = QPointF(x,y);
-                }
-                QVector2D cord(x,y);
-                cord -= minb;
-                cord *= (1/pixelsizemm);
-
-
-                if(v >= 2)//we can use the point behind for angle counting
-                {
-                    x1 = points[v-1].x() - points[v-2].x();
-                    y1 = points[v-1].y() - points[v-2].y();
-                    x2 = cord.x() - points[v-1].x();
-                    y2 = cord.y() - points[v-1].y();
-                    QVector2D vec1(x1,y1); vec1.normalize();
-                    QVector2D vec2(x2,y2); vec2.normalize();
-                    x1 = vec1.x();
-                    y1 = vec1.y();
-                    x2 = vec2.x();
-                    y2 = vec2.y();
-
-                    Dot = (x1 * x2) + (y1 * y2);
-                    Cross = (x1 * y2) - (y1 * x2);
-
-                    //filter dot and cross
-                    if(Dot > 1)
-                        Dot = 1;
-                    else if(Dot < -1)
-                        Dot = -1;
-                    if(Cross > 1)
-                        Cross = 1;
-                    else if(Cross < -1)
-                        Cross = -1;
-
-                    if(Cross >= 0)
-                        diff = -acos(Dot);
-                    else
-                        diff = acos(Dot);
-
-                    totalAngle = totalAngle + diff;
-                }
-
-                points[v] = QPointF(cord.x(),cord.y());
-            }
-
-
-            if(totalAngle > 0)
-            {
-                painter.setBrush(voidbrush);
-
-            }
-            else
-            {
-                painter.setBrush(fillbrush);
-
-            }
-
-            //Draw code here
-            painter.drawPolygon(points,numvertices,Qt::WindingFill);
-
-            delete[] points;
-        }
-
-
-        for(int imgx = 0; imgx < img.size().width(); imgx++)
-        {
-            for(int imgy = 0; imgy < img.size().height(); imgy++)
-            {
-                QRgb pickedcolor = img.pixel(imgx,imgy);
-                if(qRed(pickedcolor) || qGreen(pickedcolor))
-                {
-                    int result = qRed(pickedcolor) - qGreen(pickedcolor);
-
-                    if(result > 0)
-                    {
-                        result = 255;
-                    }
-                    else if(result <= 0)
-                    {
-                        result = 1;
-                    }
-                    img.setPixel(imgx,imgy,QColor(result,0,0).rgb());
-                }
-
-
-
-            }
-        }
 
-        painter.end();
-        img = img.mirrored(false,true);
-        cPJ.addImage(&img);
-
-        load.setValue(load.GetValue()+1);
-        QApplication::processEvents();
-        if(!continueLoading)
-        {
-            continueLoading = true;
-            cPJ.clearAll();
-            break;
-        }
-    }
-
-    slcfile.close();
+    //fill and crush the layers on all cores, the job is only replaced once every layer is in.
+    importer.setPixelSize(pixelsizemm);
+    QObject::connect(&importer,SIGNAL(progress(int)),&load,SLOT(setValue(int)));
+    QObject::connect(&load,SIGNAL(rejected()),&importer,SLOT(cancel()));
+    bool finished = importer.run(importer.layerCount());
+    cPJ.clearAll();//a cancelled import leaves an empty job, as it always has
+    if(finished)
+        importer.addTo(&cPJ);
 
     updateSliceIndicator();
     pEditView->ClearUndoBuffer();
+    pEditView->ClearSliceCache();
     pEditView->GoToSlice(0);
     pEditView->UpdateWidgets();
     dirtied = true;
@@ -902,11 +489,8 @@ void B9Edit::CancelLoading()
 //export
 void B9Edit::ExportToFolder()
 {
-	int s = 0;
 	bool cont;
-	int quality;
-	bool previousStatus;
-	QImage buff;
+	int quality = 100;
 
 	//folder dialog
     QSettings settings;
@@ -917,14 +501,14 @@ void B9Edit::ExportToFolder()
 		return;
 	SetDir(folder);
 	//get the user's file format choice:
-	QStringList choices;
-    choices << tr("BMP") << tr("TIFF") << tr("JPEG");
+	QStringList choices = SliceExporter::formatNames();
 	QString format = QInputDialog::getItem(this, tr("Image Export"),
                                           tr("Format:"), choices , 0, false, &cont);
 	if(!cont)
 		return;
+	SliceExporter::Format exportformat = (SliceExporter::Format)choices.indexOf(format);
 
-	if(format == "JPEG")
+	if(exportformat == SliceExporter::EXPORT_JPEG)
 	{
         quality = QInputDialog::getInt(this, tr("QInputDialog::getInteger()"),
                                   tr("Quality:"), 100, 0, 100, 1, &cont);
@@ -936,28 +520,81 @@ void B9Edit::ExportToFolder()
 
 
 	//progress bar
-	LoadingBar bar(0,cPJ.getTotalLayers() - 1,NULL);
-	QObject::connect(&bar,SIGNAL(rejected()),this,SLOT(CancelLoading()));
+	LoadingBar bar(0,cPJ.getTotalLayers(),NULL);
 
-
-	previousStatus = cPJ.renderingSupports();
-	cPJ.showSupports(true);
-	for(s=0;s<cPJ.getTotalLayers();s++)
+	//layers are encoded on all cores and written in order.
+	SliceExporter exporter;
+	QObject::connect(&exporter,SIGNAL(progress(int)),&bar,SLOT(setValue(int)));
+	QObject::connect(&bar,SIGNAL(rejected()),&exporter,SLOT(cancel()));
+	if(!exporter.run(&cPJ, folder, exportformat, quality) && !exporter.errorString().isEmpty())
 	{
-		if(!continueLoading)
-		{
-			continueLoading = true;
-			break;
-		}
+		QMessageBox::warning(this, tr("Image Export"), exporter.errorString(), QMessageBox::Ok);
+	}
+}
+
+void B9Edit::AdjustLayers()
+{
+	bool cont;
+	int radius = 0;
+	QPoint shift;
+
+	if(cPJ.getTotalLayers() <= cPJ.getBase())
+		return;
 
-		cPJ.setCurrentSlice(s);
-		cPJ.inflateCurrentSlice(&buff,0,0,true);
-		buff.save(folder + "\\" + cPJ.getName() + "_" + QString().number(s+1) + "." + format.toLower(),format.toAscii(),100);
-		bar.setValue(s);
-		//give the app the ability to proccess events
-		QApplication::processEvents();
+	//get the user's choice of operation:
+	QStringList choices = SliceMorphology::operationNames();
+	QString operation = QInputDialog::getItem(this, tr("Adjust Layers"),
+                                          tr("Operation:"), choices , 0, false, &cont);
+	if(!cont)
+		return;
+	SliceMorphology::Operation morphop = (SliceMorphology::Operation)choices.indexOf(operation);
+
+	if(morphop == SliceMorphology::MORPH_SHIFT)
+	{
+		shift.setX(QInputDialog::getInt(this, tr("Adjust Layers"),
+                                  tr("Shift right in pixels:"), 0, -10000, 10000, 1, &cont));
+		if(!cont)
+			return;
+		shift.setY(QInputDialog::getInt(this, tr("Adjust Layers"),
+                                  tr("Shift down in pixels:"), 0, -10000, 10000, 1, &cont));
+		if(!cont)
+			return;
+	}
+	else
+	{
+		radius = QInputDialog::getInt(this, tr("Adjust Layers"),
+                                  tr("Radius in pixels:"), 1, 1, 100, 1, &cont);
+		if(!cont)
+			return;
 	}
-	cPJ.showSupports(previousStatus);
+
+	//layer range, numbered from 1 as the slice indicator shows them
+	int first = QInputDialog::getInt(this, tr("Adjust Layers"),
+                                  tr("First layer:"), cPJ.getBase()+1, cPJ.getBase()+1, cPJ.getTotalLayers(), 1, &cont);
+	if(!cont)
+		return;
+	int last = QInputDialog::getInt(this, tr("Adjust Layers"),
+                                  tr("Last layer:"), cPJ.getTotalLayers(), first, cPJ.getTotalLayers(), 1, &cont);
+	if(!cont)
+		return;
+
+	//progress bar
+	LoadingBar bar(0,last-first+1,this);
+	bar.setDescription("Adjusting Layers...");
+
+	//layers are done on all cores straight from their runs, the job only changes if all of them are done.
+	SliceMorphology morph;
+	QObject::connect(&morph,SIGNAL(progress(int)),&bar,SLOT(setValue(int)));
+	QObject::connect(&bar,SIGNAL(rejected()),&morph,SLOT(cancel()));
+	if(!morph.run(&cPJ, first-1, last-1, morphop, radius, shift))
+		return;
+
+	dirtied = true;
+	updateWindowTitle();
+	pEditView->ClearUndoBuffer();
+	pEditView->ClearSliceCache();
+	pEditView->GoToSlice(pEditView->currSlice);
+	pEditView->UpdateWidgets();
 }
 
 
@@ -1062,6 +699,7 @@ void B9Edit::PatchJobData(QImage* pNewImg, int slicenumber)
 	 {
 		cPJ.setCurrentSlice(slicenumber);
 		cPJ.crushCurrentSlice(pNewImg);
+		pEditView->InvalidateSliceCache(slicenumber);
 	 }
  }
 void B9Edit::SetDirty()
@@ -74,6 +74,9 @@ public slots:
 	//export
 	void ExportToFolder();
 
+	//grow, shrink or shift a range of layers
+	void AdjustLayers();
+
 	//persistent directory
 	void SetDir(QString dir);
 	QString GetDir();
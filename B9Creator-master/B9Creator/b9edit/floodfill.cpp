@@ -37,86 +37,63 @@
 *************************************************************************************/
 
 #include "floodfill.h"
+#include <QVector>
+#include <QPoint>
 
 
+static void pushRunSeeds(QVector<QPoint> &seeds, const QRgb* pLine, int xLeft, int xRight, int y, QRgb startcolor)
+{
+	// One seed for each run of start colored pixels in [xLeft, xRight] of this line,
+	// the run is grown to its full width when the seed is popped.
+	bool inRun = false;
+	for(int x = xLeft; x <= xRight; x++)
+	{
+		if(pLine[x] == startcolor)
+		{
+			if(!inRun) seeds.append(QPoint(x, y));
+			inRun = true;
+		}
+		else inRun = false;
+	}
+}
+
 void floodFill(QImage* pImage, int x, int y, QColor fillColor)
 {
+	if(x < 0 || y < 0 || x >= pImage->width() || y >= pImage->height()) return;
+
+	// We read and write QRgb words straight from the scanlines
+	if(pImage->format() != QImage::Format_ARGB32_Premultiplied && pImage->format() != QImage::Format_ARGB32 && pImage->format() != QImage::Format_RGB32)
+		*pImage = pImage->convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+	QRgb fillcolor = fillColor.rgb();
+	QRgb startcolor = ((QRgb*)pImage->scanLine(y))[x];
 	// If the pixel we are starting with is already the fill color, we're done
-    if (pImage->pixel(x,y) == fillColor.rgb()) return;
+	if (startcolor == fillcolor) return;
 
-	int startcolor = pImage->pixel(x,y);
+	int width = pImage->width();
+	int height = pImage->height();
 
-    // Create the pixel queue.  Assume the worst case where every pixel in the
-    // image may be in the queue.
-	int pixelQueueSize = 0;
-	int *pixelQueue= new int[pImage->width() * pImage->height()];
-	
-    // Add the start pixel to the queue (we created a single array of ints,
-    // even though we are enqueuing two numbers.  We put the y value in the
-    // upper 16 bits of the integer, and the x in the lower 16.  This gives
-    // a limit of 65536x65536 pixels, that should be enough.)  
-    pixelQueue[0] = (y << 16) + x;
-    pixelQueueSize = 1;
-  
-    // Color the start pixel.
-	pImage->setPixel(x,y,fillColor.rgb());
+	// Fill by horizontal runs.  The stack only ever holds one seed per run bordering
+	// the filled area, so it stays about the size of the boundary, not of the image.
+	QVector<QPoint> seeds;
+	seeds.reserve(256);
+	seeds.append(QPoint(x, y));
+	while (!seeds.isEmpty()){
+		QPoint seed = seeds.last();
+		seeds.remove(seeds.size() - 1);
+		y = seed.y();
+		QRgb* pLine = (QRgb*)pImage->scanLine(y);
+		if (pLine[seed.x()] != startcolor) continue; // filled through another seed
 
-    // Keep going while there are pixels in the queue.
-    while (pixelQueueSize > 0){
-  
-		// Get the x and y values of the next pixel in the queue
-		x = pixelQueue[0] & 0xffff;
-		y = (pixelQueue[0] >> 16) & 0xffff;
-      
-		// Remove the first pixel from the queue.  Rather than move all the
-		// pixels in the queue, which would take forever, just take the one
-		// off the end and move it to the beginning (order doesn't matter here).
-		pixelQueueSize--;
-		pixelQueue[0] = pixelQueue[pixelQueueSize];
-    
-		// If we aren't on the left side of the image, see if the pixel to the
-		// left has been painted.  If not, paint it and add it to the queue.
-		if (x > 0) {
-		if ( pImage->pixel(x-1, y) == startcolor )
-		{
-			pImage->setPixel(x-1, y, fillColor.rgb());
-			pixelQueue[pixelQueueSize] = (y << 16) + x-1;
-			pixelQueueSize++;
-		}
-		}
+		// Grow the run both ways and fill it
+		int xLeft = seed.x();
+		while (xLeft > 0 && pLine[xLeft-1] == startcolor) xLeft--;
+		int xRight = seed.x();
+		while (xRight < width-1 && pLine[xRight+1] == startcolor) xRight++;
+		for (int i = xLeft; i <= xRight; i++) pLine[i] = fillcolor;
 
-		// If we aren't on the bottom of the image, see if the pixel below
-		// this one has been painted.  If not, paint it and add it to the queue.
-		if (y > 0) {
-			if ( pImage->pixel(x, y-1) == startcolor )
-			{
-				pImage->setPixel(x, y-1, fillColor.rgb());
-				pixelQueue[pixelQueueSize] = ((y-1) << 16) + x;
-				pixelQueueSize++;
-			}
-		}
-   
-		// If we aren't on the right side of the image, see if the pixel to the
-		// right has been painted.  If not, paint it and add it to the queue.
-		if (x < pImage->width()-1) {
-			if ( pImage->pixel(x+1, y) == startcolor )
-			{
-				pImage->setPixel(x+1, y, fillColor.rgb());
-				pixelQueue[pixelQueueSize] = (y << 16) + x+1;
-				pixelQueueSize++;
-			}
-		}
-    
-		// If we aren't on the top of the image, see if the pixel above
-		// this one has been painted.  If not, paint it and add it to the queue.
-		if (y < pImage->height()-1) {
-			if ( pImage->pixel(x, y+1) == startcolor )
-			{
-				pImage->setPixel(x, y+1, fillColor.rgb());
-				pixelQueue[pixelQueueSize] = ((y+1) << 16) + x;
-				pixelQueueSize++;
-			}
-		}
+		// Runs touching it on the lines above and below are next
+		if (y > 0) pushRunSeeds(seeds, (const QRgb*)pImage->constScanLine(y-1), xLeft, xRight, y-1, startcolor);
+		if (y < height-1) pushRunSeeds(seeds, (const QRgb*)pImage->constScanLine(y+1), xLeft, xRight, y+1, startcolor);
 	}
-	delete [] pixelQueue;
 }
@@ -0,0 +1,154 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include "polygonfill.h"
+#include <qmath.h>
+#include <QtAlgorithms>
+
+struct FillEdge {
+    int yEnd;       // first row past the edge
+    double x;       // where the edge crosses the center of the current row
+    double dxdy;
+    int iPolygon;
+};
+
+struct FillCrossing {
+    double x;
+    int iPolygon;
+    bool operator<(const FillCrossing &other) const {return x < other.x;}
+};
+
+void fillPolygonRuns(int width, int height, const QVector<QPolygonF> &vPolygons, const QVector<int> &vWeights, SliceRuns* pRows)
+{
+	pRows->clear();
+	if(width < 1 || height < 1) return;
+	pRows->resize(height);
+	if(vPolygons.isEmpty()) return;
+
+	// Edge table: every non horizontal edge, bucketed by the first row center it crosses.
+	// Row y is crossed when the edge spans y+0.5, top inclusive, bottom exclusive.
+	QVector< QVector<FillEdge> > vStarts(height);
+	for(int p = 0; p < vPolygons.count(); p++)
+	{
+		const QPolygonF &vPolygon = vPolygons[p];
+		int iPoints = vPolygon.count();
+		for(int i = 0; i < iPoints; i++)
+		{
+			QPointF a = vPolygon[i];
+			QPointF b = vPolygon[(i+1)%iPoints];
+			if(a.y() == b.y()) continue;
+			if(a.y() > b.y()) qSwap(a, b);
+			int yFirst = qMax(0, (int)qCeil(a.y() - 0.5));
+			int yEnd = qMin(height, (int)qCeil(b.y() - 0.5));
+			if(yFirst >= yEnd) continue;
+			FillEdge edge;
+			edge.yEnd = yEnd;
+			edge.dxdy = (b.x() - a.x())/(b.y() - a.y());
+			edge.x = a.x() + (yFirst + 0.5 - a.y())*edge.dxdy;
+			edge.iPolygon = p;
+			vStarts[yFirst].append(edge);
+		}
+	}
+
+	QVector<FillEdge> vActive;
+	QVector<FillCrossing> vCross;
+	QVector<char> vInside(vPolygons.count(), 0);
+	for(int y = 0; y < height; y++)
+	{
+		// Drop the edges we are past, step the rest down a row and add the new ones
+		int iKept = 0;
+		for(int e = 0; e < vActive.count(); e++)
+		{
+			if(vActive[e].yEnd <= y) continue;
+			vActive[e].x += vActive[e].dxdy;
+			vActive[iKept++] = vActive[e];
+		}
+		vActive.resize(iKept);
+		vActive += vStarts[y];
+		vStarts[y].clear();
+		if(vActive.isEmpty()) continue;
+
+		vCross.resize(vActive.count());
+		for(int e = 0; e < vActive.count(); e++)
+		{
+			vCross[e].x = vActive[e].x;
+			vCross[e].iPolygon = vActive[e].iPolygon;
+		}
+		qSort(vCross);
+
+		// Walk the crossings left to right keeping the sum of the weights we are inside,
+		// each run where it is above 0 is lit.
+		QVector<int> &vRow = (*pRows)[y];
+		int iSum = 0;
+		int xFirst = 0;
+		for(int c = 0; c < vCross.count(); c++)
+		{
+			int p = vCross[c].iPolygon;
+			int w = vWeights.isEmpty() ? 1 : vWeights[p];
+			bool wasLit = iSum > 0;
+			vInside[p] = !vInside[p];
+			iSum += vInside[p] ? w : -w;
+			int xPixel = qBound(0, (int)qCeil(vCross[c].x - 0.5), width);
+			if(!wasLit && iSum > 0)
+				xFirst = xPixel;
+			else if(wasLit && iSum <= 0 && xPixel > xFirst)
+			{
+				if(!vRow.isEmpty() && vRow.last() == xFirst) vRow.last() = xPixel; // touching runs
+				else vRow << xFirst << xPixel;
+			}
+		}
+	}
+}
+
+void fillPolygons(QImage* pImage, const QVector<QPolygonF> &vPolygons, const QVector<int> &vWeights, QRgb color)
+{
+	SliceRuns vRows;
+	fillPolygonRuns(pImage->width(), pImage->height(), vPolygons, vWeights, &vRows);
+	for(int y = 0; y < vRows.count(); y++)
+	{
+		QRgb* pLine = (QRgb*)pImage->scanLine(y);
+		const QVector<int> &vRow = vRows[y];
+		for(int r = 0; r + 1 < vRow.count(); r += 2)
+			for(int x = vRow[r]; x < vRow[r+1]; x++) pLine[x] = color;
+	}
+}
+
+void fillPolygon(QImage* pImage, const QPolygonF &vPolygon, QRgb color)
+{
+	fillPolygons(pImage, QVector<QPolygonF>() << vPolygon, QVector<int>(), color);
+}
@@ -0,0 +1,202 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QStringList>
+#include <QPolygonF>
+#include <QtEndian>
+#include <QtDebug>
+#include <string.h>
+#include "slcsliceimporter.h"
+#include "polygonfill.h"
+
+#define SLCMAXHEADER 2048
+#define SLCRESERVED 256
+#define SLCENDOFLAYERS 0xffffffff
+
+SlcSliceImporter::SlcSliceImporter(QObject *parent) :
+    SliceImporter(parent)
+{
+    m_pData = NULL;
+    m_iSize = 0;
+    m_dScale = 1.0;
+    m_dPixelMM = 0.1;
+    m_iWidth = m_iHeight = 0;
+}
+
+SlcSliceImporter::~SlcSliceImporter()
+{
+    // The workers read the mapped file
+    stopWorkers();
+    close();
+}
+
+void SlcSliceImporter::close()
+{
+    if(m_pData != NULL) m_File.unmap((uchar*)m_pData);
+    m_pData = NULL;
+    m_iSize = 0;
+    m_File.close();
+}
+
+bool SlcSliceImporter::readU32(qint64 iPos, quint32* pValue)
+{
+    if(iPos < 0 || iPos+4 > m_iSize) return false;
+    *pValue = qFromLittleEndian<quint32>(m_pData + iPos);
+    return true;
+}
+
+float SlcSliceImporter::readFloat(qint64 iPos)
+{
+    quint32 uBits = qFromLittleEndian<quint32>(m_pData + iPos);
+    float f;
+    memcpy(&f, &uBits, sizeof(f));
+    return f;
+}
+
+bool SlcSliceImporter::open(QString sFile)
+{
+    close();
+    m_vLayerOffsets.clear();
+    m_vLayerBoundaries.clear();
+    m_vBounds = QRectF();
+    m_dScale = 1.0;
+    m_sError = "Invalid File";
+
+    m_File.setFileName(sFile);
+    if(!m_File.open(QIODevice::ReadOnly) || (m_pData = m_File.map(0, m_File.size())) == NULL){
+        m_sError = "Unable to open SLC file..";
+        close();
+        return false;
+    }
+    m_iSize = m_File.size();
+
+    // Header: text up to CR LF SUB, "-UNIT INCH" or "-UNIT MM" in it somewhere
+    qint64 iPos = -1;
+    for(qint64 i=0; i+2<m_iSize && i+2<=SLCMAXHEADER; i++){
+        if(m_pData[i]==0x0d && m_pData[i+1]==0x0a && m_pData[i+2]==0x1a){
+            iPos = i+3;
+            break;
+        }
+    }
+    if(iPos < 0) return false;
+    QStringList vHeader = QString::fromLatin1((const char*)m_pData, iPos-3).simplified().split(' ');
+    int iUnit = vHeader.indexOf("-UNIT");
+    if(iUnit >= 0 && iUnit+1 < vHeader.count() && vHeader[iUnit+1] == "INCH") m_dScale = 25.4;
+
+    // 3D reserved section, then the sample table: a count byte and 4 floats an entry
+    iPos += SLCRESERVED;
+    if(iPos >= m_iSize) return false;
+    iPos += 1 + 16*(qint64)m_pData[iPos];
+
+    // Contour section, one scan for the index and the bounds.  A layer is its minimum z,
+    // a boundary count, then per boundary a vertex count, a gap count and the x,y vertices.
+    float xMin = 0, yMin = 0, xMax = 0, yMax = 0;
+    bool bBounds = false;
+    quint32 uBoundaries = 0, uVertices, uGaps;
+    while(readU32(iPos+4, &uBoundaries) && uBoundaries != SLCENDOFLAYERS){
+        iPos += 8;
+        m_vLayerOffsets.append(iPos);
+        m_vLayerBoundaries.append(uBoundaries);
+        for(quint32 b=0; b<uBoundaries; b++){
+            if(!readU32(iPos, &uVertices) || !readU32(iPos+4, &uGaps)) return false;
+            iPos += 8;
+            if(iPos + 8*(qint64)uVertices > m_iSize) return false;
+            for(quint32 v=0; v<uVertices; v++, iPos+=8){
+                float x = readFloat(iPos);
+                float y = readFloat(iPos+4);
+                if(!bBounds){
+                    xMin = xMax = x;
+                    yMin = yMax = y;
+                    bBounds = true;
+                }
+                if(x < xMin) xMin = x;
+                if(x > xMax) xMax = x;
+                if(y < yMin) yMin = y;
+                if(y > yMax) yMax = y;
+            }
+        }
+    }
+    if(!bBounds) return false;
+
+    m_vBounds = QRectF(QPointF(xMin*m_dScale, yMin*m_dScale), QPointF(xMax*m_dScale, yMax*m_dScale));
+    m_sError.clear();
+    qDebug() << "SLC import:" << m_vLayerOffsets.count() << "layers," << m_vBounds;
+    return true;
+}
+
+void SlcSliceImporter::setPixelSize(double dPixelMM)
+{
+    m_dPixelMM = dPixelMM;
+    m_iWidth = (int)(m_vBounds.width()/dPixelMM);
+    m_iHeight = (int)(m_vBounds.height()/dPixelMM);
+}
+
+bool SlcSliceImporter::loadCrushed(int iIndex, CrushedBitMap* pCBM)
+{
+    if(iIndex<0 || iIndex>=m_vLayerOffsets.count() || m_iWidth<1 || m_iHeight<1) return false;
+
+    // The boundaries in pixels, y flipped so the slice has y down.  Counter clockwise
+    // boundaries are solid and clockwise ones are voids, a pixel is lit where it is
+    // inside more solids than voids.  open() has range checked all of this.
+    QVector<QPolygonF> vPolygons;
+    QVector<int> vWeights;
+    qint64 iPos = m_vLayerOffsets[iIndex];
+    double dScale = m_dScale/m_dPixelMM;
+    double x0 = m_vBounds.left()/m_dPixelMM;
+    double y0 = m_vBounds.top()/m_dPixelMM;
+    for(quint32 b=0; b<m_vLayerBoundaries[iIndex]; b++){
+        quint32 uVertices;
+        readU32(iPos, &uVertices);
+        iPos += 8;
+        QPolygonF vPolygon(uVertices);
+        double dArea = 0;
+        for(quint32 v=0; v<uVertices; v++, iPos+=8){
+            vPolygon[v] = QPointF(readFloat(iPos)*dScale - x0, readFloat(iPos+4)*dScale - y0);
+            if(v > 0) dArea += vPolygon[v-1].x()*vPolygon[v].y() - vPolygon[v].x()*vPolygon[v-1].y();
+        }
+        if(uVertices < 3) continue;
+        dArea += vPolygon[uVertices-1].x()*vPolygon[0].y() - vPolygon[0].x()*vPolygon[uVertices-1].y();
+        for(quint32 v=0; v<uVertices; v++) vPolygon[v].setY(m_iHeight - vPolygon[v].y());
+        vPolygons.append(vPolygon);
+        vWeights.append(dArea >= 0 ? 1 : -1);
+    }
+
+    SliceRuns vRows;
+    fillPolygonRuns(m_iWidth, m_iHeight, vPolygons, vWeights, &vRows);
+    return CrushedPrintJob::crushRuns(m_iWidth, m_iHeight, vRows, pCBM);
+}
@@ -0,0 +1,88 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLCSLICEIMPORTER_H
+#define SLCSLICEIMPORTER_H
+
+#include <QFile>
+#include <QRectF>
+#include "sliceimporter.h"
+
+/******************************************************
+SlcSliceImporter imports SLC contour files.  open() maps
+the file into memory and scans it once, indexing where
+each layer's boundaries start and the bounds of all of
+them.  The layers are then filled straight from the
+mapped file by the scanline polygon fill, whose row runs
+are crushed without an image, on the SliceImporter
+thread pool.
+******************************************************/
+class SlcSliceImporter : public SliceImporter
+{
+    Q_OBJECT
+public:
+    SlcSliceImporter(QObject *parent = 0);
+    ~SlcSliceImporter();
+
+    bool open(QString sFile);   // false if the file can't be mapped or has no contours
+    QString errorString(){return m_sError;}
+    int layerCount(){return m_vLayerOffsets.count();}
+    QRectF bounds(){return m_vBounds;}  // of all layers, in mm
+    void setPixelSize(double dPixelMM); // sets the slice size from bounds()
+
+protected:
+    bool loadCrushed(int iIndex, CrushedBitMap* pCBM);
+
+private:
+    void close();
+    bool readU32(qint64 iPos, quint32* pValue);
+    float readFloat(qint64 iPos);   // iPos must already be range checked
+
+    QFile m_File;
+    const uchar* m_pData;
+    qint64 m_iSize;
+    QVector<qint64> m_vLayerOffsets;    // of each layer's first boundary
+    QVector<quint32> m_vLayerBoundaries;
+    QRectF m_vBounds;
+    double m_dScale;                    // file units to mm
+    QString m_sError;
+    double m_dPixelMM;
+    int m_iWidth, m_iHeight;
+};
+
+#endif // SLCSLICEIMPORTER_H
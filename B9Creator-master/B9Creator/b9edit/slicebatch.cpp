@@ -0,0 +1,167 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QRunnable>
+#include <QThread>
+#include <QEventLoop>
+#include <QMutexLocker>
+#include "slicebatch.h"
+
+// Runs one layer of a batch on a pool thread
+class SliceBatchTask : public QRunnable
+{
+public:
+    SliceBatchTask(SliceBatch* pBatch, int iIndex){m_pBatch = pBatch; m_iIndex = iIndex;}
+    void run(){m_pBatch->runLayer(m_iIndex);}
+private:
+    SliceBatch* m_pBatch;
+    int m_iIndex;
+};
+
+SliceBatch::SliceBatch(QObject *parent) :
+    QObject(parent)
+{
+    m_bStop = false;
+    m_iTotal = m_iQueued = m_iDone = m_iProgress = m_iAhead = 0;
+    m_bCancelled = false;
+    m_bFinished = false;
+    m_Pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+SliceBatch::~SliceBatch()
+{
+    stopWorkers();
+}
+
+void SliceBatch::stopWorkers()
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_bStop = true;
+    }
+    m_Pool.waitForDone();
+}
+
+void SliceBatch::startLayers(int iTotal, int iAhead)
+{
+    m_iTotal = qMax(0, iTotal);
+    m_iQueued = m_iDone = m_iProgress = 0;
+    m_iAhead = iAhead;
+    m_bStop = false;
+    m_bCancelled = false;
+    m_bFinished = false;
+
+    queueMore();
+    if(m_iTotal<1) QMetaObject::invokeMethod(this, "collect", Qt::QueuedConnection);
+}
+
+bool SliceBatch::waitForFinished()
+{
+    if(!m_bFinished){
+        QEventLoop vLoop;
+        connect(this, SIGNAL(finished()), &vLoop, SLOT(quit()));
+        vLoop.exec();
+    }
+    return !m_bCancelled;
+}
+
+void SliceBatch::cancel()
+{
+    if(m_bFinished) return;
+    m_bCancelled = true;
+    finish();
+}
+
+void SliceBatch::queueMore()
+{
+    // Queued in layer order so the results come in roughly in order
+    int iLimit = m_iAhead>0 ? qMin(m_iTotal, m_iProgress + m_iAhead) : m_iTotal;
+    while(m_iQueued < iLimit)
+        m_Pool.start(new SliceBatchTask(this, m_iQueued++));
+}
+
+void SliceBatch::runLayer(int iIndex)
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(m_bStop) return;
+    }
+    processLayer(iIndex);
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(m_bStop) return;
+        m_iDone++;
+    }
+    QMetaObject::invokeMethod(this, "collect", Qt::QueuedConnection);
+}
+
+void SliceBatch::collect()
+{
+    if(m_bFinished) return;
+    int iDone;
+    {
+        QMutexLocker lock(&m_Mutex);
+        iDone = m_iDone;
+    }
+    bool bGoOn = collectLayers(iDone, &m_iProgress);
+    emit progress(m_iProgress);
+    if(!bGoOn){
+        finish();
+        return;
+    }
+    if(iDone < m_iTotal){
+        queueMore();
+        return;
+    }
+
+    m_Pool.waitForDone();
+    allLayersDone();
+    finish();
+}
+
+void SliceBatch::finish()
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_bStop = true;
+    }
+    m_Pool.waitForDone();
+    cleanUp();
+    m_bFinished = true;
+    emit finished();
+}
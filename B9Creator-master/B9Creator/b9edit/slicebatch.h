@@ -0,0 +1,102 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEBATCH_H
+#define SLICEBATCH_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThreadPool>
+
+/******************************************************
+SliceBatch runs one step per layer on a pool of threads
+and gathers the results on the GUI thread, for the slice
+importers, the exporter, the morphology and the island
+finder.  A subclass fills in its inputs, calls
+startLayers() and does each layer in processLayer().
+collectLayers() and allLayersDone() pick the results up
+as they come in, cleanUp() runs however the batch ends.
+run() style callers wait with waitForFinished().
+******************************************************/
+class SliceBatch : public QObject
+{
+    Q_OBJECT
+public:
+    SliceBatch(QObject *parent = 0);
+    ~SliceBatch();
+
+    bool isCancelled(){return m_bCancelled;}
+    bool isFinished(){return m_bFinished;}
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(int iLayers);
+    void finished();
+
+protected:
+    void startLayers(int iTotal, int iAhead = 0);  // layers 0 to iTotal-1, at most iAhead past the progress in flight, 0 for all at once
+    bool waitForFinished();  // runs an event loop until the batch is over, false if cancelled
+    void finish();           // stops the workers and ends the batch
+    void stopWorkers();      // a subclass calls this from its destructor, the workers call back into it
+    int layerTotal(){return m_iTotal;}
+    int maxThreads(){return m_Pool.maxThreadCount();}
+
+    virtual void processLayer(int iIndex) = 0;  // runs on the pool threads, keeps its result under m_Mutex
+    virtual bool collectLayers(int iDone, int* pProgress){*pProgress = iDone; return true;}  // after each layer, sets the progress to report, false to end the batch there
+    virtual void allLayersDone(){}  // every layer processed and the pool idle, not called if cancelled
+    virtual void cleanUp(){}        // the workers have stopped, done or cancelled
+
+    QMutex m_Mutex;             // guards the results the workers hand over, and m_bStop
+    bool m_bStop;               // workers skip what they have not started
+
+private slots:
+    void collect();
+
+private:
+    friend class SliceBatchTask;
+    void runLayer(int iIndex);
+    void queueMore();
+
+    QThreadPool m_Pool;
+    int m_iTotal, m_iQueued, m_iDone, m_iProgress, m_iAhead;
+    bool m_bCancelled, m_bFinished;
+};
+
+#endif // SLICEBATCH_H
@@ -0,0 +1,220 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QMutexLocker>
+#include <QBuffer>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QtDebug>
+#include "sliceexporter.h"
+
+SliceExporter::SliceExporter(QObject *parent) :
+    SliceBatch(parent)
+{
+    m_pCPJ = NULL;
+    m_eFormat = EXPORT_BMP;
+    m_iQuality = 100;
+    m_bShowSupports = false;
+    m_iWritten = 0;
+}
+
+SliceExporter::~SliceExporter()
+{
+    if(!isFinished() && m_pCPJ!=NULL) cancel();
+    stopWorkers();
+}
+
+QStringList SliceExporter::formatNames()
+{
+    QStringList vNames;
+    vNames << tr("BMP") << tr("TIFF") << tr("JPEG") << tr("PNG (1 bit)") << tr("Raw Bitmap (1 bit)");
+    return vNames;
+}
+
+QString SliceExporter::fileName(int iLayer)
+{
+    static const char* sExt[] = {"bmp", "tiff", "jpeg", "png", "raw"};
+    return QDir(m_sFolder).filePath(m_pCPJ->getName() + "_" + QString::number(iLayer+1) + "." + sExt[m_eFormat]);
+}
+
+void SliceExporter::start(CrushedPrintJob* pCPJ, QString sFolder, Format eFormat, int iQuality)
+{
+    m_pCPJ = pCPJ;
+    m_sFolder = sFolder;
+    m_eFormat = eFormat;
+    m_iQuality = iQuality;
+    m_iWritten = 0;
+    m_vSlices.clear();
+    for(int i=0; i<pCPJ->getTotalLayers(); i++) m_vSlices.append(pCPJ->copySlice(i));
+    m_vEncoded.clear();
+    m_vSizes.clear();
+    m_vRawInfo.clear();
+    m_sError.clear();
+
+    // Exports include supports and filled base layers.  The workers only read the job from here on
+    m_bShowSupports = pCPJ->renderingSupports();
+    pCPJ->showSupports(true);
+    qDebug() << "Exporting" << m_vSlices.count() << "layers to" << sFolder << "on" << maxThreads() << "threads";
+
+    // Keep a few layers per thread in flight, encoded layers wait in memory for the disk
+    startLayers(m_vSlices.count(), 4*maxThreads());
+}
+
+bool SliceExporter::run(CrushedPrintJob* pCPJ, QString sFolder, Format eFormat, int iQuality)
+{
+    start(pCPJ, sFolder, eFormat, iQuality);
+    return waitForFinished() && m_sError.isEmpty();
+}
+
+void SliceExporter::processLayer(int iLayer)
+{
+    QImage img;
+    CrushedPrintJob::inflateCopy(m_vSlices.at(iLayer), &img, 0, 0, true);
+    m_pCPJ->renderSliceExtras(iLayer, &img, 0, 0);
+
+    QByteArray baFile;
+    bool bOk = true;
+    if(m_eFormat == EXPORT_RAW1)
+        baFile = packRaw(toMono(img));
+    else {
+        QBuffer vBuffer(&baFile);
+        vBuffer.open(QIODevice::WriteOnly);
+        if(m_eFormat == EXPORT_PNG1)
+            bOk = toMono(img).save(&vBuffer, "PNG");
+        else if(m_eFormat == EXPORT_JPEG)
+            bOk = img.save(&vBuffer, "JPEG", m_iQuality);
+        else
+            bOk = img.save(&vBuffer, m_eFormat == EXPORT_TIFF ? "TIFF" : "BMP");
+    }
+
+    QMutexLocker lock(&m_Mutex);
+    if(!bOk && m_sError.isEmpty()) m_sError = tr("Unable to encode layer %1").arg(iLayer+1);
+    m_vEncoded[iLayer] = baFile;
+    m_vSizes[iLayer] = img.size();
+}
+
+bool SliceExporter::collectLayers(int iDone, int* pProgress)
+{
+    Q_UNUSED(iDone);
+
+    // Write whatever is next in layer order
+    while(m_iWritten < layerTotal()){
+        QByteArray baFile;
+        QSize vSize;
+        {
+            QMutexLocker lock(&m_Mutex);
+            if(!m_sError.isEmpty()) break;
+            if(!m_vEncoded.contains(m_iWritten)) break;
+            baFile = m_vEncoded.take(m_iWritten);
+            vSize = m_vSizes.take(m_iWritten);
+        }
+        QFile vFile(fileName(m_iWritten));
+        if(!vFile.open(QIODevice::WriteOnly) || vFile.write(baFile) != baFile.size()){
+            QMutexLocker lock(&m_Mutex);
+            m_sError = tr("Unable to write %1").arg(vFile.fileName());
+            break;
+        }
+        if(m_eFormat == EXPORT_RAW1)
+            m_vRawInfo.append(QString("%1 %2 %3").arg(QFileInfo(vFile.fileName()).fileName()).arg(vSize.width()).arg(vSize.height()));
+        m_iWritten++;
+    }
+    *pProgress = m_iWritten;
+
+    QMutexLocker lock(&m_Mutex);
+    if(!m_sError.isEmpty()){
+        qDebug() << "Export failed:" << m_sError;
+        return false;
+    }
+    return true;
+}
+
+void SliceExporter::allLayersDone()
+{
+    if(m_eFormat != EXPORT_RAW1) return;
+
+    // The raw files have no header, their sizes go here
+    QFile vInfo(QDir(m_sFolder).filePath(m_pCPJ->getName() + "_raw.txt"));
+    if(vInfo.open(QIODevice::WriteOnly | QIODevice::Text)){
+        vInfo.write("# file width height, 1 bit per pixel, rows padded to a byte, msb first, 1 = lit\n");
+        vInfo.write(m_vRawInfo.join("\n").toAscii() + "\n");
+    }
+    else m_sError = tr("Unable to write %1").arg(vInfo.fileName());
+}
+
+void SliceExporter::cleanUp()
+{
+    // nobody reads the job once we give it back
+    m_vSlices.clear();
+    m_vEncoded.clear();
+    m_vSizes.clear();
+    if(m_pCPJ!=NULL) m_pCPJ->showSupports(m_bShowSupports);
+}
+
+QImage SliceExporter::toMono(const QImage &img)
+{
+    // Same rule as CrushedBitMap: "mostly black" pixels are black, anything else is lit
+    QImage vImg = img;
+    if(vImg.format() != QImage::Format_ARGB32_Premultiplied && vImg.format() != QImage::Format_ARGB32 && vImg.format() != QImage::Format_RGB32)
+        vImg = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QImage vMono(vImg.size(), QImage::Format_Mono);
+    vMono.setColorCount(2);
+    vMono.setColor(0, qRgb(0,0,0));
+    vMono.setColor(1, qRgb(255,255,255));
+    vMono.fill(0);
+    for(int y=0; y<vImg.height(); y++){
+        const QRgb* pIn = (const QRgb*)vImg.constScanLine(y);
+        uchar* pOut = vMono.scanLine(y);
+        for(int x=0; x<vImg.width(); x++){
+            QRgb c = pIn[x];
+            if(qRed(c)>=32 || qGreen(c)>=32 || qBlue(c)>=32) pOut[x>>3] |= 0x80 >> (x&7);
+        }
+    }
+    return vMono;
+}
+
+QByteArray SliceExporter::packRaw(const QImage &mono)
+{
+    // Format_Mono rows are padded to 32 bits, the file's only to a byte
+    int iRowBytes = (mono.width()+7)/8;
+    QByteArray baRaw;
+    baRaw.reserve(iRowBytes*mono.height());
+    for(int y=0; y<mono.height(); y++)
+        baRaw.append((const char*)mono.constScanLine(y), iRowBytes);
+    return baRaw;
+}
@@ -0,0 +1,95 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEEXPORTER_H
+#define SLICEEXPORTER_H
+
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include "slicebatch.h"
+#include "crushbitmap.h"
+
+/******************************************************
+SliceExporter writes every layer of a job to a folder as
+an image file.  Layers are inflated and encoded on a
+pool of threads, a few ahead of the disk, and written in
+layer order from the GUI thread.  Besides the usual
+image formats it writes 1 bit PNGs and packed raw
+bitmaps (1 bit per pixel, rows padded to a byte, most
+significant bit leftmost, 1 for lit) with a text file
+giving each layer's size.
+******************************************************/
+class SliceExporter : public SliceBatch
+{
+    Q_OBJECT
+public:
+    enum Format {EXPORT_BMP, EXPORT_TIFF, EXPORT_JPEG, EXPORT_PNG1, EXPORT_RAW1};
+
+    SliceExporter(QObject *parent = 0);
+    ~SliceExporter();
+
+    static QStringList formatNames();  // for the user to pick from, in Format order
+
+    void start(CrushedPrintJob* pCPJ, QString sFolder, Format eFormat, int iQuality = 100);
+    bool run(CrushedPrintJob* pCPJ, QString sFolder, Format eFormat, int iQuality = 100);  // start and wait for it, false if cancelled or failed
+    QString errorString(){return m_sError;}  // empty unless something could not be written
+
+private:
+    void processLayer(int iLayer);  // inflates and encodes
+    bool collectLayers(int iDone, int* pProgress);  // writes in layer order, the progress is layers written
+    void allLayersDone();
+    void cleanUp();
+    QString fileName(int iLayer);
+    static QImage toMono(const QImage &img);
+    static QByteArray packRaw(const QImage &mono);
+
+    CrushedPrintJob* m_pCPJ;
+    QVector<CrushedBitMap> m_vSlices;   // copies sharing the job's bits, the workers don't touch its slice list
+    QString m_sFolder;
+    Format m_eFormat;
+    int m_iQuality;
+    bool m_bShowSupports;       // the job's setting before we turned supports on
+    int m_iWritten;
+    QHash<int, QByteArray> m_vEncoded;  // encoded layers waiting for their turn on disk
+    QHash<int, QSize> m_vSizes;
+    QStringList m_vRawInfo;
+    QString m_sError;
+};
+
+#endif // SLICEEXPORTER_H
@@ -0,0 +1,134 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QMutexLocker>
+#include <QtDebug>
+#include "sliceimporter.h"
+
+enum {SLICE_PENDING, SLICE_CRUSHED, SLICE_FAILED};
+
+SliceImporter::SliceImporter(QObject *parent) :
+    SliceBatch(parent)
+{
+    m_iFirstFailed = -1;
+    m_iOrdered = 0;
+}
+
+SliceImporter::~SliceImporter()
+{
+    stopWorkers();
+}
+
+void SliceImporter::start(const QStringList &vFiles)
+{
+    m_vFiles = vFiles;
+    start(vFiles.count());
+}
+
+bool SliceImporter::run(const QStringList &vFiles)
+{
+    start(vFiles);
+    return waitForFinished();
+}
+
+void SliceImporter::start(int iSlices)
+{
+    m_vSlices.clear();
+    m_vSlices.resize(iSlices);
+    m_vState.fill(SLICE_PENDING, iSlices);
+    m_iFirstFailed = -1;
+    m_iOrdered = 0;
+    qDebug() << "Importing" << iSlices << "slices on" << maxThreads() << "threads";
+    startLayers(iSlices);
+}
+
+bool SliceImporter::run(int iSlices)
+{
+    start(iSlices);
+    return waitForFinished();
+}
+
+bool SliceImporter::loadSlice(int iIndex, QImage* pImage)
+{
+    return iIndex<m_vFiles.count() && pImage->load(m_vFiles[iIndex]);
+}
+
+bool SliceImporter::loadCrushed(int iIndex, CrushedBitMap* pCBM)
+{
+    QImage img;
+    return loadSlice(iIndex, &img) && CrushedPrintJob::crushImage(&img, pCBM);
+}
+
+void SliceImporter::processLayer(int iIndex)
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(m_iFirstFailed>=0 && iIndex>m_iFirstFailed) return;
+    }
+
+    CrushedBitMap CBM;
+    bool bOk = loadCrushed(iIndex, &CBM);
+
+    QMutexLocker lock(&m_Mutex);
+    m_vSlices[iIndex] = CBM;
+    m_vState[iIndex] = bOk ? SLICE_CRUSHED : SLICE_FAILED;
+    if(!bOk && (m_iFirstFailed<0 || iIndex<m_iFirstFailed)) m_iFirstFailed = iIndex;
+}
+
+bool SliceImporter::collectLayers(int iDone, int* pProgress)
+{
+    Q_UNUSED(iDone);
+    int iFirstFailed;
+    {
+        QMutexLocker lock(&m_Mutex);
+        while(m_iOrdered<m_vState.count() && m_vState[m_iOrdered]==SLICE_CRUSHED) m_iOrdered++;
+        iFirstFailed = m_iFirstFailed;
+    }
+    *pProgress = m_iOrdered;
+    if(m_iOrdered==iFirstFailed){
+        qDebug() << "Slice import stopped at slice" << iFirstFailed+1;
+        return false;
+    }
+    return true;
+}
+
+void SliceImporter::addTo(CrushedPrintJob* pCPJ)
+{
+    for(int i=0; i<m_iOrdered; i++)
+        pCPJ->addCrushed(m_vSlices[i]);
+}
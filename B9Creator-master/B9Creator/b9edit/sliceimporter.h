@@ -0,0 +1,85 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEIMPORTER_H
+#define SLICEIMPORTER_H
+
+#include <QStringList>
+#include <QVector>
+#include "slicebatch.h"
+#include "crushbitmap.h"
+
+/******************************************************
+SliceImporter loads and crushes a sequence of slice
+images on a pool of threads.  The crushed slices are
+collected in file order, up to the first file that does
+not load, and only handed to a job with addTo() once the
+whole sequence is in.  A cancelled import leaves the job
+as it was.  Other sources of slices override loadSlice,
+or loadCrushed if they can crush without an image.
+******************************************************/
+class SliceImporter : public SliceBatch
+{
+    Q_OBJECT
+public:
+    SliceImporter(QObject *parent = 0);
+    ~SliceImporter();
+
+    void start(const QStringList &vFiles);
+    bool run(const QStringList &vFiles);  // start and wait for it, false if cancelled
+    void start(int iSlices);              // slices 0 to iSlices-1 from loadSlice
+    bool run(int iSlices);
+    int sliceCount(){return m_iOrdered;}  // slices crushed, in order, without a gap
+    void addTo(CrushedPrintJob* pCPJ);    // appends them to pCPJ
+
+protected:
+    virtual bool loadSlice(int iIndex, QImage* pImage);  // runs on the pool threads, loads file iIndex unless overridden
+    virtual bool loadCrushed(int iIndex, CrushedBitMap* pCBM);  // runs on the pool threads, crushes loadSlice's image unless overridden
+
+private:
+    void processLayer(int iIndex);
+    bool collectLayers(int iDone, int* pProgress);
+
+    QStringList m_vFiles;
+    QVector<CrushedBitMap> m_vSlices;
+    QVector<char> m_vState;     // SLICE_ values
+    int m_iFirstFailed;         // files from here on are not imported, -1 if none failed (yet)
+    int m_iOrdered;
+};
+
+#endif // SLICEIMPORTER_H
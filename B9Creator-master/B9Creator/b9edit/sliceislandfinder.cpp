@@ -0,0 +1,328 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QMutexLocker>
+#include <QtDebug>
+#include <QtAlgorithms>
+#include <qmath.h>
+#include "sliceislandfinder.h"
+#include "slicemorphology.h"
+
+// What we add up over a connected area
+struct IslandArea {
+    qint64 iArea;
+    double dSumX, dSumY;
+    bool bTouched;      // a top area with anything under it
+    int iParent;        // an overhang's top area
+    int iCandidate;     // index in this layer's candidates, -1 if not one
+    double dBest;       // squared distance of the nearest pixel to the centroid found so far
+};
+
+// One run, for sorting runs added to a row by where they start
+struct IslandRun {
+    int iStart, iEnd;
+    bool operator<(const IslandRun &other) const {return iStart < other.iStart;}
+};
+
+static bool candidateRank(const SupportCandidate &a, const SupportCandidate &b)
+{
+    if(a.bIsland != b.bIsland) return a.bIsland;
+    if(a.iArea != b.iArea) return a.iArea > b.iArea;
+    return a.iLayer < b.iLayer;
+}
+
+static void addRun(QVector<int> &vRow, int iStart, int iEnd, int iWidth)
+{
+    // Adds a run to a row keeping it sorted with no overlapping runs
+    iStart = qMax(0, iStart);
+    iEnd = qMin(iWidth, iEnd);
+    if(iStart >= iEnd) return;
+    QVector<IslandRun> vRuns;
+    for(int r=0; r+1<vRow.count(); r+=2){
+        IslandRun vRun = {vRow[r], vRow[r+1]};
+        vRuns.append(vRun);
+    }
+    IslandRun vNew = {iStart, iEnd};
+    vRuns.append(vNew);
+    qSort(vRuns);
+    vRow.clear();
+    int s = vRuns[0].iStart, e = vRuns[0].iEnd;
+    for(int r=1; r<vRuns.count(); r++){
+        if(vRuns[r].iStart > e){
+            vRow << s << e;
+            s = vRuns[r].iStart;
+        }
+        if(vRuns[r].iEnd > e) e = vRuns[r].iEnd;
+    }
+    vRow << s << e;
+}
+
+static void addPixels(IslandArea &vArea, int iStart, int iEnd, int y)
+{
+    int n = iEnd - iStart;
+    vArea.iArea += n;
+    vArea.dSumX += n*(iStart + iEnd - 1)/2.0;
+    vArea.dSumY += (double)n*y;
+}
+
+static void nearestPixel(IslandArea &vArea, SupportCandidate &vCandidate, int iStart, int iEnd, int y)
+{
+    double cx = vCandidate.vCentroid.x(), cy = vCandidate.vCentroid.y();
+    int x = qBound(iStart, qRound(cx), iEnd-1);
+    double d = (x-cx)*(x-cx) + (y-cy)*(y-cy);
+    if(d < vArea.dBest){
+        vArea.dBest = d;
+        vCandidate.vPoint = QPoint(x, y);
+    }
+}
+
+SliceIslandFinder::SliceIslandFinder(QObject *parent) :
+    SliceBatch(parent)
+{
+    m_iFirst = 0;
+    m_iReach = 0;
+    m_iMinOverhang = 1;
+}
+
+SliceIslandFinder::~SliceIslandFinder()
+{
+    stopWorkers();
+}
+
+void SliceIslandFinder::start(CrushedPrintJob* pCPJ, int iReach, int iMinOverhang)
+{
+    m_iReach = qMax(0, iReach);
+    m_iMinOverhang = qMax(1, iMinOverhang);
+    // Without base layers the first layer sits on the build table, with them it stands off it
+    m_iFirst = firstLayer(pCPJ);
+    int iTotal = qMax(0, pCPJ->getTotalLayers() - m_iFirst);
+    m_vFound.clear();
+    m_vFound.resize(iTotal);
+    m_vCandidates.clear();
+
+    // Everything the workers need is copied here, they never touch the job itself
+    m_vInputs.clear();
+    m_vInputs.resize(iTotal);
+    for(int i=0; i<iTotal; i++){
+        int iLayer = m_iFirst + i;
+        LayerInput &vInput = m_vInputs[i];
+        vInput.CBM = pCPJ->copySlice(iLayer);
+        vInput.CBMBelow = pCPJ->copySlice(iLayer-1);
+        if(iLayer-1 < pCPJ->getFilled()) vInput.vFilled = pCPJ->getExtents(iLayer-1);
+        vInput.vSupports = pCPJ->getSupports(iLayer-1);
+    }
+    qDebug() << "Looking for unsupported areas on" << iTotal << "layers on" << maxThreads() << "threads";
+    startLayers(iTotal);
+}
+
+bool SliceIslandFinder::run(CrushedPrintJob* pCPJ, int iReach, int iMinOverhang)
+{
+    start(pCPJ, iReach, iMinOverhang);
+    return waitForFinished();
+}
+
+int SliceIslandFinder::label(const SliceRuns &vRows, QVector<int>* pRunLabel)
+{
+    // Union find over all the runs, numbered row by row.  Runs on neighbouring
+    // rows are joined when they touch, corners included.
+    QVector<int> vParent;
+    int iPrevFirst = 0, iFirst = 0;
+    for(int y=0; y<vRows.count(); y++){
+        const QVector<int> &vRow = vRows[y];
+        for(int r=0; r+1<vRow.count(); r+=2) vParent.append(iFirst + r/2);
+        if(y > 0){
+            const QVector<int> &vPrev = vRows[y-1];
+            int a = 0, b = 0;
+            while(a+1<vRow.count() && b+1<vPrev.count()){
+                if(vRow[a] <= vPrev[b+1] && vPrev[b] <= vRow[a+1]){
+                    int i = iFirst + a/2, j = iPrevFirst + b/2;
+                    while(vParent[i] != i) i = vParent[i] = vParent[vParent[i]];
+                    while(vParent[j] != j) j = vParent[j] = vParent[vParent[j]];
+                    if(i != j) vParent[qMax(i,j)] = qMin(i,j);
+                }
+                if(vRow[a+1] < vPrev[b+1]) a += 2; else b += 2;
+            }
+        }
+        iPrevFirst = iFirst;
+        iFirst += vRow.count()/2;
+    }
+
+    // A run's parent never has a higher index than the run, so in one pass in order
+    // every parent already points at its root and the areas are numbered 0 to n-1
+    int iLabels = 0;
+    pRunLabel->resize(vParent.count());
+    for(int i=0; i<vParent.count(); i++){
+        int j = vParent[i];
+        while(vParent[j] != j) j = vParent[j];
+        vParent[i] = j;
+        (*pRunLabel)[i] = (j == i) ? iLabels++ : (*pRunLabel)[j];
+    }
+    return iLabels;
+}
+
+void SliceIslandFinder::processLayer(int iIndex)
+{
+    const LayerInput &vInput = m_vInputs.at(iIndex);
+    SliceRuns vTop, vUnder;
+    QSize vSize = CrushedPrintJob::inflateRuns(vInput.CBM, &vTop);
+    int iWidth = vSize.width(), iHeight = vSize.height();
+    vTop.resize(iHeight);
+    CrushedPrintJob::inflateRuns(vInput.CBMBelow, &vUnder);
+    vUnder.resize(iHeight);
+
+    // What holds this layer up: the layer below, a filled base layer and the supports
+    if(!vInput.vFilled.isEmpty())
+        for(int y=qMax(0, vInput.vFilled.top()); y<=vInput.vFilled.bottom() && y<iHeight; y++)
+            addRun(vUnder[y], vInput.vFilled.left(), vInput.vFilled.right()+1, iWidth);
+    for(int i=0; i<vInput.vSupports.count(); i++){
+        // counted as a disk of the support's size
+        SimpleSupport vSupport = vInput.vSupports[i];
+        int iRadius = vSupport.getSize()/2;
+        QPoint vCenter = vSupport.getPoint();
+        for(int dy=-iRadius; dy<=iRadius; dy++){
+            int y = vCenter.y() + dy;
+            if(y < 0 || y >= iHeight) continue;
+            int w = (int)qFloor(qSqrt((double)(iRadius*iRadius - dy*dy)));
+            addRun(vUnder[y], vCenter.x()-w, vCenter.x()+w+1, iWidth);
+        }
+    }
+
+    // The layer's connected areas, and which of them have anything under them
+    QVector<int> vTopLabel;
+    QVector<IslandArea> vTopAreas(label(vTop, &vTopLabel));
+    for(int i=0; i<vTopAreas.count(); i++){
+        IslandArea vArea = {0, 0.0, 0.0, false, -1, -1, 0.0};
+        vTopAreas[i] = vArea;
+    }
+    int k = 0;
+    for(int y=0; y<iHeight; y++){
+        const QVector<int> &vRow = vTop[y];
+        const QVector<int> &vBelowRow = vUnder[y];
+        int b = 0;
+        for(int r=0; r+1<vRow.count(); r+=2, k++){
+            IslandArea &vArea = vTopAreas[vTopLabel[k]];
+            addPixels(vArea, vRow[r], vRow[r+1], y);
+            while(b+1<vBelowRow.count() && vBelowRow[b+1] <= vRow[r]) b += 2;
+            if(b+1<vBelowRow.count() && vBelowRow[b] < vRow[r+1]) vArea.bTouched = true;
+        }
+    }
+
+    // What reaches further out than iReach past what is below
+    SliceRuns vReach, vOut(iHeight);
+    QVector<int> vOutParent;
+    if(m_iReach > 0) SliceMorphology::grow(vUnder, &vReach, iWidth, m_iReach);
+    else vReach = vUnder;
+    k = 0;
+    for(int y=0; y<iHeight; y++){
+        const QVector<int> &vRow = vTop[y];
+        const QVector<int> &vReachRow = vReach[y];
+        int b = 0;
+        for(int r=0; r+1<vRow.count(); r+=2, k++){
+            // vRow's run minus the reach runs
+            int x = vRow[r];
+            while(b+1<vReachRow.count() && vReachRow[b+1] <= x) b += 2;
+            for(int c=b; c+1<vReachRow.count() && vReachRow[c] < vRow[r+1]; c+=2){
+                if(vReachRow[c] > x){
+                    vOut[y] << x << vReachRow[c];
+                    vOutParent.append(vTopLabel[k]);
+                }
+                x = qMax(x, vReachRow[c+1]);
+            }
+            if(x < vRow[r+1]){
+                vOut[y] << x << vRow[r+1];
+                vOutParent.append(vTopLabel[k]);
+            }
+        }
+    }
+    QVector<int> vOutLabel;
+    QVector<IslandArea> vOutAreas(label(vOut, &vOutLabel));
+    for(int i=0; i<vOutAreas.count(); i++){
+        IslandArea vArea = {0, 0.0, 0.0, false, -1, -1, 0.0};
+        vOutAreas[i] = vArea;
+    }
+    k = 0;
+    for(int y=0; y<iHeight; y++)
+        for(int r=0; r+1<vOut[y].count(); r+=2, k++){
+            IslandArea &vArea = vOutAreas[vOutLabel[k]];
+            addPixels(vArea, vOut[y][r], vOut[y][r+1], y);
+            vArea.iParent = vOutParent[k];
+        }
+
+    // Islands, and overhangs big enough to matter on parts that are not islands already
+    QList<SupportCandidate> vFound;
+    for(int pass=0; pass<2; pass++){
+        QVector<IslandArea> &vAreas = pass==0 ? vTopAreas : vOutAreas;
+        for(int i=0; i<vAreas.count(); i++){
+            IslandArea &vArea = vAreas[i];
+            if(pass==0 && vArea.bTouched) continue;
+            if(pass==1 && (vArea.iArea < m_iMinOverhang || !vTopAreas[vArea.iParent].bTouched)) continue;
+            SupportCandidate vCandidate;
+            vCandidate.iLayer = m_iFirst + iIndex;
+            vCandidate.vCentroid = QPointF(vArea.dSumX/vArea.iArea, vArea.dSumY/vArea.iArea);
+            vCandidate.iArea = (int)vArea.iArea;
+            vCandidate.bIsland = pass==0;
+            vArea.iCandidate = vFound.count();
+            vArea.dBest = 1e30;
+            vFound.append(vCandidate);
+        }
+    }
+    k = 0;
+    for(int y=0; y<iHeight; y++)
+        for(int r=0; r+1<vTop[y].count(); r+=2, k++){
+            IslandArea &vArea = vTopAreas[vTopLabel[k]];
+            if(vArea.iCandidate>=0) nearestPixel(vArea, vFound[vArea.iCandidate], vTop[y][r], vTop[y][r+1], y);
+        }
+    k = 0;
+    for(int y=0; y<iHeight; y++)
+        for(int r=0; r+1<vOut[y].count(); r+=2, k++){
+            IslandArea &vArea = vOutAreas[vOutLabel[k]];
+            if(vArea.iCandidate>=0) nearestPixel(vArea, vFound[vArea.iCandidate], vOut[y][r], vOut[y][r+1], y);
+        }
+
+    QMutexLocker lock(&m_Mutex);
+    m_vFound[iIndex] = vFound;
+}
+
+void SliceIslandFinder::allLayersDone()
+{
+    for(int i=0; i<m_vFound.count(); i++) m_vCandidates += m_vFound[i];
+    m_vFound.clear();
+    m_vInputs.clear();
+    qStableSort(m_vCandidates.begin(), m_vCandidates.end(), candidateRank);
+    qDebug() << "Found" << m_vCandidates.count() << "unsupported areas";
+}
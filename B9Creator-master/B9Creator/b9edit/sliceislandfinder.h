@@ -0,0 +1,102 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEISLANDFINDER_H
+#define SLICEISLANDFINDER_H
+
+#include <QVector>
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include "slicebatch.h"
+#include "crushbitmap.h"
+
+// One place that wants a support
+struct SupportCandidate {
+    int iLayer;         // the unsupported layer, its support ends on the layer below
+    QPointF vCentroid;  // of the unsupported area
+    QPoint vPoint;      // where to put the support: the centroid if it is on the area, else the nearest pixel that is
+    int iArea;          // unsupported pixels
+    bool bIsland;       // nothing at all below it, otherwise an overhang of a supported part
+};
+
+/******************************************************
+SliceIslandFinder looks over a job for the places that
+need supports.  Each layer's lit row runs are labelled
+into connected areas and checked against the layer below
+(with its supports): areas with nothing below them are
+islands, and large areas hanging further out than the
+resin holds up by itself are overhangs.  Layers are done
+on a pool of threads, the found places are ranked
+islands first, then by area.
+******************************************************/
+class SliceIslandFinder : public SliceBatch
+{
+    Q_OBJECT
+public:
+    SliceIslandFinder(QObject *parent = 0);
+    ~SliceIslandFinder();
+
+    // iReach: pixels a layer may hang past the one below by itself, iMinOverhang: smallest overhang area reported
+    void start(CrushedPrintJob* pCPJ, int iReach, int iMinOverhang);
+    bool run(CrushedPrintJob* pCPJ, int iReach, int iMinOverhang);  // start and wait for it, false if cancelled
+    int layerCount(){return layerTotal();}
+    static int firstLayer(CrushedPrintJob* pCPJ){return pCPJ->getBase() > 0 ? pCPJ->getBase() : 1;}  // the layers below it need no support
+    QList<SupportCandidate> candidates(){return m_vCandidates;}  // ranked, valid once finished
+
+private:
+    // Everything a worker needs about one layer, copied from the job up front so they never touch it
+    struct LayerInput {
+        CrushedBitMap CBM;      // the layer
+        CrushedBitMap CBMBelow; // the slice below, or a fake base layer
+        QRect vFilled;          // a filled base layer's extents below, empty if none
+        QList<SimpleSupport> vSupports;  // ending on the layer below
+    };
+    void processLayer(int iIndex);  // finds the layer's unsupported areas
+    void allLayersDone();           // ranks them
+    static int label(const SliceRuns &vRows, QVector<int>* pRunLabel);
+
+    int m_iFirst;
+    int m_iReach, m_iMinOverhang;
+    QVector<LayerInput> m_vInputs;
+    QVector< QList<SupportCandidate> > m_vFound;
+    QList<SupportCandidate> m_vCandidates;
+};
+
+#endif // SLICEISLANDFINDER_H
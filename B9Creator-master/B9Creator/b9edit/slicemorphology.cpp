@@ -0,0 +1,213 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QMutexLocker>
+#include <QtDebug>
+#include <QtAlgorithms>
+#include <qmath.h>
+#include "slicemorphology.h"
+
+// One run, for sorting runs gathered from several rows by where they start
+struct MorphRun {
+    int iStart, iEnd;
+    bool operator<(const MorphRun &other) const {return iStart < other.iStart;}
+};
+
+SliceMorphology::SliceMorphology(QObject *parent) :
+    SliceBatch(parent)
+{
+    m_pCPJ = NULL;
+    m_iFirst = 0;
+    m_eOp = MORPH_GROW;
+    m_iRadius = 0;
+}
+
+SliceMorphology::~SliceMorphology()
+{
+    stopWorkers();
+}
+
+QStringList SliceMorphology::operationNames()
+{
+    QStringList vNames;
+    vNames << tr("Grow") << tr("Shrink") << tr("Shift");
+    return vNames;
+}
+
+void SliceMorphology::start(CrushedPrintJob* pCPJ, int iFirst, int iLast, Operation eOp, int iRadius, QPoint vShift)
+{
+    m_pCPJ = pCPJ;
+    m_iFirst = qMax(iFirst, pCPJ->getBase());
+    int iTotal = qMax(0, qMin(iLast, pCPJ->getTotalLayers()-1) - m_iFirst + 1);
+    m_eOp = eOp;
+    m_iRadius = qMax(0, iRadius);
+    m_vShift = vShift;
+    m_vSlices.clear();
+    for(int i=0; i<iTotal; i++) m_vSlices.append(pCPJ->copySlice(m_iFirst+i));
+    m_vResults.clear();
+    m_vResults.resize(iTotal);
+    qDebug() << "Morphology" << operationNames()[eOp] << "on" << iTotal << "layers from" << m_iFirst+1 << "on" << maxThreads() << "threads";
+    startLayers(iTotal);
+}
+
+bool SliceMorphology::run(CrushedPrintJob* pCPJ, int iFirst, int iLast, Operation eOp, int iRadius, QPoint vShift)
+{
+    start(pCPJ, iFirst, iLast, eOp, iRadius, vShift);
+    return waitForFinished();
+}
+
+void SliceMorphology::processLayer(int iIndex)
+{
+    const CrushedBitMap &CBM = m_vSlices.at(iIndex);
+    SliceRuns vIn, vOut;
+    QSize vSize = CrushedPrintJob::inflateRuns(CBM, &vIn);
+    if(m_eOp == MORPH_GROW)
+        grow(vIn, &vOut, vSize.width(), m_iRadius);
+    else if(m_eOp == MORPH_SHRINK)
+        shrink(vIn, &vOut, vSize.width(), m_iRadius);
+    else
+        shift(vIn, &vOut, vSize.width(), m_vShift);
+    CrushedBitMap vResult;
+    if(!CrushedPrintJob::crushRuns(vSize.width(), vSize.height(), vOut, &vResult)) vResult = CBM;
+
+    QMutexLocker lock(&m_Mutex);
+    m_vResults[iIndex] = vResult;
+}
+
+void SliceMorphology::allLayersDone()
+{
+    for(int i=0; i<m_vResults.count(); i++)
+        m_pCPJ->setCrushed(m_iFirst+i, m_vResults[i]);
+    m_vResults.clear();
+    m_vSlices.clear();
+}
+
+QVector<int> SliceMorphology::diskHalfWidths(int iRadius)
+{
+    // A pixel is in the disk if its center is within iRadius of the middle one
+    QVector<int> vHalf(2*iRadius+1);
+    for(int dy=-iRadius; dy<=iRadius; dy++)
+        vHalf[dy+iRadius] = (int)qFloor(qSqrt((double)(iRadius*iRadius - dy*dy)));
+    return vHalf;
+}
+
+void SliceMorphology::grow(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, int iRadius)
+{
+    // A pixel is lit if the disk around it touches a lit pixel: the union of the rows
+    // within iRadius, each run widened by the disk's half width at that row.
+    int iHeight = vIn.count();
+    QVector<int> vHalf = diskHalfWidths(iRadius);
+    QVector<MorphRun> vRuns;
+    pOut->clear();
+    pOut->resize(iHeight);
+    for(int y=0; y<iHeight; y++){
+        vRuns.clear();
+        for(int dy=-iRadius; dy<=iRadius; dy++){
+            if(y+dy<0 || y+dy>=iHeight) continue;
+            const QVector<int> &vRow = vIn[y+dy];
+            int w = vHalf[dy+iRadius];
+            for(int r=0; r+1<vRow.count(); r+=2){
+                MorphRun vRun;
+                vRun.iStart = qMax(0, vRow[r]-w);
+                vRun.iEnd = qMin(iWidth, vRow[r+1]+w);
+                vRuns.append(vRun);
+            }
+        }
+        if(vRuns.isEmpty()) continue;
+        qSort(vRuns);
+        QVector<int> &vRow = (*pOut)[y];
+        int iStart = vRuns[0].iStart, iEnd = vRuns[0].iEnd;
+        for(int r=1; r<vRuns.count(); r++){
+            if(vRuns[r].iStart > iEnd){
+                vRow << iStart << iEnd;
+                iStart = vRuns[r].iStart;
+            }
+            if(vRuns[r].iEnd > iEnd) iEnd = vRuns[r].iEnd;
+        }
+        vRow << iStart << iEnd;
+    }
+}
+
+void SliceMorphology::shrink(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, int iRadius)
+{
+    // A pixel stays lit if the disk around it is all lit: the intersection of the rows
+    // within iRadius, each run narrowed by the disk's half width at that row.  Outside
+    // the slice counts as dark, so nothing within iRadius of the top or bottom survives.
+    Q_UNUSED(iWidth);
+    int iHeight = vIn.count();
+    QVector<int> vHalf = diskHalfWidths(iRadius);
+    QVector<int> vCur, vNext;
+    pOut->clear();
+    pOut->resize(iHeight);
+    for(int y=iRadius; y<iHeight-iRadius; y++){
+        vCur = vIn[y];
+        for(int dy=-iRadius; dy<=iRadius && !vCur.isEmpty(); dy++){
+            const QVector<int> &vRow = vIn[y+dy];
+            int w = vHalf[dy+iRadius];
+            // intersect vCur with vRow narrowed by w, both sorted
+            vNext.clear();
+            int a = 0, b = 0;
+            while(a+1<vCur.count() && b+1<vRow.count()){
+                int iStart = qMax(vCur[a], vRow[b]+w);
+                int iEnd = qMin(vCur[a+1], vRow[b+1]-w);
+                if(iStart < iEnd) vNext << iStart << iEnd;
+                if(vCur[a+1] < vRow[b+1]-w) a += 2; else b += 2;
+            }
+            vCur = vNext;
+        }
+        (*pOut)[y] = vCur;
+    }
+}
+
+void SliceMorphology::shift(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, QPoint vShift)
+{
+    int iHeight = vIn.count();
+    pOut->clear();
+    pOut->resize(iHeight);
+    for(int y=0; y<iHeight; y++){
+        int ySource = y - vShift.y();
+        if(ySource<0 || ySource>=iHeight) continue;
+        const QVector<int> &vRow = vIn[ySource];
+        QVector<int> &vOut = (*pOut)[y];
+        for(int r=0; r+1<vRow.count(); r+=2){
+            int iStart = qMax(0, vRow[r]+vShift.x());
+            int iEnd = qMin(iWidth, vRow[r+1]+vShift.x());
+            if(iStart < iEnd) vOut << iStart << iEnd;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEMORPHOLOGY_H
+#define SLICEMORPHOLOGY_H
+
+#include <QStringList>
+#include <QVector>
+#include <QPoint>
+#include "slicebatch.h"
+#include "crushbitmap.h"
+
+/******************************************************
+SliceMorphology grows, shrinks or shifts a range of a
+job's layers, to make up for resin bleed and shrinkage
+without slicing again.  It works on the crushed slices'
+row runs, never an image: growing by a radius is the
+union of the neighbouring rows' runs widened to a disk,
+shrinking the intersection of them narrowed.  Layers are
+done on a pool of threads and only put back in the job
+once all of them are, a cancel leaves the job as it was.
+******************************************************/
+class SliceMorphology : public SliceBatch
+{
+    Q_OBJECT
+public:
+    enum Operation {MORPH_GROW, MORPH_SHRINK, MORPH_SHIFT};
+
+    SliceMorphology(QObject *parent = 0);
+    ~SliceMorphology();
+
+    static QStringList operationNames();  // for the user to pick from, in Operation order
+
+    // Layers iFirst to iLast, base layers are left alone.  iRadius in pixels for grow and shrink, vShift for shift
+    void start(CrushedPrintJob* pCPJ, int iFirst, int iLast, Operation eOp, int iRadius, QPoint vShift = QPoint());
+    bool run(CrushedPrintJob* pCPJ, int iFirst, int iLast, Operation eOp, int iRadius, QPoint vShift = QPoint());  // start and wait for it, false if cancelled
+    int layerCount(){return layerTotal();}
+
+    static void grow(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, int iRadius);
+    static void shrink(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, int iRadius);
+    static void shift(const SliceRuns &vIn, SliceRuns* pOut, int iWidth, QPoint vShift);
+
+private:
+    void processLayer(int iIndex);
+    void allLayersDone();   // puts the results in the job
+    static QVector<int> diskHalfWidths(int iRadius);   // for rows -iRadius to iRadius
+
+    CrushedPrintJob* m_pCPJ;
+    int m_iFirst;
+    Operation m_eOp;
+    int m_iRadius;
+    QPoint m_vShift;
+    QVector<CrushedBitMap> m_vSlices;   // copies sharing the job's bits, the workers never touch the job itself
+    QVector<CrushedBitMap> m_vResults;
+};
+
+#endif // SLICEMORPHOLOGY_H
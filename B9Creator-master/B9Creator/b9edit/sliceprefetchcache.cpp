@@ -0,0 +1,220 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QRunnable>
+#include <QSettings>
+#include <QMutexLocker>
+#include "sliceprefetchcache.h"
+
+// Inflates one slice on the pool thread
+class SlicePrefetchTask : public QRunnable
+{
+public:
+    SlicePrefetchTask(SlicePrefetchCache* pCache, int iGeneration, int iVersion, int iSlice, CrushedBitMap CBM)
+        {m_pCache = pCache; m_iGeneration = iGeneration; m_iVersion = iVersion; m_iSlice = iSlice; m_CBM = CBM;}
+    void run(){m_pCache->inflate(m_iGeneration, m_iVersion, m_iSlice, m_CBM);}
+private:
+    SlicePrefetchCache* m_pCache;
+    int m_iGeneration, m_iVersion, m_iSlice;
+    CrushedBitMap m_CBM;
+};
+
+SlicePrefetchCache::SlicePrefetchCache(QObject *parent) :
+    QObject(parent)
+{
+    m_pCPJ = NULL;
+    m_xOffset = m_yOffset = 0;
+    m_iGeneration = 0;
+    m_iBytes = 0;
+    m_iCenter = -1;
+    m_iDirection = 1;
+    QSettings settings;
+    m_iBudget = (qint64)settings.value("SliceCacheMB",SLICECACHEMB).toInt()*1048576;
+
+    // One thread, the slices are wanted nearest first
+    m_Pool.setMaxThreadCount(1);
+}
+
+SlicePrefetchCache::~SlicePrefetchCache()
+{
+    clear();
+}
+
+void SlicePrefetchCache::setJob(CrushedPrintJob* pCPJ, int xOffset, int yOffset)
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(pCPJ==m_pCPJ && xOffset==m_xOffset && yOffset==m_yOffset) return;
+    }
+    clear();
+    m_pCPJ = pCPJ;
+    m_xOffset = xOffset;
+    m_yOffset = yOffset;
+}
+
+void SlicePrefetchCache::clear()
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_iGeneration++;  // anything still queued returns at once
+    }
+    m_Pool.waitForDone();
+
+    QMutexLocker lock(&m_Mutex);
+    m_vImages.clear();
+    m_vRecent.clear();
+    m_vPending.clear();
+    m_vVersion.clear();
+    m_iBytes = 0;
+    m_iCenter = -1;
+}
+
+void SlicePrefetchCache::invalidate(int iSlice)
+{
+    QMutexLocker lock(&m_Mutex);
+    m_vVersion[iSlice]++;
+    m_vPending.remove(iSlice);
+    if(!m_vImages.contains(iSlice)) return;
+    m_iBytes -= m_vImages[iSlice].byteCount();
+    m_vImages.remove(iSlice);
+    m_vRecent.removeAll(iSlice);
+}
+
+bool SlicePrefetchCache::fetch(int iSlice, QImage* pImage)
+{
+    QMutexLocker lock(&m_Mutex);
+    if(!m_vImages.contains(iSlice)) return false;
+    *pImage = m_vImages[iSlice];  // shared until the caller draws on it
+    m_vRecent.removeAll(iSlice);
+    m_vRecent.append(iSlice);
+    return true;
+}
+
+void SlicePrefetchCache::insert(int iSlice, const QImage &vImage)
+{
+    QMutexLocker lock(&m_Mutex);
+    store(iSlice, vImage);
+}
+
+void SlicePrefetchCache::store(int iSlice, const QImage &vImage)
+{
+    if(m_vImages.contains(iSlice)){
+        m_iBytes -= m_vImages[iSlice].byteCount();
+        m_vRecent.removeAll(iSlice);
+    }
+    m_vImages[iSlice] = vImage;
+    m_vRecent.append(iSlice);
+    m_iBytes += vImage.byteCount();
+
+    // Over budget, drop the least recently used, but always keep the shown slice and the one below it
+    int i = 0;
+    while(m_iBytes > m_iBudget && i < m_vRecent.count()){
+        int iOld = m_vRecent[i];
+        if(iOld == m_iCenter || iOld == m_iCenter-1){
+            i++;
+            continue;
+        }
+        m_vRecent.removeAt(i);
+        m_iBytes -= m_vImages[iOld].byteCount();
+        m_vImages.remove(iOld);
+    }
+}
+
+void SlicePrefetchCache::show(int iSlice)
+{
+    QMutexLocker lock(&m_Mutex);
+    // Guess where we go next from where we came from
+    if(m_iCenter>=0 && iSlice!=m_iCenter) m_iDirection = iSlice>m_iCenter ? 1 : -1;
+    m_iCenter = iSlice;
+}
+
+void SlicePrefetchCache::prefetchAround(int iSlice)
+{
+    if(m_pCPJ==NULL) return;
+    show(iSlice);
+
+    // Each shown slice also needs the one below it, so going down we reach one further
+    for(int i=1; i<=SLICEPREFETCH+1; i++)
+        queue(iSlice + i*m_iDirection);
+    queue(iSlice - m_iDirection);
+}
+
+void SlicePrefetchCache::queue(int iSlice)
+{
+    if(iSlice<0 || iSlice>=m_pCPJ->getTotalLayers()) return;
+    int iGeneration, iVersion;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(m_vImages.contains(iSlice)){
+            // keep it from being dropped, we'll want it soon
+            m_vRecent.removeAll(iSlice);
+            m_vRecent.append(iSlice);
+            return;
+        }
+        if(m_vPending.contains(iSlice)) return;
+        m_vPending.insert(iSlice);
+        iGeneration = m_iGeneration;
+        iVersion = m_vVersion.value(iSlice);
+    }
+    // The copy is taken here, on the thread that edits the job
+    m_Pool.start(new SlicePrefetchTask(this, iGeneration, iVersion, iSlice, m_pCPJ->copySlice(iSlice)));
+}
+
+void SlicePrefetchCache::inflate(int iGeneration, int iVersion, int iSlice, CrushedBitMap CBM)
+{
+    int xOffset, yOffset;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(iGeneration!=m_iGeneration || iVersion!=m_vVersion.value(iSlice)) return;
+        // Scrolled past it already?
+        if(qAbs(iSlice - m_iCenter) > SLICEPREFETCH+1){
+            m_vPending.remove(iSlice);
+            return;
+        }
+        xOffset = m_xOffset;
+        yOffset = m_yOffset;
+    }
+
+    QImage vImage;
+    CrushedPrintJob::inflateCopy(CBM, &vImage, xOffset, yOffset, true);
+
+    QMutexLocker lock(&m_Mutex);
+    if(iGeneration!=m_iGeneration || iVersion!=m_vVersion.value(iSlice)) return;
+    m_vPending.remove(iSlice);
+    store(iSlice, vImage);
+}
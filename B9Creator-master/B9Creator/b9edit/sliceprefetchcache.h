@@ -0,0 +1,97 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEPREFETCHCACHE_H
+#define SLICEPREFETCHCACHE_H
+
+#include <QObject>
+#include <QImage>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QMutex>
+#include <QThreadPool>
+#include "crushbitmap.h"
+
+#define SLICECACHEMB 256    // inflated slices we hold around the current one
+#define SLICEPREFETCH 4     // slices inflated ahead in the direction we are moving
+
+/******************************************************
+SlicePrefetchCache holds the inflated slices around the
+one shown in the Slice Manager, least recently used go
+first.  As we move through the job a background thread
+inflates the slices ahead of us, in the direction we are
+going, so a move rarely waits on decompression.  Slices
+are cached bare, supports are drawn by the caller.
+******************************************************/
+class SlicePrefetchCache : public QObject
+{
+    Q_OBJECT
+public:
+    SlicePrefetchCache(QObject *parent = 0);
+    ~SlicePrefetchCache();
+
+    void setJob(CrushedPrintJob* pCPJ, int xOffset, int yOffset); // drops everything if the job or offsets changed
+    void clear();                     // the job was replaced, nothing cached is valid
+    void invalidate(int iSlice);      // iSlice was edited
+
+    bool fetch(int iSlice, QImage* pImage);         // false if iSlice is not inflated yet
+    void insert(int iSlice, const QImage &vImage);  // inflated on the GUI thread after a miss
+    void show(int iSlice);                          // iSlice is about to be shown, it and the one below are never evicted
+    void prefetchAround(int iSlice);                // iSlice is now shown, inflate what comes next
+
+private:
+    friend class SlicePrefetchTask;
+    void inflate(int iGeneration, int iVersion, int iSlice, CrushedBitMap CBM);  // runs on the pool thread
+    void store(int iSlice, const QImage &vImage);   // caller holds m_Mutex
+    void queue(int iSlice);
+
+    QMutex m_Mutex;             // guards everything below that the worker touches
+    QThreadPool m_Pool;
+    CrushedPrintJob* m_pCPJ;
+    int m_xOffset, m_yOffset;
+    int m_iGeneration;          // bumped by clear, a stale worker drops its result
+    QHash<int, int> m_vVersion; // bumped per slice by invalidate, same idea
+    QHash<int, QImage> m_vImages;
+    QList<int> m_vRecent;       // cached slices, least recently used first
+    QSet<int> m_vPending;       // queued or being inflated
+    qint64 m_iBytes, m_iBudget;
+    int m_iCenter, m_iDirection; // m_iCenter is the shown slice
+};
+
+#endif // SLICEPREFETCHCACHE_H
@@ -0,0 +1,235 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include "sliceundobuffer.h"
+
+SliceUndoBuffer::SliceUndoBuffer()
+{
+    clear();
+}
+
+void SliceUndoBuffer::clear()
+{
+    m_vEdits.clear();
+    m_iIndex = -1;
+    m_iBytes = 0;
+    m_iSlice = -1;
+    m_baLast.clear();
+    m_iWidth = m_iHeight = 0;
+}
+
+QBitArray SliceUndoBuffer::whiteMask(const QImage &img)
+{
+    // Same rule as CrushedBitMap: "mostly black" pixels are black, anything else is white
+    QImage vImg = img;
+    if(vImg.format() != QImage::Format_ARGB32_Premultiplied && vImg.format() != QImage::Format_ARGB32 && vImg.format() != QImage::Format_RGB32)
+        vImg = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    int iWidth = vImg.width();
+    QBitArray baBits(iWidth*vImg.height());
+    for(int y=0; y<vImg.height(); y++){
+        const QRgb* pLine = (const QRgb*)vImg.constScanLine(y);
+        int iPos = y*iWidth;
+        for(int x=0; x<iWidth; x++){
+            QRgb c = pLine[x];
+            if(qRed(c)>=32 || qGreen(c)>=32 || qBlue(c)>=32) baBits.setBit(iPos+x);
+        }
+    }
+    return baBits;
+}
+
+QVector<quint32> SliceUndoBuffer::setRuns(const QBitArray &baBits)
+{
+    QVector<quint32> vRuns;
+    int iSize = baBits.size();
+    int i = 0;
+    while(i < iSize){
+        if(!baBits.testBit(i)){i++; continue;}
+        int iStart = i;
+        while(i < iSize && baBits.testBit(i)) i++;
+        vRuns.append(iStart);
+        vRuns.append(i-iStart);
+    }
+    return vRuns;
+}
+
+void SliceUndoBuffer::fillRuns(QImage *pImg, int iWidth, int iHeight, const QVector<quint32> &vRuns)
+{
+    *pImg = QImage(iWidth, iHeight, QImage::Format_ARGB32_Premultiplied);
+    pImg->fill(qRgba(0,0,0,255));
+    for(int r=0; r+1<vRuns.size(); r+=2){
+        quint32 uPos = vRuns[r], uEnd = vRuns[r] + vRuns[r+1];
+        while(uPos < uEnd){
+            int y = uPos/iWidth, x = uPos - y*iWidth;
+            int iSpan = qMin((quint32)(iWidth-x), uEnd-uPos);
+            QRgb* pLine = (QRgb*)pImg->scanLine(y) + x;
+            for(int i=0; i<iSpan; i++) pLine[i] = qRgb(255,255,255);
+            uPos += iSpan;
+        }
+    }
+}
+
+void SliceUndoBuffer::flipRuns(QImage *pImg, const QVector<quint32> &vRuns)
+{
+    // Each flipped pixel takes the opposite of its last saved color
+    if(pImg->format() != QImage::Format_ARGB32_Premultiplied)
+        *pImg = pImg->convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    for(int r=0; r+1<vRuns.size(); r+=2){
+        quint32 uPos = vRuns[r], uEnd = vRuns[r] + vRuns[r+1];
+        while(uPos < uEnd){
+            int y = uPos/m_iWidth, x = uPos - y*m_iWidth;
+            int iSpan = qMin((quint32)(m_iWidth-x), uEnd-uPos);
+            QRgb* pLine = (QRgb*)pImg->scanLine(y) + x;
+            for(int i=0; i<iSpan; i++){
+                bool bWhite = !m_baLast.testBit(uPos+i);
+                m_baLast.setBit(uPos+i, bWhite);
+                pLine[i] = bWhite ? qRgb(255,255,255) : qRgb(0,0,0);
+            }
+            uPos += iSpan;
+        }
+    }
+}
+
+bool SliceUndoBuffer::isBaseline(int iSlice, const QImage *pImg)
+{
+    return iSlice == m_iSlice && !m_baLast.isEmpty() && pImg->width() == m_iWidth && pImg->height() == m_iHeight;
+}
+
+void SliceUndoBuffer::setBaseline(int iSlice, const QImage &img)
+{
+    m_iSlice = iSlice;
+    m_baLast = whiteMask(img);
+    m_iWidth = img.width();
+    m_iHeight = img.height();
+}
+
+int SliceUndoBuffer::sliceEdits(int iSlice)
+{
+    int iCount = 0;
+    for(int i=0; i<m_vEdits.count(); i++)
+        if(m_vEdits[i].iSlice == iSlice) iCount++;
+    return iCount;
+}
+
+void SliceUndoBuffer::dropSlice(int iSlice)
+{
+    for(int i=m_vEdits.count()-1; i>=0; i--){
+        if(m_vEdits[i].iSlice != iSlice) continue;
+        m_iBytes -= m_vEdits[i].bytes();
+        m_vEdits.removeAt(i);
+        if(i <= m_iIndex) m_iIndex--; // it was applied, the ones after it move down
+    }
+    if(m_iSlice == iSlice){
+        m_iSlice = -1;
+        m_baLast.clear();
+    }
+}
+
+bool SliceUndoBuffer::save(int iSlice, const QImage &img)
+{
+    if(iSlice != m_iSlice || m_baLast.isEmpty()){
+        // First look at this slice, nothing to diff against
+        setBaseline(iSlice, img);
+        return false;
+    }
+    QBitArray baNew = whiteMask(img);
+
+    SliceEdit vEdit;
+    vEdit.iSlice = iSlice;
+    vEdit.iWidth = img.width();
+    vEdit.iHeight = img.height();
+    vEdit.iBeforeWidth = m_iWidth;
+    vEdit.iBeforeHeight = m_iHeight;
+    vEdit.bResized = vEdit.iWidth != m_iWidth || vEdit.iHeight != m_iHeight;
+    if(vEdit.bResized){
+        vEdit.vBefore = setRuns(m_baLast);
+        vEdit.vRuns = setRuns(baNew);
+    }
+    else {
+        vEdit.vRuns = setRuns(m_baLast ^ baNew);
+        if(vEdit.vRuns.isEmpty()) return false; // nothing changed
+    }
+    m_baLast = baNew;
+    m_iWidth = vEdit.iWidth;
+    m_iHeight = vEdit.iHeight;
+
+    // A new edit drops what we could have redone
+    while(m_vEdits.count()-1 > m_iIndex){
+        m_iBytes -= m_vEdits.last().bytes();
+        m_vEdits.removeLast();
+    }
+    m_vEdits.append(vEdit);
+    m_iBytes += vEdit.bytes();
+    while(m_iBytes > UNDOBUFFERBYTES && m_vEdits.count() > 1){
+        m_iBytes -= m_vEdits.first().bytes();
+        m_vEdits.removeFirst();
+    }
+    m_iIndex = m_vEdits.count()-1;
+    return true;
+}
+
+bool SliceUndoBuffer::undo(QImage *pImg)
+{
+    if(!canUndo()) return false;
+    const SliceEdit &vEdit = m_vEdits[m_iIndex];
+    if(!isBaseline(vEdit.iSlice, pImg) || m_iWidth != vEdit.iWidth || m_iHeight != vEdit.iHeight) return false;
+    if(vEdit.bResized){
+        fillRuns(pImg, vEdit.iBeforeWidth, vEdit.iBeforeHeight, vEdit.vBefore);
+        m_baLast = whiteMask(*pImg);
+        m_iWidth = vEdit.iBeforeWidth;
+        m_iHeight = vEdit.iBeforeHeight;
+    }
+    else flipRuns(pImg, vEdit.vRuns);
+    m_iIndex--;
+    return true;
+}
+
+bool SliceUndoBuffer::redo(QImage *pImg)
+{
+    if(!canRedo()) return false;
+    const SliceEdit &vEdit = m_vEdits[m_iIndex+1];
+    if(!isBaseline(vEdit.iSlice, pImg) || m_iWidth != vEdit.iBeforeWidth || m_iHeight != vEdit.iBeforeHeight) return false;
+    if(vEdit.bResized){
+        fillRuns(pImg, vEdit.iWidth, vEdit.iHeight, vEdit.vRuns);
+        m_baLast = whiteMask(*pImg);
+        m_iWidth = vEdit.iWidth;
+        m_iHeight = vEdit.iHeight;
+    }
+    else flipRuns(pImg, vEdit.vRuns);
+    m_iIndex++;
+    return true;
+}
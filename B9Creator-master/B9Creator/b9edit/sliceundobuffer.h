@@ -0,0 +1,100 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SLICEUNDOBUFFER_H
+#define SLICEUNDOBUFFER_H
+#include <QImage>
+#include <QBitArray>
+#include <QVector>
+#include <QList>
+
+#define UNDOBUFFERBYTES 4194304 // run data we keep for the whole job, oldest edits are dropped past this
+
+/******************************************************
+SliceUndoBuffer keeps the edit history of every slice of
+a job.  Slices are black and white once crushed, so an
+edit is stored as the runs of pixels it flipped against
+the slice's previous state, not as a copy of the image.
+Undo and redo flip the same runs back.  An edit that
+changed the slice size (a paste) keeps both states as
+white runs instead.
+******************************************************/
+class SliceUndoBuffer
+{
+public:
+    SliceUndoBuffer();
+
+    void clear();
+    bool save(int iSlice, const QImage &img); // records img as the slice's new state, false if it is only the baseline for the next save
+    void setBaseline(int iSlice, const QImage &img); // img is the slice's state, the next save is diffed against it, nothing is recorded
+    int sliceEdits(int iSlice);               // edits kept for iSlice, undone or not
+    void dropSlice(int iSlice);               // forgets iSlice's edits, every other slice keeps its history
+    bool canUndo(){return m_iIndex >= 0;}
+    bool canRedo(){return m_iIndex < m_vEdits.count()-1;}
+    int undoSlice(){return canUndo() ? m_vEdits[m_iIndex].iSlice : -1;}   // slice the next undo changes
+    int redoSlice(){return canRedo() ? m_vEdits[m_iIndex+1].iSlice : -1;}
+    bool undo(QImage *pImg); // pImg must hold undoSlice() as last saved
+    bool redo(QImage *pImg); // pImg must hold redoSlice() as last saved
+    int getBytes(){return m_iBytes;}
+
+private:
+    struct SliceEdit {
+        int iSlice;
+        bool bResized;                  // vBefore and vRuns are the white runs of each state, not a delta
+        int iWidth, iHeight;            // size after the edit
+        int iBeforeWidth, iBeforeHeight;
+        QVector<quint32> vRuns;         // start, length pairs of flipped (or white) pixels
+        QVector<quint32> vBefore;
+        int bytes() const {return (vRuns.size() + vBefore.size())*sizeof(quint32);}
+    };
+
+    static QBitArray whiteMask(const QImage &img);
+    static QVector<quint32> setRuns(const QBitArray &baBits);
+    static void fillRuns(QImage *pImg, int iWidth, int iHeight, const QVector<quint32> &vRuns);
+    bool isBaseline(int iSlice, const QImage *pImg);
+    void flipRuns(QImage *pImg, const QVector<quint32> &vRuns);
+
+    QList<SliceEdit> m_vEdits;
+    int m_iIndex;       // edits up to here are applied, -1 if none
+    int m_iBytes;
+    int m_iSlice;       // slice m_baLast belongs to
+    QBitArray m_baLast; // white pixels of that slice as last saved
+    int m_iWidth, m_iHeight;
+};
+
+#endif // SLICEUNDOBUFFER_H
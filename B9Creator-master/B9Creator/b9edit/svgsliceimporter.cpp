@@ -0,0 +1,192 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QFile>
+#include <QXmlStreamReader>
+#include <QColor>
+#include <QStringList>
+#include <QtDebug>
+#include "svgsliceimporter.h"
+#include "polygonfill.h"
+
+SvgSliceImporter::SvgSliceImporter(QObject *parent) :
+    SliceImporter(parent)
+{
+    m_bFoundFill = false;
+    m_dPixelMM = 0.1;
+    m_iWidth = m_iHeight = 0;
+}
+
+SvgSliceImporter::~SvgSliceImporter()
+{
+    stopWorkers();
+}
+
+bool SvgSliceImporter::isWhite(QString sFill)
+{
+    QColor vColor(sFill.trimmed());
+    return vColor.isValid() && vColor.lightness() > 127;
+}
+
+bool SvgSliceImporter::parse(QString sFile)
+{
+    m_vLayers.clear();
+    m_vBounds = QRectF();
+    m_bFoundFill = false;
+    m_sError.clear();
+
+    QFile vFile(sFile);
+    if(!vFile.open(QIODevice::ReadOnly)){
+        m_sError = "Unable to import SVG file.";
+        return false;
+    }
+
+    // Slic3r paints contours in white and holes in black, or the other way round.
+    // The first contour's fill tells us which, as the old token search did.
+    bool bContourWhite = true;
+    QVector<QPolygonF> vPolygons;
+    QVector<bool> vWhite;
+    QVector<bool> vHasLayer;
+    QVector<SvgLayer> vLayers;
+    int iLayer = -1;
+    double xMax = 0.0, yMax = 0.0;
+
+    QXmlStreamReader vXml(&vFile);
+    while(!vXml.atEnd()){
+        vXml.readNext();
+        if(vXml.isStartElement()){
+            QString sName = vXml.name().toString();
+            if(sName == "g"){
+                QString sId = vXml.attributes().value("id").toString();
+                bool bOk = false;
+                if(sId.startsWith("layer")) iLayer = sId.mid(5).toInt(&bOk);
+                if(!bOk || iLayer<0) iLayer = -1;
+                vPolygons.clear();
+                vWhite.clear();
+            }
+            else if(sName == "polygon" && iLayer>=0){
+                QXmlStreamAttributes vAttr = vXml.attributes();
+
+                // fill from the style, "fill: white", or a fill attribute
+                QString sFill = vAttr.value("fill").toString();
+                QStringList vStyle = vAttr.value("style").toString().split(';');
+                for(int i=0; i<vStyle.count(); i++){
+                    if(vStyle[i].trimmed().startsWith("fill:")) sFill = vStyle[i].section(':', 1);
+                }
+                bool bWhite = isWhite(sFill);
+                if(!m_bFoundFill && vAttr.value("slic3r:type") == "contour" && !sFill.trimmed().isEmpty()){
+                    m_bFoundFill = true;
+                    bContourWhite = bWhite;
+                }
+
+                QPolygonF vPolygon;
+                QStringList vPoints = vAttr.value("points").toString().simplified().split(' ', QString::SkipEmptyParts);
+                for(int i=0; i<vPoints.count(); i++){
+                    QStringList vXY = vPoints[i].split(',');
+                    if(vXY.count() != 2) continue;
+                    QPointF vPoint(vXY[0].toDouble(), vXY[1].toDouble());
+                    if(vPoint.x() > xMax) xMax = vPoint.x();
+                    if(vPoint.y() > yMax) yMax = vPoint.y();
+                    vPolygon.append(vPoint);
+                }
+                if(vPolygon.count() >= 3){
+                    vPolygons.append(vPolygon);
+                    vWhite.append(bWhite);
+                }
+            }
+        }
+        else if(vXml.isEndElement() && vXml.name() == "g" && iLayer>=0){
+            if(iLayer >= vLayers.count()){
+                vLayers.resize(iLayer+1);
+                vHasLayer.resize(iLayer+1);
+            }
+            vLayers[iLayer].vPolygons = vPolygons;
+            vLayers[iLayer].vLit = vWhite;  // sorted out below, once we know the colors
+            vHasLayer[iLayer] = true;
+            iLayer = -1;
+        }
+    }
+    if(vXml.hasError()){
+        qDebug() << "SVG import:" << vXml.errorString() << "at line" << vXml.lineNumber();
+        m_sError = "Unable to import SVG file.";
+        return false;
+    }
+
+    // Layers are numbered from 0, we stop at the first one missing
+    int iLayers = 0;
+    while(iLayers < vHasLayer.count() && vHasLayer[iLayers]) iLayers++;
+    if(iLayers == 0){
+        m_sError = "SVG file does not contain compatible layer information\nUnable to import.";
+        return false;
+    }
+    vLayers.resize(iLayers);
+
+    // A polygon lights its pixels when it is painted in the contour color
+    for(int l=0; l<vLayers.count(); l++)
+        for(int p=0; p<vLayers[l].vLit.count(); p++)
+            vLayers[l].vLit[p] = (vLayers[l].vLit[p] == bContourWhite);
+
+    m_vLayers = vLayers;
+    m_vBounds = QRectF(0, 0, xMax, yMax);
+    qDebug() << "SVG import:" << iLayers << "layers," << xMax << "x" << yMax << "mm";
+    return true;
+}
+
+void SvgSliceImporter::setPixelSize(double dPixelMM)
+{
+    m_dPixelMM = dPixelMM;
+    m_iWidth = (int)(m_vBounds.right()/dPixelMM);
+    m_iHeight = (int)(m_vBounds.bottom()/dPixelMM);
+}
+
+bool SvgSliceImporter::loadSlice(int iIndex, QImage* pImage)
+{
+    if(iIndex<0 || iIndex>=m_vLayers.count() || m_iWidth<1 || m_iHeight<1) return false;
+    const SvgLayer &vLayer = m_vLayers[iIndex];
+
+    *pImage = QImage(m_iWidth, m_iHeight, QImage::Format_ARGB32);
+    pImage->fill(qRgb(0,0,0));
+    for(int p=0; p<vLayer.vPolygons.count(); p++){
+        // file units to pixels, with y flipped: the file has y up, our slices have it down
+        QPolygonF vPixels = vLayer.vPolygons[p];
+        for(int i=0; i<vPixels.count(); i++)
+            vPixels[i] = QPointF(vPixels[i].x()/m_dPixelMM, m_iHeight - vPixels[i].y()/m_dPixelMM);
+        fillPolygon(pImage, vPixels, vLayer.vLit[p] ? qRgb(255,255,255) : qRgb(0,0,0));
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef SVGSLICEIMPORTER_H
+#define SVGSLICEIMPORTER_H
+
+#include <QPolygonF>
+#include <QRectF>
+#include "sliceimporter.h"
+
+/******************************************************
+SvgSliceImporter imports the layered SVG files Slic3r
+writes: one <g id="layerN"> per layer holding contour and
+hole polygons.  parse() reads the file once, start to
+end, and keeps each layer's polygons.  The layers are
+then rasterized by a scanline polygon fill and crushed
+on the SliceImporter thread pool.
+******************************************************/
+class SvgSliceImporter : public SliceImporter
+{
+    Q_OBJECT
+public:
+    SvgSliceImporter(QObject *parent = 0);
+    ~SvgSliceImporter();
+
+    bool parse(QString sFile);      // false if the file can't be read or has no layer0
+    QString errorString(){return m_sError;}
+    int layerCount(){return m_vLayers.count();}
+    QRectF bounds(){return m_vBounds;}  // of all layers, in file units (mm)
+    bool hasFillColors(){return m_bFoundFill;}  // false if we could not tell which way round the colors are
+    void setPixelSize(double dPixelMM); // sets the slice size from bounds()
+
+protected:
+    bool loadSlice(int iIndex, QImage* pImage);
+
+private:
+    struct SvgLayer {
+        QVector<QPolygonF> vPolygons;   // in paint order
+        QVector<bool> vLit;             // each polygon lights its pixels, or clears them
+    };
+    static bool isWhite(QString sFill);
+
+    QVector<SvgLayer> m_vLayers;
+    QRectF m_vBounds;
+    bool m_bFoundFill;
+    QString m_sError;
+    double m_dPixelMM;
+    int m_iWidth, m_iHeight;
+};
+
+#endif // SVGSLICEIMPORTER_H
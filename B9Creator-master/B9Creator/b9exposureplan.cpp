@@ -0,0 +1,238 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QSettings>
+#include <QtDebug>
+#include <QtCore/qmath.h>
+#include "b9exposureplan.h"
+
+void B9ExposurePlan::clear()
+{
+    m_vLayers.clear();
+    m_vRemainingMS.fill(0, 1);
+    m_sJobName.clear();
+    m_dLayerThicknessMM = 0.0;
+    m_iFinalCycleMS = 0;
+}
+
+int B9ExposurePlan::toverStepMS()
+{
+    QSettings settings;
+    int iStepMS = settings.value("ToverStepMS",17).toInt();
+    if(iStepMS>500) iStepMS = 500;
+    else if(iStepMS<8) iStepMS = 8;
+    return iStepMS;
+}
+
+void B9ExposurePlan::build(B9Printer* pPrinter, CrushedPrintJob* pCPJ, int iTbase, int iTover, int iTattach, int iNumAttach, int iLastLayer, int iToverStepMS)
+{
+    clear();
+    if(iLastLayer<1 || iLastLayer>pCPJ->getTotalLayers()) iLastLayer = pCPJ->getTotalLayers();
+    m_sJobName = pCPJ->getName();
+    m_dLayerThicknessMM = pCPJ->getZLayer().toDouble();
+    if(iToverStepMS<1) iToverStepMS = 1;
+
+    // The lamp ages too little during a print to matter, adjust once
+    int iAdjTbase = qMax(0, pPrinter->getLampAdjustedExposureTime(iTbase));
+    int iAdjTattach = qMax(0, pPrinter->getLampAdjustedExposureTime(iTattach));
+    int iAdjTover = qMax(0, pPrinter->getLampAdjustedExposureTime(iTover));
+    int iToverSteps = qMin(255, iAdjTover/iToverStepMS); // maximum number of time intervals we chop Tover into is 256
+    double dPUmm = (double)pPrinter->getComm()->getPU()/100000.0;
+    double dXYmm = pCPJ->getXYPixelmm();
+
+    m_vLayers.resize(iLastLayer);
+    int iPrevPU = 0;
+    for(int i=0; i<iLastLayer; i++){
+        B9LayerExposure &vL = m_vLayers[i];
+        vL.iTbaseMS = i<iNumAttach ? iAdjTattach : iAdjTbase;
+        if(i>0 && iToverSteps>0){ // Skip Tover on first layer (0)
+            vL.iToverMS = iAdjTover;
+            vL.iToverSteps = iToverSteps;
+        }
+        vL.iTgtPU = (int)(((double)i*m_dLayerThicknessMM + 0.00001)/dPUmm); // as rcNextPrint rounds it
+        if(i>0){
+            // The release pulls the layer before off the vat, the cycle is planned from its size.  Pixel sides
+            // overstate a curved or slanted outline, by 4/pi on average, so they are scaled back
+            double dPerimeterMM = pCPJ->getEdgePixels(i-1)*dXYmm*M_PI/4.0;
+            vL.vCycle = pPrinter->planCycleParams(vL.iTgtPU, pCPJ->getWhitePixels(i-1)*dXYmm*dXYmm, dPerimeterMM, &vL.iCycleSet);
+            vL.iCycleMS = pPrinter->getEstNextCycleTime(iPrevPU, vL.iTgtPU, vL.vCycle);
+        }
+        iPrevPU = vL.iTgtPU;
+    }
+    int iFinalPU = iPrevPU + (int)(25.4/dPUmm); // rcFinishPrint(25.4)
+    int iUpperPU = pPrinter->getComm()->getUpperZLimPU();
+    if(iUpperPU>0 && iFinalPU>iUpperPU) iFinalPU = iUpperPU; // not known until the printer has reported it
+    m_iFinalCycleMS = pPrinter->getEstFinalCycleTime(iPrevPU, iFinalPU);
+    sumRemaining();
+}
+
+void B9ExposurePlan::sumRemaining()
+{
+    m_vRemainingMS.resize(m_vLayers.count()+1);
+    m_vRemainingMS[m_vLayers.count()] = m_iFinalCycleMS;
+    for(int i=m_vLayers.count()-1; i>=0; i--){
+        const B9LayerExposure &vL = m_vLayers.at(i);
+        m_vRemainingMS[i] = m_vRemainingMS[i+1] + vL.iCycleMS + vL.iTbaseMS + vL.iToverMS;
+    }
+}
+
+bool B9ExposurePlan::matches(CrushedPrintJob* pCPJ, int iLastLayer)
+{
+    return m_sJobName==pCPJ->getName() && iLastLayer<=m_vLayers.count() && qAbs(m_dLayerThicknessMM-pCPJ->getZLayer().toDouble())<0.000001;
+}
+
+QList<double> B9ExposurePlan::deadlines(int iLayer)
+{
+    const B9LayerExposure &vL = m_vLayers.at(iLayer);
+    QList<double> vDeadlines;
+    vDeadlines.append(vL.iTbaseMS);
+    double dTintMS = 0.0;
+    if(vL.iToverSteps>0) dTintMS = (double)vL.iToverMS/(double)vL.iToverSteps; // The time of each interval in fractional ms
+    for(int i=1; i<=vL.iToverSteps; i++)
+        vDeadlines.append((double)vL.iTbaseMS + dTintMS*(double)i);
+    return vDeadlines;
+}
+
+qint64 B9ExposurePlan::remainingMS(int iLayer)
+{
+    if(iLayer<0) iLayer = 0;
+    if(iLayer>m_vLayers.count()) iLayer = m_vLayers.count();
+    return m_vRemainingMS.at(iLayer);
+}
+
+bool B9ExposurePlan::exportPlan(QString sFileName)
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        qDebug() << "Exposure Plan:  Unable to write" << sFileName;
+        return false;
+    }
+    QTextStream ts(&file);
+    ts << "# B9Creator exposure plan\n";
+    ts << "# job=" << m_sJobName << "\n";
+    ts << "# layer_thickness_mm=" << QString::number(m_dLayerThicknessMM,'g',10) << "\n";
+    ts << "# final_cycle_ms=" << m_iFinalCycleMS << "\n";
+    ts << "layer,tbase_ms,tover_ms,tover_steps,tgt_pu,cycle_set,breathe_s,settle_s,overlift_mm,raise_pct,lower_pct,open_pct,close_pct,cycle_ms,remaining_ms\n";
+    for(int i=0; i<m_vLayers.count(); i++){
+        const B9LayerExposure &vL = m_vLayers.at(i);
+        ts << i << "," << vL.iTbaseMS << "," << vL.iToverMS << "," << vL.iToverSteps << "," << vL.iTgtPU << "," << vL.iCycleSet << ","
+           << vL.vCycle.dBreatheClosed << "," << vL.vCycle.dSettleOpen << "," << vL.vCycle.dOverLift << ","
+           << vL.vCycle.iRSpd << "," << vL.vCycle.iLSpd << "," << vL.vCycle.iOpenSpd << "," << vL.vCycle.iCloseSpd << ","
+           << vL.iCycleMS << "," << m_vRemainingMS.at(i) << "\n";
+    }
+    return true;
+}
+
+bool B9ExposurePlan::importPlan(QString sFileName, QString* pError, int iUpperZLimPU)
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)){
+        if(pError!=NULL) *pError = "Unable to open "+sFileName;
+        return false;
+    }
+    B9ExposurePlan vPlan;
+    QTextStream ts(&file);
+    int iLine = 0;
+    while(!ts.atEnd()){
+        QString sLine = ts.readLine().trimmed();
+        iLine++;
+        if(sLine.isEmpty() || sLine.startsWith("layer,")) continue;
+        if(sLine.startsWith("#")){
+            sLine = sLine.mid(1).trimmed();
+            if(sLine.startsWith("job=")) vPlan.m_sJobName = sLine.mid(4);
+            else if(sLine.startsWith("layer_thickness_mm=")) vPlan.m_dLayerThicknessMM = sLine.mid(19).toDouble();
+            else if(sLine.startsWith("final_cycle_ms=")) vPlan.m_iFinalCycleMS = sLine.mid(15).toInt();
+            continue;
+        }
+        // remaining_ms is recomputed, so it may be left off an edited plan
+        QStringList vFields = sLine.split(',');
+        bool bOk = vFields.count()>=14;
+        QList<double> vValues;
+        for(int i=0; bOk && i<14; i++) vValues.append(vFields[i].trimmed().toDouble(&bOk));
+        if(!bOk || (int)vValues[0]!=vPlan.m_vLayers.count() || vValues[1]<0 || vValues[2]<0 || vValues[3]<0 || vValues[3]>255 || vValues[4]<0){
+            if(pError!=NULL) *pError = "Bad row at line "+QString::number(iLine)+": "+sLine;
+            return false;
+        }
+        // The cycle set, delays, overlift and speeds go to the firmware as they are
+        bool bCycleOk = vValues[5]>=0 && vValues[5]<=3 && vValues[6]>=0 && vValues[7]>=0 && vValues[8]>=0 && vValues[13]>=0;
+        for(int i=9; i<=12; i++) if(vValues[i]<0 || vValues[i]>100) bCycleOk = false;
+        if(!bCycleOk){
+            if(pError!=NULL) *pError = "Cycle out of range (speeds are 0 to 100%) at line "+QString::number(iLine)+": "+sLine;
+            return false;
+        }
+        B9LayerExposure vL;
+        vL.iTbaseMS = vValues[1];
+        vL.iToverMS = vValues[2];
+        vL.iToverSteps = vValues[3];
+        vL.iTgtPU = vValues[4];
+        vL.iCycleSet = vValues[5];
+        vL.vCycle.dBreatheClosed = vValues[6];
+        vL.vCycle.dSettleOpen = vValues[7];
+        vL.vCycle.dOverLift = vValues[8];
+        vL.vCycle.iRSpd = vValues[9];
+        vL.vCycle.iLSpd = vValues[10];
+        vL.vCycle.iOpenSpd = vValues[11];
+        vL.vCycle.iCloseSpd = vValues[12];
+        vL.iCycleMS = vValues[13];
+        vPlan.m_vLayers.append(vL);
+    }
+    if(vPlan.m_vLayers.isEmpty() || vPlan.m_dLayerThicknessMM<=0.0){
+        if(pError!=NULL) *pError = "No layers or layer thickness in "+sFileName;
+        return false;
+    }
+    if(!vPlan.fitsZLimit(iUpperZLimPU, pError)) return false;
+    vPlan.sumRemaining();
+    *this = vPlan;
+    return true;
+}
+
+bool B9ExposurePlan::fitsZLimit(int iUpperZLimPU, QString* pError)
+{
+    if(iUpperZLimPU<=0) return true; // not known until the printer has reported it
+    for(int i=0; i<m_vLayers.count(); i++){
+        if(m_vLayers[i].iTgtPU > iUpperZLimPU){
+            if(pError!=NULL) *pError = "Layer "+QString::number(i)+" target "+QString::number(m_vLayers[i].iTgtPU)+
+                    " PU is past the printer's upper Z limit of "+QString::number(iUpperZLimPU)+" PU";
+            return false;
+        }
+    }
+    return true;
+}
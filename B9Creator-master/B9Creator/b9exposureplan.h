@@ -0,0 +1,100 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9EXPOSUREPLAN_H
+#define B9EXPOSUREPLAN_H
+
+#include <QVector>
+#include <QList>
+#include <QString>
+#include "b9printer.h"
+
+// How one layer is positioned and exposed
+struct B9LayerExposure {
+    B9LayerExposure(){iTbaseMS=iToverMS=iToverSteps=iTgtPU=iCycleSet=iCycleMS=0;}
+    int iTbaseMS;           // lamp adjusted, Tattach on the attach layers
+    int iToverMS;           // lamp adjusted, 0 when there are no Tover steps
+    int iToverSteps;        // Tover is cleared in this many steps, at most 255
+    int iTgtPU;             // where the release cycle before this layer puts the build table
+    int iCycleSet;          // cycle settings 1 or 2, 3 if the cycle planner picked the parameters, 0 on layer 0
+    B9CycleParams vCycle;   // the release cycle before this layer
+    int iCycleMS;           // predicted time of that cycle, layer 0 follows the Z zeroing moves instead
+};
+
+/******************************************************
+B9ExposurePlan is everything the print loop needs per
+layer, worked out in one pass before the print starts:
+exposure times with the attach layers and lamp age
+applied, Tover steps, release cycle parameters and the
+predicted cycle time.  The controller just indexes it,
+and a plan can be exported, edited and imported again.
+******************************************************/
+class B9ExposurePlan
+{
+public:
+    B9ExposurePlan(){clear();}
+
+    void clear();
+    void build(B9Printer* pPrinter, CrushedPrintJob* pCPJ, int iTbase, int iTover, int iTattach, int iNumAttach, int iLastLayer, int iToverStepMS);
+    bool matches(CrushedPrintJob* pCPJ, int iLastLayer); // made for pCPJ, with the layers and thickness to print iLastLayer layers of it
+
+    int layerCount(){return m_vLayers.count();}
+    const B9LayerExposure& layer(int iLayer){return m_vLayers.at(iLayer);}
+    QList<double> deadlines(int iLayer); // end of Tbase then each Tover step, ms from the start of the exposure
+    qint64 remainingMS(int iLayer);      // from iLayer's release cycle to the end of the final cycle
+    qint64 totalMS(){return remainingMS(0);}
+    QString getJobName(){return m_sJobName;}
+
+    bool exportPlan(QString sFileName);
+    // rejects rows out of range, and target positions past iUpperZLimPU if it is known (> 0)
+    bool importPlan(QString sFileName, QString* pError = NULL, int iUpperZLimPU = 0);
+    bool fitsZLimit(int iUpperZLimPU, QString* pError = NULL); // no layer's target is past the printer's upper Z limit
+
+    static int toverStepMS(); // from the settings, about the display refresh period
+
+private:
+    void sumRemaining();
+
+    QVector<B9LayerExposure> m_vLayers;
+    QVector<qint64> m_vRemainingMS;  // one more entry than layers, the last is the final cycle
+    QString m_sJobName;
+    double m_dLayerThicknessMM;
+    int m_iFinalCycleMS;
+};
+
+#endif // B9EXPOSUREPLAN_H
@@ -0,0 +1,127 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QSettings>
+#include "b9exposurescheduler.h"
+
+B9ExposureScheduler::B9ExposureScheduler(QObject *parent) :
+    QThread(parent)
+{
+    m_iSchedule = 0;
+    m_iNext = 0;
+    m_iLastFired = -1;
+    m_bQuit = false;
+    m_Clock.start();
+    m_dStartMS = 0.0;
+
+    // Spinning on one core holds off every other thread until the deadline, so there we only sleep
+    QSettings settings;
+    m_dSpinMS = settings.value("SchedulerSpinMS", QThread::idealThreadCount()>1 ? SCHEDULERSPINMS : 0.0).toDouble();
+    if(m_dSpinMS < 0.0) m_dSpinMS = 0.0;
+    if(m_dSpinMS > SCHEDULERMAXSPINMS) m_dSpinMS = SCHEDULERMAXSPINMS;
+    start(QThread::TimeCriticalPriority);
+}
+
+B9ExposureScheduler::~B9ExposureScheduler()
+{
+    m_Mutex.lock();
+    m_bQuit = true;
+    m_Wake.wakeAll();
+    m_Mutex.unlock();
+    wait();
+}
+
+int B9ExposureScheduler::startSchedule(QList<double> vDeadlinesMS)
+{
+    QMutexLocker locker(&m_Mutex);
+    m_dStartMS = clockMS();
+    m_vDeadlines = vDeadlinesMS;
+    m_iNext = 0;
+    m_iLastFired = -1;
+    m_iSchedule++;
+    m_Wake.wakeAll();
+    return m_iSchedule;
+}
+
+void B9ExposureScheduler::cancel()
+{
+    QMutexLocker locker(&m_Mutex);
+    m_vDeadlines.clear();
+    m_iNext = 0;
+    m_iSchedule++;
+    m_Wake.wakeAll();
+}
+
+double B9ExposureScheduler::elapsedMS()
+{
+    QMutexLocker locker(&m_Mutex);
+    return clockMS() - m_dStartMS;
+}
+
+void B9ExposureScheduler::run()
+{
+    QMutexLocker locker(&m_Mutex);
+    while(!m_bQuit){
+        if(m_iNext >= m_vDeadlines.size()){
+            m_Wake.wait(&m_Mutex); // nothing scheduled, sleep until we are given something to do
+            continue;
+        }
+        int iSchedule = m_iSchedule;
+        double dStartMS = m_dStartMS; // our own copy, the spin below reads it without the lock
+        double dDue = m_vDeadlines[m_iNext];
+        double dWait = dStartMS + dDue - clockMS() - m_dSpinMS;
+        if(m_dSpinMS > 0.0 && dWait >= 1.0){
+            m_Wake.wait(&m_Mutex, (unsigned long)dWait); // wakes early if cancelled or rescheduled
+            continue;
+        }
+        if(m_dSpinMS <= 0.0 && dWait > 0.0){
+            m_Wake.wait(&m_Mutex, (unsigned long)dWait + 1); // not spinning, so round up rather than wake just short
+            continue;
+        }
+
+        // Close enough, spin the rest of the way so we hit the deadline as exactly as the clock allows
+        locker.unlock();
+        while(clockMS() - dStartMS < dDue) {}
+        locker.relock();
+        if(iSchedule != m_iSchedule) continue; // cancelled or restarted while we were spinning
+
+        m_iLastFired = m_iNext;
+        emit deadlineReached(m_iSchedule, m_iNext, dDue, clockMS() - dStartMS);
+        m_iNext++;
+    }
+}
@@ -0,0 +1,99 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9EXPOSURESCHEDULER_H
+#define B9EXPOSURESCHEDULER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QList>
+
+#define SCHEDULERSPINMS 2.0    // default for how close to a deadline we sleep until before spinning on the clock
+#define SCHEDULERMAXSPINMS 5.0 // the "SchedulerSpinMS" setting is clamped to this, 0 turns spinning off
+
+/******************************************************
+B9ExposureScheduler runs at high priority on its own
+thread and signals each of a list of exposure deadlines
+(in ms from the start of the schedule) as it is reached.
+All times come from a single monotonic clock so there is
+no drift from chaining timers together.  The clock is
+never restarted, each schedule keeps its own start time.
+The final spin is bounded by the "SchedulerSpinMS"
+setting and is off by default on single core hosts,
+where it would starve the GUI thread.
+******************************************************/
+class B9ExposureScheduler : public QThread
+{
+    Q_OBJECT
+
+public:
+    B9ExposureScheduler(QObject *parent = 0);
+    ~B9ExposureScheduler();
+
+    // Starts a new schedule at the current time and begins signaling vDeadlinesMS, returns the id of the new schedule
+    int startSchedule(QList<double> vDeadlinesMS);
+    void cancel();                 // stop signaling the current schedule
+    double elapsedMS();            // ms since the current schedule was started
+    int lastFiredIndex(){return (int)m_iLastFired;} // index of the most recent deadline signaled
+
+signals:
+    // iSchedule identifies the schedule so stale queued signals can be ignored
+    void deadlineReached(int iSchedule, int iIndex, double dPlannedMS, double dActualMS);
+
+protected:
+    void run();
+
+private:
+    double clockMS(){return (double)m_Clock.nsecsElapsed()/1000000.0;} // free running, only started in the constructor
+
+    QMutex m_Mutex;
+    QWaitCondition m_Wake;
+    QElapsedTimer m_Clock;
+    double m_dStartMS;             // clockMS() when the current schedule was started
+    double m_dSpinMS;
+    QList<double> m_vDeadlines;
+    int m_iSchedule;
+    int m_iNext;
+    QAtomicInt m_iLastFired;
+    bool m_bQuit;
+};
+
+#endif // B9EXPOSURESCHEDULER_H
@@ -0,0 +1,520 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtDebug>
+#include <QMutexLocker>
+#include "b9firmwaresim.h"
+#include "b9printercomm.h"
+
+#ifdef Q_OS_UNIX
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <errno.h>
+#endif
+
+B9FirmwareSim::B9FirmwareSim(double dTimeScale, QObject *parent) :
+    QThread(parent)
+{
+    m_iMaster = -1;
+    m_dTimeScale = 1.0;
+    m_bQuit = false;
+    setTimeScale(dTimeScale);
+
+    m_dSimMS = 0;
+    m_dLastRealMS = 0;
+    m_dLastBroadcastMS = 0;
+    m_dLastZReportMS = 0;
+    m_dConnectRealMS = -1;
+    m_bHostConnected = false;
+
+    m_bStepActive = false;
+    m_dStepStartMS = 0;
+    m_dStepEndMS = 0;
+    m_dMoveFrom = 0;
+
+    m_dZPos = 0;
+    m_dVatPos = 0;
+    m_iLastZReported = -1;
+    m_bNeedsReset = true;
+    m_bProjectorOn = false;
+    m_bVerbose = false;
+    m_iLampHrs = 120;
+    m_iXYPixelSize = 100;
+    m_iBreatheMS = 2000;
+    m_iSettleMS = 3000;
+    m_iGapPU = 1000;
+    m_iRaiseSpd = m_iLowerSpd = m_iOpenSpd = m_iCloseSpd = 50;
+}
+
+B9FirmwareSim::~B9FirmwareSim()
+{
+    stop();
+#ifdef Q_OS_UNIX
+    if(m_iMaster>=0) ::close(m_iMaster);
+#endif
+}
+
+bool B9FirmwareSim::openPort()
+{
+#ifdef Q_OS_UNIX
+    if(m_iMaster>=0) return true;
+    m_iMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if(m_iMaster<0 || grantpt(m_iMaster)!=0 || unlockpt(m_iMaster)!=0 || ptsname(m_iMaster)==NULL){
+        qDebug() << "Firmware Simulator:  Unable to create a pseudo-terminal";
+        if(m_iMaster>=0) ::close(m_iMaster);
+        m_iMaster = -1;
+        return false;
+    }
+    m_sPortName = QString::fromLocal8Bit(ptsname(m_iMaster));
+    ::fcntl(m_iMaster, F_SETFL, ::fcntl(m_iMaster, F_GETFL) | O_NONBLOCK);
+    makeRaw();
+    qDebug() << "Firmware Simulator:  Listening on" << m_sPortName << "time scale" << timeScale();
+    return true;
+#else
+    qDebug() << "Firmware Simulator:  Not available on this platform";
+    return false;
+#endif
+}
+
+void B9FirmwareSim::makeRaw()
+{
+#ifdef Q_OS_UNIX
+    // termios set through the master apply to the slave, no echo and no line editing
+    // so the host sees exactly what the firmware would send
+    struct termios vTermios;
+    if(tcgetattr(m_iMaster, &vTermios)==0){
+        cfmakeraw(&vTermios);
+        tcsetattr(m_iMaster, TCSANOW, &vTermios);
+    }
+#endif
+}
+
+void B9FirmwareSim::setTimeScale(double dTimeScale)
+{
+    QMutexLocker lock(&m_Mutex);
+    if(dTimeScale<0.1) dTimeScale = 0.1;
+    m_dTimeScale = dTimeScale;
+}
+
+double B9FirmwareSim::timeScale()
+{
+    QMutexLocker lock(&m_Mutex);
+    return m_dTimeScale;
+}
+
+void B9FirmwareSim::stop()
+{
+    m_bQuit = true;
+    wait();
+}
+
+void B9FirmwareSim::run()
+{
+#ifdef Q_OS_UNIX
+    if(m_iMaster<0) return;
+    m_RealClock.start();
+    m_dLastRealMS = 0;
+    char cBuf[256];
+    while(!m_bQuit){
+        struct pollfd vPoll;
+        vPoll.fd = m_iMaster;
+        vPoll.events = POLLIN;
+        vPoll.revents = 0;
+        int iReady = poll(&vPoll, 1, SIMTICKMS);
+
+        // The master reports a hang up while no one has the slave open
+        if(iReady>0 && (vPoll.revents & (POLLHUP|POLLERR))){
+            if(m_bHostConnected) qDebug() << "Firmware Simulator:  Host closed" << m_sPortName;
+            m_bHostConnected = false;
+            m_dConnectRealMS = -1;
+            m_baRx.clear();
+            msleep(SIMTICKMS);
+        }
+        else if(!m_bHostConnected){
+            m_bHostConnected = true;
+            hostConnected();
+        }
+        else if(iReady>0 && (vPoll.revents & POLLIN)){
+            int iRead;
+            while((iRead = ::read(m_iMaster, cBuf, sizeof(cBuf))) > 0) m_baRx.append(cBuf, iRead);
+            int iEOL;
+            while((iEOL = m_baRx.indexOf('\n')) >= 0){
+                handleLine(m_baRx.left(iEOL));
+                m_baRx.remove(0, iEOL+1);
+            }
+        }
+
+        // Move the simulated clock, scaled
+        double dRealMS = m_RealClock.elapsed();
+        m_dSimMS += (dRealMS - m_dLastRealMS)*timeScale();
+        m_dLastRealMS = dRealMS;
+        advance(m_dSimMS);
+
+        if(!m_bHostConnected) continue;
+        if(m_dConnectRealMS>=0){
+            if(dRealMS - m_dConnectRealMS < SIMBOOTMS) continue;
+            // done "booting", say hello like the firmware does after a reset
+            m_dConnectRealMS = -1;
+            comment("B9Creator(tm) Firmware version "+QString(CURRENTFIRMWARE).mid(1)+" running on a B9Creator Model 1 (simulated)");
+            sendStatus();
+        }
+        if(m_bStepActive && (int)m_dZPos != m_iLastZReported && dRealMS - m_dLastZReportMS >= SIMZREPORTMS){
+            m_dLastZReportMS = dRealMS;
+            m_iLastZReported = (int)m_dZPos;
+            sendLine("Z"+QString::number(m_iLastZReported));
+        }
+        if(dRealMS - m_dLastBroadcastMS >= SIMBROADCASTMS){
+            m_dLastBroadcastMS = dRealMS;
+            sendLine("P"+QString::number(m_bProjectorOn ? 1 : 0));
+            sendLine("L"+QString::number(m_iLampHrs));
+        }
+    }
+#endif
+}
+
+void B9FirmwareSim::hostConnected()
+{
+    // Opening the port resets a real B9Creator (DTR), so we forget where we are
+    qDebug() << "Firmware Simulator:  Host opened" << m_sPortName;
+    makeRaw();
+    m_vSteps.clear();
+    m_bStepActive = false;
+    m_bNeedsReset = true;
+    m_baRx.clear();
+    m_dConnectRealMS = m_RealClock.elapsed();
+}
+
+void B9FirmwareSim::sendLine(const QString &sLine)
+{
+#ifdef Q_OS_UNIX
+    if(!m_bHostConnected || m_dConnectRealMS>=0) return;
+    QByteArray baLine = sLine.toAscii() + "\r\n";
+    const char* p = baLine.constData();
+    int iLeft = baLine.size();
+    while(iLeft>0 && !m_bQuit){
+        int iSent = ::write(m_iMaster, p, iLeft);
+        if(iSent>0){p += iSent; iLeft -= iSent;}
+        else if(iSent<0 && errno!=EAGAIN && errno!=EINTR) return;  // host went away
+        else msleep(1);  // host isn't keeping up
+    }
+#else
+    Q_UNUSED(sLine);
+#endif
+}
+
+void B9FirmwareSim::comment(const QString &sText, bool bVerboseOnly)
+{
+    if(bVerboseOnly && !m_bVerbose) return;
+    sendLine("C"+sText);
+}
+
+void B9FirmwareSim::sendStatus()
+{
+    sendLine("V"+QString(CURRENTFIRMWARE).mid(1).replace('.',' '));
+    sendLine("WB9C1");
+    sendLine("I635");
+    sendLine("A1");
+    sendLine("J1");
+    sendLine("D1024");
+    sendLine("E768");
+    sendLine("H"+QString::number(m_iXYPixelSize));
+    sendLine("K2000");
+    sendLine("M"+QString::number(SIMUPPERZLIMPU));
+    sendLine("R"+QString::number(m_bNeedsReset ? 1 : 0));
+    m_iLastZReported = (int)m_dZPos;
+    sendLine("Z"+QString::number(m_iLastZReported));
+    sendLine("S"+QString::number((int)m_dVatPos));
+    sendLine("L"+QString::number(m_iLampHrs));
+    sendLine("P"+QString::number(m_bProjectorOn ? 1 : 0));
+}
+
+void B9FirmwareSim::handleLine(const QByteArray &baLine)
+{
+    QString sLine = QString::fromAscii(baLine).trimmed();
+    if(sLine.isEmpty()) return;
+    QChar cCmd = sLine.at(0).toUpper();
+    QString sArg = sLine.mid(1).trimmed();
+    bool bOk;
+    int iValue = sArg.toInt(&bOk);
+
+    switch(cCmd.toAscii()){
+    case 'A':
+        comment("Command:  Request Current Status");
+        sendStatus();
+        break;
+
+    case 'B':  // base layer: lower to the target, open the vat and settle
+        if(!bOk) {comment("ERROR:  Invalid Command: "+sLine); break;}
+        iValue = qBound(0, iValue, SIMUPPERZLIMPU);
+        comment("Command: Cycle to initial Base Layer at: "+QString::number(iValue));
+        addStep(SimStep::COMMENT, 0, 0, 0, "Lowering Platform to next layer position.");
+        addStep(SimStep::ZMOVE, iValue, m_iLowerSpd);
+        addStep(SimStep::VATMOVE, 100, m_iOpenSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Lowered.  Pausing for settle...");
+        addStep(SimStep::DELAY, 0, 0, m_iSettleMS);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Settle Pause Finished.  Ready to Expose.");
+        addStep(SimStep::CYCLEDONE);
+        break;
+
+    case 'N':  // next layer: release, raise past the target by the gap, breathe, open, lower, settle
+        if(!bOk) {comment("ERROR:  Invalid Command: Release and cycle to Next Layer at: "+sArg); break;}
+        iValue = qBound(0, iValue, SIMUPPERZLIMPU);
+        comment("Command: Release and cycle to Next Layer at: "+QString::number(iValue));
+        addStep(SimStep::VATMOVE, 0, m_iCloseSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Released, Shutter Closed");
+        addStep(SimStep::COMMENT, 0, 0, 0, "Raising Platform to next layer position + clearance Gap.");
+        addStep(SimStep::ZMOVE, qMin(iValue + m_iGapPU, SIMUPPERZLIMPU), m_iRaiseSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Raised.  Pausing for breathe...");
+        addStep(SimStep::DELAY, 0, 0, m_iBreatheMS);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Breathe Pause Finished.  Opening Shutter.");
+        addStep(SimStep::VATMOVE, 100, m_iOpenSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Lowering Platform to next layer position.");
+        addStep(SimStep::ZMOVE, iValue, m_iLowerSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Lowered.  Pausing for settle...");
+        addStep(SimStep::DELAY, 0, 0, m_iSettleMS);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Settle Pause Finished.  Ready to Expose.");
+        addStep(SimStep::CYCLEDONE);
+        break;
+
+    case 'F':  // final: release and raise to the target
+        if(!bOk) {comment("ERROR:  Invalid Command: "+sLine); break;}
+        iValue = qBound(0, iValue, SIMUPPERZLIMPU);
+        comment("Command: Release and move to final position at: "+QString::number(iValue));
+        addStep(SimStep::VATMOVE, 0, m_iCloseSpd);
+        addStep(SimStep::COMMENT, 0, 0, 0, "Released");
+        addStep(SimStep::COMMENT, 0, 0, 0, "Raising Platform to final position.");
+        addStep(SimStep::ZMOVE, iValue, m_iRaiseSpd);
+        addStep(SimStep::CYCLEDONE);
+        break;
+
+    case 'G':
+        if(!bOk) {comment("ERROR:  Invalid Command: "+sLine); break;}
+        iValue = qBound(0, iValue, SIMUPPERZLIMPU);
+        comment("Command: Goto Z position at: "+QString::number(iValue));
+        addStep(SimStep::ZMOVE, iValue, iValue > m_dZPos ? m_iRaiseSpd : m_iLowerSpd);
+        break;
+
+    case 'V':
+        if(!bOk) {comment("ERROR:  Invalid Command: "+sLine); break;}
+        iValue = qBound(0, iValue, 100);
+        comment("Command: Moving VAT to: "+QString::number(iValue));
+        addStep(SimStep::VATMOVE, iValue, iValue > m_dVatPos ? m_iOpenSpd : m_iCloseSpd);
+        break;
+
+    case 'R':
+        comment("Command: Reset Home Positions");
+        addStep(SimStep::VATMOVE, 0, m_iCloseSpd);
+        addStep(SimStep::ZMOVE, 0, SIMHOMESPEED);
+        addStep(SimStep::HOMED);
+        break;
+
+    case 'S':
+        comment("Command: STOP");
+        m_vSteps.clear();
+        m_bStepActive = false;
+        m_iLastZReported = (int)m_dZPos;
+        sendLine("Z"+QString::number(m_iLastZReported));
+        sendLine("S"+QString::number((int)m_dVatPos));
+        break;
+
+    case 'P':
+        m_bProjectorOn = (iValue==1);
+        comment(m_bProjectorOn ? "Command: Turning Projector ON" : "Command: Turning Projector OFF");
+        sendLine("P"+QString::number(m_bProjectorOn ? 1 : 0));
+        break;
+
+    case 'T':
+        m_bVerbose = (iValue==1);
+        comment(m_bVerbose ? "Command: Verbose Text Comments Activated." : "Command: Verbose Text Comments Deactivated.");
+        break;
+
+    case 'D':
+        if(bOk) m_iBreatheMS = qMax(0, iValue);
+        comment("Command: Breathe Delay set to "+QString::number(m_iBreatheMS));
+        break;
+
+    case 'E':
+        if(bOk) m_iSettleMS = qMax(0, iValue);
+        comment("Command: Settle Delay set to "+QString::number(m_iSettleMS));
+        break;
+
+    case 'J':
+        if(bOk) m_iGapPU = qBound(0, iValue, SIMUPPERZLIMPU);
+        comment("Command: Reposition Gap set to: "+QString::number(m_iGapPU));
+        break;
+
+    case 'K':
+        if(bOk && iValue>=0 && iValue<=100) {m_iRaiseSpd = iValue; comment("Command: Percent Raise Speed Set To "+QString::number(iValue));}
+        else comment("Command: Error, Percent Raise Speed Out of Range");
+        break;
+
+    case 'L':
+        if(bOk && iValue>=0 && iValue<=100) {m_iLowerSpd = iValue; comment("Command: Percent Lower Speed Set To "+QString::number(iValue));}
+        else comment("Command: Error, Percent Lower Speed Out of Range");
+        break;
+
+    case 'W':
+        if(bOk && iValue>=0 && iValue<=100) {m_iOpenSpd = iValue; comment("Command: Percent Open Speed Set To: "+QString::number(iValue));}
+        else comment("Command: Error, Percent Open Speed Out of Range");
+        break;
+
+    case 'X':
+        if(bOk && iValue>=0 && iValue<=100) {m_iCloseSpd = iValue; comment("Command: Percent Close Speed Set To: "+QString::number(iValue));}
+        else comment("Command: Error, Percent Close Speed Out of Range");
+        break;
+
+    case 'O':
+        if(!bOk || iValue<0 || iValue>SIMUPPERZLIMPU) {comment("Error: Reset current Z position value out of limits.  Ignored."); break;}
+        comment("Command: Resetting current Z position to: "+QString::number(iValue));
+        m_dZPos = iValue;
+        m_iLastZReported = iValue;
+        sendLine("Z"+QString::number(iValue));
+        break;
+
+    case 'U':
+        if(bOk && iValue>0) m_iXYPixelSize = iValue;
+        comment("Command: Calibrated XY Pixel Size Set To "+QString::number(m_iXYPixelSize));
+        break;
+
+    default:
+        comment("Command: Ignored by simulator: "+sLine);
+        break;
+    }
+}
+
+void B9FirmwareSim::addStep(int iType, int iTarget, int iSpeed, double dMS, const QString &sText)
+{
+    // an idle queue starts now, otherwise steps run back to back
+    if(!m_bStepActive && m_vSteps.isEmpty()) m_dStepEndMS = m_dSimMS;
+    SimStep vStep;
+    vStep.iType = iType;
+    vStep.iTarget = iTarget;
+    vStep.iSpeed = qBound(0, iSpeed, 100);
+    vStep.dMS = dMS;
+    vStep.sText = sText;
+    m_vSteps.append(vStep);
+}
+
+void B9FirmwareSim::advance(double dNowMS)
+{
+    // Run every step that finishes by dNowMS, each starting when the last one ended,
+    // so a large time scale completes several steps per tick without losing time
+    while(!m_vSteps.isEmpty()){
+        const SimStep &vStep = m_vSteps.first();
+        if(!m_bStepActive){
+            m_dStepStartMS = m_dStepEndMS;
+            double dDuration = 0;
+            if(vStep.iType==SimStep::ZMOVE){
+                m_dMoveFrom = m_dZPos;
+                dDuration = zMoveMS(qAbs(vStep.iTarget - (int)m_dZPos), vStep.iSpeed);
+            }
+            else if(vStep.iType==SimStep::VATMOVE){
+                m_dMoveFrom = m_dVatPos;
+                dDuration = vatMoveMS(qAbs(vStep.iTarget - (int)m_dVatPos), vStep.iSpeed);
+            }
+            else if(vStep.iType==SimStep::DELAY){
+                dDuration = vStep.dMS;
+            }
+            m_dStepEndMS = m_dStepStartMS + dDuration;
+            m_bStepActive = true;
+        }
+
+        if(dNowMS < m_dStepEndMS){
+            // part way through a move
+            double dFrac = (dNowMS - m_dStepStartMS)/(m_dStepEndMS - m_dStepStartMS);
+            if(vStep.iType==SimStep::ZMOVE) m_dZPos = m_dMoveFrom + (vStep.iTarget - m_dMoveFrom)*dFrac;
+            else if(vStep.iType==SimStep::VATMOVE) m_dVatPos = m_dMoveFrom + (vStep.iTarget - m_dMoveFrom)*dFrac;
+            return;
+        }
+
+        SimStep vDone = m_vSteps.takeFirst();
+        m_bStepActive = false;
+        finishStep(vDone);
+    }
+}
+
+void B9FirmwareSim::finishStep(const SimStep &vStep)
+{
+    switch(vStep.iType){
+    case SimStep::ZMOVE:
+        m_dZPos = vStep.iTarget;
+        m_iLastZReported = vStep.iTarget;
+        sendLine("Z"+QString::number(vStep.iTarget));
+        break;
+    case SimStep::VATMOVE:
+        m_dVatPos = vStep.iTarget;
+        sendLine("S"+QString::number(vStep.iTarget));
+        break;
+    case SimStep::COMMENT:
+        comment(vStep.sText, true);
+        break;
+    case SimStep::HOMED:
+        m_bNeedsReset = false;
+        m_dZPos = 0;
+        comment("Found Zero at:  0", true);
+        sendLine("X0");
+        sendLine("R0");
+        sendLine("Z0");
+        break;
+    case SimStep::CYCLEDONE:
+        comment("Cycle Finished.", true);
+        sendLine("F");
+        break;
+    default:
+        break;
+    }
+}
+
+double B9FirmwareSim::zMoveMS(int iDelta, int iSpeed)
+{
+    // Same motor model the host uses for its estimates, 100% is 140rpm,
+    // 0% is 10rpm, 200 PU per revolution
+    if(iDelta==0) return 0;
+    double dPUms = ((double)iSpeed/100.0)*130.0 + 10.0;
+    dPUms *= 200.0/60000.0;
+    return (double)iDelta/dPUms;
+}
+
+double B9FirmwareSim::vatMoveMS(int iDelta, int iSpeed)
+{
+    // Full travel takes 1500ms at 0% down to 1271ms at 100%
+    return (1500.0 - ((double)iSpeed/100.0)*229.0)*(double)iDelta/100.0;
+}
@@ -0,0 +1,139 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9FIRMWARESIM_H
+#define B9FIRMWARESIM_H
+
+#include <QThread>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QList>
+
+#define SIMTICKMS 10          // real ms between motion updates
+#define SIMBOOTMS 500         // real ms after the port opens before we talk, like the Arduino boot loader
+#define SIMBROADCASTMS 1000   // real ms between P & L broadcasts, keeps the host watchdog fed
+#define SIMZREPORTMS 100      // real ms between Z broadcasts while moving
+#define SIMUPPERZLIMPU 31497  // Z travel of a B9C1
+#define SIMHOMESPEED 100      // Z speed used while seeking home
+
+/******************************************************
+B9FirmwareSim pretends to be a B9Creator on the far side
+of a pseudo-terminal so the print path can be exercised
+without hardware.  It speaks the firmware's line protocol,
+moves Z and the vat at the speeds the host's cycle
+settings ask for, and replies 'F' when a release cycle is
+done.  dTimeScale > 1 runs the simulated mechanics,
+breathe and settle faster than real time.  Register the
+pty with B9PrinterComm::addVirtualPort(portName(),
+timeScale()) and the host scales its exposure schedule,
+projector warm up and cycle timeouts to match.  Only
+available where we have ptys (unix).
+******************************************************/
+class B9FirmwareSim : public QThread
+{
+    Q_OBJECT
+
+public:
+    B9FirmwareSim(double dTimeScale = 1.0, QObject *parent = 0);
+    ~B9FirmwareSim();
+
+    bool openPort();               // create the pty, false if we can't
+    QString portName(){return m_sPortName;} // device the host should open, e.g. /dev/pts/3
+    void setTimeScale(double dTimeScale);
+    double timeScale();
+    void stop();
+
+protected:
+    void run();
+
+private:
+    struct SimStep {
+        enum Type{ZMOVE, VATMOVE, DELAY, COMMENT, HOMED, CYCLEDONE};
+        int iType;
+        int iTarget;    // PU for ZMOVE, percent open for VATMOVE
+        int iSpeed;     // percent
+        double dMS;     // DELAY length
+        QString sText;  // COMMENT text
+    };
+
+    void makeRaw();
+    void hostConnected();
+    void handleLine(const QByteArray &baLine);
+    void sendLine(const QString &sLine);
+    void comment(const QString &sText, bool bVerboseOnly = false);
+    void sendStatus();
+    void addStep(int iType, int iTarget = 0, int iSpeed = 0, double dMS = 0, const QString &sText = QString());
+    void advance(double dNowMS);
+    void finishStep(const SimStep &vStep);
+    double zMoveMS(int iDelta, int iSpeed);
+    double vatMoveMS(int iDelta, int iSpeed);
+
+    int m_iMaster;
+    QString m_sPortName;
+    QMutex m_Mutex;
+    double m_dTimeScale;
+    volatile bool m_bQuit;
+
+    // everything below is only touched on the simulator thread
+    QElapsedTimer m_RealClock;
+    double m_dSimMS;         // simulated ms since start
+    double m_dLastRealMS;
+    double m_dLastBroadcastMS, m_dLastZReportMS;
+    double m_dConnectRealMS; // when the host opened the port, -1 once we've booted
+    bool m_bHostConnected;
+    QByteArray m_baRx;
+
+    QList<SimStep> m_vSteps;
+    bool m_bStepActive;
+    double m_dStepStartMS, m_dStepEndMS;
+    double m_dMoveFrom;
+
+    double m_dZPos;          // PU
+    double m_dVatPos;        // percent open
+    int m_iLastZReported;
+    bool m_bNeedsReset;
+    bool m_bProjectorOn;
+    bool m_bVerbose;
+    int m_iLampHrs;
+    int m_iXYPixelSize;
+    int m_iBreatheMS, m_iSettleMS, m_iGapPU;
+    int m_iRaiseSpd, m_iLowerSpd, m_iOpenSpd, m_iCloseSpd;
+};
+
+#endif // B9FIRMWARESIM_H
@@ -0,0 +1,360 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QPainter>
+#include <QDataStream>
+#include <QSettings>
+#include <QRunnable>
+#include <QThread>
+#include <QDesktopServices>
+#include <QDir>
+#include <QtDebug>
+#include "b9framecache.h"
+#include "b9projector.h"
+
+// Renders one layer of one build on a pool thread
+class B9FrameRenderTask : public QRunnable
+{
+public:
+    B9FrameRenderTask(B9FrameCache* pCache, int iBuild, int iLayer){m_pCache = pCache; m_iBuild = iBuild; m_iLayer = iLayer;}
+    void run(){m_pCache->renderLayer(m_iBuild, m_iLayer);}
+private:
+    B9FrameCache* m_pCache;
+    int m_iBuild, m_iLayer;
+};
+
+// Pulls spilled frames back into memory on a pool thread, so the exposure never waits on the disk
+class B9FrameRefillTask : public QRunnable
+{
+public:
+    B9FrameRefillTask(B9FrameCache* pCache, int iBuild, int iFrom){m_pCache = pCache; m_iBuild = iBuild; m_iFrom = iFrom;}
+    void run(){m_pCache->refillFrames(m_iBuild, m_iFrom);}
+private:
+    B9FrameCache* m_pCache;
+    int m_iBuild, m_iFrom;
+};
+
+B9FrameCache::B9FrameCache(QObject *parent) :
+    QObject(parent)
+{
+    m_iBuild = 0;
+    m_pCPJ = NULL;
+    m_xOffset = m_yOffset = 0;
+    m_iTotal = m_iReady = m_iDone = 0;
+    m_iFirst = 0;
+    m_pDiskFile = NULL;
+    m_iMemBytes = 0;
+    m_iMemBudget = (qint64)FRAMECACHEMB*1048576;
+    m_bRefilling = false;
+
+    // Leave a core for the GUI thread, it drives the exposure once printing starts
+    m_Pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()-1));
+}
+
+B9FrameCache::~B9FrameCache()
+{
+    cancel();
+}
+
+void B9FrameCache::startBuild(CrushedPrintJob* pCPJ, int iLastLayer, QSize vSize, int xOffset, int yOffset, QImage vNormalizedMask, int iFirstLayer)
+{
+    cancel();
+    if(iFirstLayer<0) iFirstLayer = 0;
+    if(pCPJ==NULL || iLastLayer<1 || iFirstLayer>=iLastLayer || vSize.isEmpty()) return;
+
+    QSettings settings;
+    m_iMemBudget = (qint64)settings.value("FrameCacheMB",FRAMECACHEMB).toInt()*1048576;
+    if(m_iMemBudget<0) m_iMemBudget = 0;
+
+    int iBuild;
+    {
+        QMutexLocker lock(&m_Mutex);
+        iBuild = m_iBuild;
+        m_pCPJ = pCPJ;
+        m_vSize = vSize;
+        m_xOffset = xOffset;
+        m_yOffset = yOffset;
+        m_NormalizedMask = vNormalizedMask;
+        m_iTotal = iLastLayer;
+        m_iFirst = iFirstLayer;
+        m_iReady = 0;
+        m_iDone = m_iFirst;
+        m_vMemFrames.resize(iLastLayer);
+        m_vFilePos.fill(-1, iLastLayer);
+        m_vFileSize.fill(0, iLastLayer);
+    }
+    m_BuildClock.start();
+    qDebug() << "Frame Cache:  Pre-rendering" << iLastLayer-iFirstLayer << "layers on" << m_Pool.maxThreadCount() << "threads";
+
+    // Queued in layer order so the first layers are ready first
+    for(int i=iFirstLayer; i<iLastLayer; i++)
+        m_Pool.start(new B9FrameRenderTask(this, iBuild, i));
+}
+
+void B9FrameCache::cancel()
+{
+    {
+        QMutexLocker lock(&m_Mutex);
+        m_iBuild++;  // anything still queued sees a stale build and returns at once
+    }
+    m_Pool.waitForDone();
+
+    QMutexLocker lock(&m_Mutex);
+    m_pCPJ = NULL;
+    m_iTotal = m_iReady = m_iDone = 0;
+    m_iFirst = 0;
+    m_vMemFrames.clear();
+    m_vFilePos.clear();
+    m_vFileSize.clear();
+    m_iMemBytes = 0;
+    m_bRefilling = false;
+    delete m_pDiskFile;
+    m_pDiskFile = NULL;
+}
+
+bool B9FrameCache::isValidFor(CrushedPrintJob* pCPJ, QSize vSize, int xOffset, int yOffset, const QImage &vNormalizedMask)
+{
+    QMutexLocker lock(&m_Mutex);
+    return m_iTotal>0 && pCPJ==m_pCPJ && vSize==m_vSize && xOffset==m_xOffset && yOffset==m_yOffset &&
+            vNormalizedMask.cacheKey()==m_NormalizedMask.cacheKey();
+}
+
+bool B9FrameCache::rebuildFor(CrushedPrintJob* pCPJ, QSize vSize, int xOffset, int yOffset, QImage vNormalizedMask, int iFirstLayer)
+{
+    int iLastLayer;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(m_iTotal<1 || pCPJ!=m_pCPJ) return false;
+        iLastLayer = m_iTotal;
+    }
+    startBuild(pCPJ, iLastLayer, vSize, xOffset, yOffset, vNormalizedMask, iFirstLayer);
+    return true;
+}
+
+bool B9FrameCache::fetchFrame(int iLayer, B9RenderedFrame* pFrame)
+{
+    QByteArray baPacked;
+    QSize vSize;
+    qint64 iFilePos = -1;
+    int iFileSize = 0;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(iLayer<0 || iLayer>=m_iTotal) return false;
+        vSize = m_vSize;
+        if(!m_vMemFrames[iLayer].isEmpty())
+            baPacked = m_vMemFrames[iLayer];
+        else if(m_pDiskFile!=NULL){
+            iFilePos = m_vFilePos[iLayer];
+            iFileSize = m_vFileSize[iLayer];
+        }
+    }
+    if(baPacked.isEmpty() && iFilePos>=0){
+        // The refill hasn't got this far, read it ourselves rather than render it live
+        QMutexLocker lock(&m_FileMutex);
+        if(m_pDiskFile->seek(iFilePos)) baPacked = m_pDiskFile->read(iFileSize);
+    }
+    if(baPacked.isEmpty()) return false;
+    return unpackFrame(baPacked, vSize, pFrame);
+}
+
+void B9FrameCache::dropFrame(int iLayer)
+{
+    QMutexLocker lock(&m_Mutex);
+    if(iLayer<0 || iLayer>=m_iTotal) return;
+    m_iMemBytes -= m_vMemFrames[iLayer].size();
+    m_vMemFrames[iLayer].clear();
+
+    // Pull the next spilled frames back into the memory we just freed, off this thread
+    if(m_pDiskFile==NULL || m_bRefilling) return;
+    m_bRefilling = true;
+    m_Pool.start(new B9FrameRefillTask(this, m_iBuild, iLayer+1), 1); // ahead of any layers still rendering
+}
+
+void B9FrameCache::refillFrames(int iBuild, int iFrom)
+{
+    for(int i=iFrom; ; i++){
+        qint64 iFilePos;
+        int iFileSize;
+        {
+            QMutexLocker lock(&m_Mutex);
+            if(iBuild!=m_iBuild) return;
+            for(; i<m_iTotal; i++)
+                if(m_vFilePos[i]>=0 && m_vMemFrames[i].isEmpty()) break;
+            if(i>=m_iTotal || m_iMemBytes + m_vFileSize[i] > m_iMemBudget){
+                m_bRefilling = false;
+                return;
+            }
+            iFilePos = m_vFilePos[i];
+            iFileSize = m_vFileSize[i];
+        }
+
+        QByteArray baPacked;
+        {
+            QMutexLocker lock(&m_FileMutex);
+            if(m_pDiskFile->seek(iFilePos)) baPacked = m_pDiskFile->read(iFileSize);
+        }
+
+        QMutexLocker lock(&m_Mutex);
+        if(iBuild!=m_iBuild) return;
+        if(baPacked.size()!=iFileSize){
+            m_bRefilling = false;
+            return;
+        }
+        if(m_vMemFrames[i].isEmpty()){
+            m_vMemFrames[i] = baPacked;
+            m_iMemBytes += baPacked.size();
+        }
+    }
+}
+
+void B9FrameCache::renderLayer(int iBuild, int iLayer)
+{
+    CrushedPrintJob* pCPJ;
+    QSize vSize;
+    int xOffset, yOffset;
+    QImage vMask;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(iBuild!=m_iBuild) return;
+        pCPJ = m_pCPJ;
+        vSize = m_vSize;
+        xOffset = m_xOffset;
+        yOffset = m_yOffset;
+        vMask = m_NormalizedMask;
+    }
+
+    B9RenderedFrame vFrame;
+    renderFrame(pCPJ, iLayer, vSize, xOffset, yOffset, vMask, &vFrame);
+    QByteArray baPacked = packFrame(vFrame);
+
+    int iReady, iDone, iTotal;
+    {
+        QMutexLocker lock(&m_Mutex);
+        if(iBuild!=m_iBuild) return;
+        if(m_iMemBytes + baPacked.size() <= m_iMemBudget){
+            m_vMemFrames[iLayer] = baPacked;
+            m_iMemBytes += baPacked.size();
+        }
+        else {
+            // Over budget, spill to disk.  If that fails the layer is simply rendered live when it comes up
+            if(m_pDiskFile==NULL){
+                QString sPath = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+                if(!sPath.isEmpty()) QDir().mkpath(sPath);
+                m_pDiskFile = new QTemporaryFile(sPath.isEmpty() ? QDir::tempPath()+"/B9Frames" : sPath+"/B9Frames");
+                if(!m_pDiskFile->open()) qDebug() << "Frame Cache:  Unable to open spill file" << m_pDiskFile->fileName();
+            }
+            QMutexLocker fileLock(&m_FileMutex);
+            if(m_pDiskFile->isOpen() && m_pDiskFile->seek(m_pDiskFile->size()) && m_pDiskFile->write(baPacked)==baPacked.size()){
+                m_vFilePos[iLayer] = m_pDiskFile->size() - baPacked.size();
+                m_vFileSize[iLayer] = baPacked.size();
+            }
+        }
+        if(!m_vMemFrames[iLayer].isEmpty() || m_vFilePos[iLayer]>=0) m_iReady++;
+        m_iDone++;
+        iDone = m_iDone;
+        iReady = m_iReady;
+        iTotal = m_iTotal - m_iFirst;
+        iDone -= m_iFirst;
+    }
+    if(iDone==iTotal)
+        qDebug() << "Frame Cache:  Pre-rendered" << iReady << "of" << iTotal << "layers in" << m_BuildClock.elapsed()/1000.0 << "seconds";
+}
+
+void B9FrameCache::renderFrame(CrushedPrintJob* pCPJ, int iLayer, QSize vSize, int xOffset, int yOffset, const QImage &vNormalizedMask, B9RenderedFrame* pFrame)
+{
+    // inflate the slice
+    pFrame->vSlice = QImage(vSize, QImage::Format_ARGB32_Premultiplied);
+    pFrame->vSlice.fill(qRgba(0,0,0,0));
+    pCPJ->inflateSlice(iLayer, &pFrame->vSlice, xOffset, yOffset);
+
+    // Tover map and level buckets, radius of 3 pixels as in B9Projector::drawCBM
+    QByteArray vToverMap;
+    B9Projector::createToverMap(3, pFrame->vSlice, vToverMap);
+    B9Projector::createLevelBuckets(pFrame->vSlice, vToverMap, pFrame->vLevelStart, pFrame->vLevelPixels);
+
+    // copy the gray scale over using the slice as a mask
+    QPainter mPainter(&pFrame->vSlice);
+    mPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+    mPainter.drawImage(0,0,vNormalizedMask);
+    mPainter.end();
+}
+
+QByteArray B9FrameCache::packFrame(const B9RenderedFrame &vFrame)
+{
+    // Only the lit pixels carry anything, so we keep the rectangle around them
+    int iWidth = vFrame.vSlice.width();
+    QRect rCrop;
+    if(iWidth>0 && !vFrame.vLevelPixels.isEmpty()){
+        int iLeft = iWidth, iRight = -1, iTop = vFrame.vLevelPixels[0]/iWidth, iBottom = iTop;
+        const int *pPixels = vFrame.vLevelPixels.constData();
+        for(int i=0; i<vFrame.vLevelPixels.size(); i++){
+            int y = pPixels[i]/iWidth;
+            int x = pPixels[i] - y*iWidth;
+            if(x<iLeft) iLeft = x;
+            if(x>iRight) iRight = x;
+            if(y<iTop) iTop = y;
+            if(y>iBottom) iBottom = y;
+        }
+        rCrop = QRect(QPoint(iLeft,iTop), QPoint(iRight,iBottom));
+    }
+
+    QByteArray baRaw;
+    QDataStream out(&baRaw, QIODevice::WriteOnly);
+    out << rCrop;
+    for(int y=rCrop.top(); y<=rCrop.bottom() && rCrop.isValid(); y++)
+        out.writeRawData((const char*)(vFrame.vSlice.constScanLine(y) + rCrop.left()*4), rCrop.width()*4);
+    out << vFrame.vLevelStart << vFrame.vLevelPixels;
+    return qCompress(baRaw, 1); // favour speed, the frames are mostly black and squeeze well anyway
+}
+
+bool B9FrameCache::unpackFrame(const QByteArray &baPacked, QSize vSize, B9RenderedFrame* pFrame)
+{
+    QByteArray baRaw = qUncompress(baPacked);
+    if(baRaw.isEmpty()) return false;
+    QDataStream in(baRaw);
+    QRect rCrop;
+    in >> rCrop;
+    if(rCrop.isValid() && !QRect(QPoint(0,0),vSize).contains(rCrop)) return false;
+
+    pFrame->vSlice = QImage(vSize, QImage::Format_ARGB32_Premultiplied);
+    pFrame->vSlice.fill(qRgba(0,0,0,0));
+    for(int y=rCrop.top(); y<=rCrop.bottom() && rCrop.isValid(); y++)
+        if(in.readRawData((char*)(pFrame->vSlice.scanLine(y) + rCrop.left()*4), rCrop.width()*4) != rCrop.width()*4) return false;
+    in >> pFrame->vLevelStart >> pFrame->vLevelPixels;
+    return in.status()==QDataStream::Ok && pFrame->vLevelStart.size()==257;
+}
@@ -0,0 +1,117 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9FRAMECACHE_H
+#define B9FRAMECACHE_H
+
+#include <QObject>
+#include <QImage>
+#include <QVector>
+#include <QMutex>
+#include <QThreadPool>
+#include <QTemporaryFile>
+#include <QElapsedTimer>
+#include "crushbitmap.h"
+
+#define FRAMECACHEMB 256    // default memory held by packed frames before we spill to disk
+
+// One projector frame, ready to show
+struct B9RenderedFrame {
+    QImage vSlice;              // inflated, offset and normalized slice at projector size
+    QVector<int> vLevelStart;   // 257 entries, where each Tover level starts in vLevelPixels
+    QVector<int> vLevelPixels;  // offsets of the lit pixels, sorted by Tover level
+};
+
+/******************************************************
+B9FrameCache renders every layer of a print job ahead
+of time on a pool of worker threads, while the projector
+warms up and Z homes.  Frames are packed (cropped and
+compressed) and kept in memory up to a budget, the rest
+go to a temporary file.  Fetching a frame during the
+print costs an unpack instead of a full render.
+******************************************************/
+class B9FrameCache : public QObject
+{
+    Q_OBJECT
+public:
+    B9FrameCache(QObject *parent = 0);
+    ~B9FrameCache();
+
+    // Start rendering layers iFirstLayer to iLastLayer-1 for the given projector geometry, offsets and normalization mask
+    void startBuild(CrushedPrintJob* pCPJ, int iLastLayer, QSize vSize, int xOffset, int yOffset, QImage vNormalizedMask, int iFirstLayer = 0);
+    void cancel();  // stop any build and drop all frames
+
+    bool isValidFor(CrushedPrintJob* pCPJ, QSize vSize, int xOffset, int yOffset, const QImage &vNormalizedMask);
+    // Restart a build of pCPJ from iFirstLayer for a new projector geometry, false if we're not building pCPJ
+    bool rebuildFor(CrushedPrintJob* pCPJ, QSize vSize, int xOffset, int yOffset, QImage vNormalizedMask, int iFirstLayer);
+    bool fetchFrame(int iLayer, B9RenderedFrame* pFrame);  // false if iLayer is not rendered (yet)
+    void dropFrame(int iLayer);  // iLayer has been printed, release what it holds and refill from disk on the pool
+    int framesReady(){QMutexLocker lock(&m_Mutex); return m_iReady;}
+    void setMaxThreads(int iThreads){m_Pool.setMaxThreadCount(qMax(1, iThreads));} // when several printers share the cores
+
+    // The same pipeline B9Projector::drawCBM runs, usable from any thread
+    static void renderFrame(CrushedPrintJob* pCPJ, int iLayer, QSize vSize, int xOffset, int yOffset, const QImage &vNormalizedMask, B9RenderedFrame* pFrame);
+
+private:
+    friend class B9FrameRenderTask;
+    friend class B9FrameRefillTask;
+    void renderLayer(int iBuild, int iLayer);  // runs on the pool threads
+    void refillFrames(int iBuild, int iFrom);  // pool thread, reads spilled frames from iFrom on back into memory
+    static QByteArray packFrame(const B9RenderedFrame &vFrame);
+    static bool unpackFrame(const QByteArray &baPacked, QSize vSize, B9RenderedFrame* pFrame);
+
+    QMutex m_Mutex;             // guards everything below that the workers touch
+    QMutex m_FileMutex;         // guards m_pDiskFile's position, taken after m_Mutex or on its own
+    QThreadPool m_Pool;
+    int m_iBuild;               // bumped on every start or cancel, stale workers check it and bail
+    CrushedPrintJob* m_pCPJ;
+    QSize m_vSize;
+    int m_xOffset, m_yOffset;
+    QImage m_NormalizedMask;
+    int m_iTotal, m_iReady, m_iDone;  // layers asked for, rendered and stored, rendered or given up on
+    int m_iFirst;                     // layers below this are not rendered, a resumed print has already printed them
+    QVector<QByteArray> m_vMemFrames;   // packed frames held in memory
+    QVector<qint64> m_vFilePos;         // where a spilled frame starts in m_DiskFile, -1 if not spilled
+    QVector<int> m_vFileSize;
+    QTemporaryFile* m_pDiskFile;
+    qint64 m_iMemBytes, m_iMemBudget;
+    bool m_bRefilling;                  // a refill task is queued or running
+    QElapsedTimer m_BuildClock;
+};
+
+#endif // B9FRAMECACHE_H
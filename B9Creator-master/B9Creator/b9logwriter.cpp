@@ -0,0 +1,174 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QDateTime>
+#include <QByteArray>
+#include <stdio.h>
+#include <string.h>
+#include "b9logwriter.h"
+
+B9LogWriter::B9LogWriter(QString sLogFile, QString sHeader, qint64 iMaxBytes)
+{
+    m_sLogFile = sLogFile;
+    m_sHeader = sHeader;
+    m_iMaxBytes = iMaxBytes;
+    m_iDequeuePos = 0;
+    m_bQuit = false;
+    for(int i=0; i<LOGRINGSLOTS; i++) m_Ring[i].iSeq = i;
+    openLog(false);
+}
+
+B9LogWriter::~B9LogWriter()
+{
+    stop();
+    flush();
+    m_File.close();
+}
+
+void B9LogWriter::stop()
+{
+    m_bQuit = true;
+    wait();
+}
+
+bool B9LogWriter::post(QtMsgType eType, const char *msg)
+{
+    // Claim a slot.  A slot is free for position iPos when its sequence equals iPos.
+    LogSlot* pSlot;
+    int iPos = m_iEnqueuePos.fetchAndAddAcquire(0);
+    for(;;){
+        pSlot = &m_Ring[iPos & (LOGRINGSLOTS-1)];
+        int iDif = (int)((unsigned)pSlot->iSeq.fetchAndAddAcquire(0) - (unsigned)iPos);
+        if(iDif == 0){
+            if(m_iEnqueuePos.testAndSetRelaxed(iPos, iPos+1)) break;
+            iPos = m_iEnqueuePos.fetchAndAddAcquire(0);
+        }
+        else if(iDif < 0){
+            m_iDropped.ref(); // full, the writer is behind
+            return false;
+        }
+        else iPos = m_iEnqueuePos.fetchAndAddAcquire(0);
+    }
+
+    pSlot->iTimeMS = QDateTime::currentMSecsSinceEpoch();
+    pSlot->iType = eType;
+    int iLen = (int)strlen(msg);
+    if(iLen > LOGLINEMAX) iLen = LOGLINEMAX;
+    memcpy(pSlot->sText, msg, iLen);
+    pSlot->iLen = iLen;
+    pSlot->iSeq.fetchAndStoreRelease(iPos+1); // hand it to the writer
+    return true;
+}
+
+bool B9LogWriter::flush()
+{
+    // A fatal error raised while drain() holds m_DrainMutex would deadlock here
+    if(QThread::currentThread()==this) return false;
+    drain();
+    return true;
+}
+
+void B9LogWriter::run()
+{
+    while(!m_bQuit){
+        if(drain()==0) msleep(LOGFLUSHMS);
+    }
+}
+
+int B9LogWriter::drain()
+{
+    QMutexLocker lock(&m_DrainMutex);
+    QByteArray baBatch;
+    int iCount = 0;
+    for(;;){
+        LogSlot* pSlot = &m_Ring[m_iDequeuePos & (LOGRINGSLOTS-1)];
+        int iDif = (int)((unsigned)pSlot->iSeq.fetchAndAddAcquire(0) - (unsigned)(m_iDequeuePos+1));
+        if(iDif != 0) break; // nothing more posted
+
+        baBatch += QDateTime::fromMSecsSinceEpoch(pSlot->iTimeMS).toString("yy.MM.dd hh:mm:ss.zzz").toAscii();
+        switch(pSlot->iType){
+        case QtWarningMsg: baBatch += "  Warning: "; break;
+        case QtCriticalMsg: baBatch += "  Critical: "; break;
+        case QtFatalMsg: baBatch += "  Fatal: "; break;
+        default: baBatch += "  : "; break;
+        }
+        baBatch.append(pSlot->sText, pSlot->iLen);
+        baBatch += "\r\n";
+
+        pSlot->iSeq.fetchAndStoreRelease(m_iDequeuePos + LOGRINGSLOTS); // free for the next lap
+        m_iDequeuePos++;
+        iCount++;
+    }
+
+    int iDropped = m_iDropped.fetchAndStoreRelaxed(0);
+    if(iDropped > 0) baBatch += QString("** %1 log messages dropped, the log writer fell behind\r\n").arg(iDropped).toAscii();
+    if(baBatch.isEmpty()) return 0;
+
+    fwrite(baBatch.constData(), 1, baBatch.size(), stderr);
+    if(m_File.isOpen()){
+        m_File.write(baBatch);
+        m_File.flush();
+        if(m_iMaxBytes > 0 && m_File.size() > m_iMaxBytes) openLog(true);
+    }
+    return iCount;
+}
+
+void B9LogWriter::openLog(bool bRotate)
+{
+    m_File.close();
+    if(bRotate){
+        // name.txt -> name.txt.1 -> name.txt.2 ...
+        QFile::remove(m_sLogFile+"."+QString::number(LOGKEEPFILES));
+        for(int i=LOGKEEPFILES-1; i>0; i--)
+            QFile::rename(m_sLogFile+"."+QString::number(i), m_sLogFile+"."+QString::number(i+1));
+        QFile::rename(m_sLogFile, m_sLogFile+"."+QString::number(1));
+    }
+    else {
+        QFile::remove(m_sLogFile);
+        for(int i=1; i<=LOGKEEPFILES; i++) QFile::remove(m_sLogFile+"."+QString::number(i));
+    }
+
+    m_File.setFileName(m_sLogFile);
+    if(!m_File.open(QIODevice::WriteOnly | QIODevice::Append)){
+        fprintf(stderr, "Unable to open log file %s\n", m_sLogFile.toAscii().constData());
+        return;
+    }
+    m_File.write((m_sHeader+"\r\n\r\n").toAscii());
+    if(bRotate) m_File.write("(continued, older entries are in "+m_sLogFile.toAscii()+".1)\r\n");
+    m_File.flush();
+}
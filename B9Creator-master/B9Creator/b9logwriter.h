@@ -0,0 +1,100 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9LOGWRITER_H
+#define B9LOGWRITER_H
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QFile>
+#include <QString>
+
+#define LOGRINGSLOTS 4096   // must be a power of 2
+#define LOGLINEMAX 480      // longer messages are cut here
+#define LOGFLUSHMS 50       // the writer sleeps this long when there is nothing to write
+#define LOGKEEPFILES 3      // rotated logs kept as name.1 .. name.3
+
+/******************************************************
+B9LogWriter gets log messages to disk off the calling
+thread.  post() copies a message into a bounded lock-free
+ring that any number of threads can write to at once, and
+the writer thread drains it in batches.  When the file
+grows past the size limit it is rotated.  flush() writes
+everything posted so far before returning, for fatal
+errors and shutdown, except on the writer thread itself.
+******************************************************/
+class B9LogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    B9LogWriter(QString sLogFile, QString sHeader, qint64 iMaxBytes);
+    ~B9LogWriter();
+
+    bool post(QtMsgType eType, const char *msg); // false if the ring was full and the message was dropped
+    bool flush();  // false if called on the writer thread, which may already be inside drain()
+    void stop();
+
+protected:
+    void run();
+
+private:
+    struct LogSlot {
+        QAtomicInt iSeq;    // tells producers and the writer whose turn the slot is
+        qint64 iTimeMS;
+        int iType;
+        int iLen;
+        char sText[LOGLINEMAX];
+    };
+
+    int drain();  // write what is in the ring, returns the number of messages written
+    void openLog(bool bRotate);
+
+    LogSlot m_Ring[LOGRINGSLOTS];
+    QAtomicInt m_iEnqueuePos;
+    int m_iDequeuePos;      // only touched with m_DrainMutex held
+    QAtomicInt m_iDropped;
+    QMutex m_DrainMutex;    // the writer thread and flush() both drain
+    QFile m_File;
+    QString m_sLogFile, m_sHeader;
+    qint64 m_iMaxBytes;
+    volatile bool m_bQuit;
+};
+
+#endif // B9LOGWRITER_H
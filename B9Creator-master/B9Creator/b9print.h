@@ -42,9 +42,9 @@
 #include <QDialog>
 #include <QDateTime>
 #include <QHideEvent>
-#include <QSettings>
 #include "helpsystem.h"
 #include "b9terminal.h"
+#include "b9printcontroller.h"
 
 namespace Ui {
 class B9Print;
@@ -59,61 +59,44 @@ public:
     ~B9Print();
     // If PrintPreview we do not power up the projector.  If UsePrimaryMonitor we force the output to the primary monitor
     void print3D(CrushedPrintJob *pCPJ, int iXOff, int iYOff, int iTbase, int iTover, int iTattach, int iNumAttach = 1, int iLastLayer = 0, bool bPrintPreview = false, bool bUsePrimaryMonitor = false);
+    bool resumePrint(CrushedPrintJob *pCPJ, B9PrintCheckpoint vCheckpoint); // false if the checkpoint is not for pCPJ
+    void setJobFile(QString sJobFile){m_pController->setJobFile(sJobFile);}
+    QString getJournalFile(){return m_pController->getJournalFile();}
     
 signals:
     void eventHiding();
 
 public slots:
-    void setProjMessage(QString sText);
-    QString updateTimes();
+    void setProjMessage(QString sText){m_pController->setProjMessage(sText);}
 
 private slots:
     void showHelp();
     void on_updateConnectionStatus(QString sText);
     void on_updateProjectorOutput(QString sText);
     void on_updateProjectorStatus(QString sText);
-    void on_updateProjector(B9PrinterStatus::ProjectorStatus eStatus);
-    void on_signalAbortPrint();
 
-    void exposeTBaseLayer();
-    void startExposeTOverLayers();
-    void exposureOfCurTintLayerFinished();
-    void exposureOfTOverLayersFinished();
+    void onLayerStatus(QString sText);
+    void onProgress(int iLayers, int iTotalLayers);
+    void onTimesUpdated(QTime vTimeFinished, QString sTimeRemaining);
+    void onPauseResumeChanged(QString sText, bool bEnabled);
+    void onAbortChanged(QString sText, bool bEnabled);
+    void onPrintFinished();
+    void onPrintAborted(QString sMessage);
 
     void on_pushButtonPauseResume_clicked();
 
-    void on_pushButtonAbort_clicked(QString sAbortText="User Directed Abort.");
+    void on_pushButtonAbort_clicked();
 
 private:
-    enum {PRINT_NO, PRINT_SETUP1, PRINT_SETUP2, PRINT_RELEASING, PRINT_EXPOSING, PRINT_ABORT, PRINT_DONE};
-    enum {PAUSE_NO, PAUSE_WAIT, PAUSE_YES};
-
     void keyPressEvent(QKeyEvent * pEvent);		// Handle key press events
     void hideEvent(QHideEvent *event);
     void closeEvent ( QCloseEvent * event );
 
-    double curLayerIndexMM();
-    void setSlice(int iSlice);
-
     HelpSystem m_HelpSystem;
     Ui::B9Print *ui;
 
     B9Terminal* m_pTerminal;
-    CrushedPrintJob* m_pCPJ;
-    int m_iTbase,  m_iTover, m_iTattach, m_iNumAttach;
-    int m_iXOff, m_iYOff;
-    int m_iPrintState;
-    int m_iCurLayerNumber;
-    int m_iLastLayer;
-    double m_dLayerThickness;
-    int m_iPaused;
-    bool m_bAbort;
-    QString m_sAbortMessage;
-    double m_dTintMS;
-    int m_iTintNum, m_iCurTintIndex, m_iMinimumTintMS,m_iMinimumTintMSWorstCase;
-    QTime m_vClock;
-    QSettings m_vSettings;
-
+    B9PrintController* m_pController;
 };
 
 #endif // B9PRINT_H
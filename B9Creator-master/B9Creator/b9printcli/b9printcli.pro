@@ -0,0 +1,87 @@
+#************************************************************************************
+#
+#  LICENSE INFORMATION
+#
+#  BCreator(tm)
+#  Software for the control of the 3D Printer, "B9Creator"(tm)
+#
+#  Copyright 2011-2012 B9Creations, LLC
+#  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+#
+#  This file is part of B9Creator
+#
+#    B9Creator is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    B9Creator is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+#
+#  The above copyright notice and this permission notice shall be
+#    included in all copies or substantial portions of the Software.
+#
+#    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+#    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+#    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+#    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+#    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+#    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+#    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+
+# b9printcli prints a .b9j job with no control panel, see b9printrunner.h
+
+QT       += core gui
+
+TARGET = b9printcli
+TEMPLATE = app
+CONFIG += console
+
+INCLUDEPATH += ..
+
+SOURCES += main.cpp \
+    b9printrunner.cpp \
+    b9printhost.cpp \
+    ../b9printer.cpp \
+    ../b9printcontroller.cpp \
+    ../b9printercomm.cpp \
+    ../b9projector.cpp \
+    ../crushbitmap.cpp \
+    ../b9matcat.cpp \
+    ../b9exposurescheduler.cpp \
+    ../b9printtelemetry.cpp \
+    ../b9framecache.cpp \
+    ../b9cyclemodel.cpp \
+    ../b9cycleplanner.cpp \
+    ../b9firmwaresim.cpp \
+    ../logfilemanager.cpp \
+    ../b9logwriter.cpp \
+    ../b9printjournal.cpp \
+    ../b9exposureplan.cpp
+
+HEADERS  += b9printrunner.h \
+    b9printhost.h \
+    ../b9printer.h \
+    ../b9printcontroller.h \
+    ../b9printercomm.h \
+    ../b9projector.h \
+    ../crushbitmap.h \
+    ../b9matcat.h \
+    ../b9exposurescheduler.h \
+    ../b9printtelemetry.h \
+    ../b9framecache.h \
+    ../b9cyclemodel.h \
+    ../b9cycleplanner.h \
+    ../b9firmwaresim.h \
+    ../logfilemanager.h \
+    ../b9logwriter.h \
+    ../b9printjournal.h \
+    ../b9exposureplan.h
+
+include(../qextserialport-1.2beta2/src/qextserialport.pri)
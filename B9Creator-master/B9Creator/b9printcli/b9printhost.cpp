@@ -0,0 +1,130 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtDebug>
+#include <QSettings>
+#include <QStringList>
+#include <QThread>
+#include "b9printhost.h"
+#include "b9printercomm.h"
+
+B9PrintHost::B9PrintHost(QObject *parent) :
+    QObject(parent)
+{
+    m_iRunning = 0;
+    m_iExitCode = 0;
+}
+
+B9PrintHost::~B9PrintHost()
+{
+    for(int i=0; i<m_vRunners.count(); i++) delete m_vRunners[i];
+    for(int i=0; i<m_vSimulators.count(); i++){
+        m_vSimulators[i]->stop();
+        delete m_vSimulators[i];
+    }
+}
+
+bool B9PrintHost::load(QString sHostFile, bool bSimulate, double dSimScale)
+{
+    QSettings vHost(sHostFile, QSettings::IniFormat);
+    QStringList vSessions = vHost.childGroups();
+    if(vSessions.isEmpty()){
+        qDebug() << "Print Host: no printers listed in" << sHostFile;
+        return false;
+    }
+
+    // Split the render cores between the sessions, leaving one for the GUI thread
+    int iRenderThreads = qMax(1, (QThread::idealThreadCount()-1)/vSessions.count());
+
+    for(int i=0; i<vSessions.count(); i++){
+        QString sName = vSessions[i];
+        vHost.beginGroup(sName);
+        B9PrintRunner* pRunner = new B9PrintRunner(0, sName);
+        m_vRunners.append(pRunner);
+        if(!pRunner->loadJob(vHost.value("job").toString())){
+            qDebug() << "Print Host: error loading" << vHost.value("job").toString() << "for" << sName;
+            vHost.endGroup();
+            return false;
+        }
+        if(!vHost.contains("screen"))
+            qDebug() << "Print Host: WARNING no screen given for" << sName << "printers with the same projector will pick the same screen";
+        pRunner->setScreen(vHost.value("screen",-1).toInt());
+        pRunner->setMaterial(vHost.value("material").toString());
+        pRunner->setOffset(vHost.value("xoff",0).toInt(), vHost.value("yoff",0).toInt());
+        pRunner->setLastLayer(vHost.value("layers",0).toInt());
+        pRunner->setPrintPreview(vHost.value("preview",false).toBool());
+        pRunner->setResume(vHost.value("resume",false).toBool());
+        if(!vHost.value("plan").toString().isEmpty() && !pRunner->setPlanFile(vHost.value("plan").toString())){
+            vHost.endGroup();
+            return false;
+        }
+        pRunner->setRenderThreads(iRenderThreads);
+        pRunner->setPort(vHost.value("port").toString());
+
+        if(bSimulate){
+            B9FirmwareSim* pSim = new B9FirmwareSim;
+            pSim->setTimeScale(dSimScale);
+            if(pSim->openPort()){
+                B9PrinterComm::addVirtualPort(pSim->portName(), pSim->timeScale());
+                pRunner->setPort(pSim->portName());
+                pSim->start();
+            }
+            m_vSimulators.append(pSim);
+        }
+        else if(vHost.value("port").toString().isEmpty())
+            qDebug() << "Print Host: WARNING no port given for" << sName << "it will take the first free B9Creator found";
+
+        connect(pRunner, SIGNAL(finished(int)), this, SLOT(onRunnerFinished(int)));
+        vHost.endGroup();
+    }
+    qDebug() << "Print Host:" << m_vRunners.count() << "printers," << iRenderThreads << "render threads each";
+    return true;
+}
+
+void B9PrintHost::start()
+{
+    m_iRunning = m_vRunners.count();
+    for(int i=0; i<m_vRunners.count(); i++) m_vRunners[i]->start();
+}
+
+void B9PrintHost::onRunnerFinished(int iExitCode)
+{
+    if(iExitCode > m_iExitCode) m_iExitCode = iExitCode;
+    m_iRunning--;
+    if(m_iRunning<=0) emit finished(m_iExitCode);
+}
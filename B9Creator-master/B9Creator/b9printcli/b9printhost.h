@@ -0,0 +1,109 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTHOST_H
+#define B9PRINTHOST_H
+
+#include <QObject>
+#include <QList>
+#include "b9printrunner.h"
+#include "b9firmwaresim.h"
+
+/******************************************************
+B9PrintHost drives a rack of B9Creators from one process.
+Each [group] of the host file is a session with its own
+comm port, projector screen, job and B9PrintRunner:
+
+    [left]
+    port=/dev/ttyACM0
+    screen=1
+    job=/jobs/part.b9j
+    material=B9R-1-Red
+    xoff=0
+    yoff=0
+    layers=0
+    preview=false
+    resume=false
+    plan=
+
+Every session times its exposures on its own scheduler
+thread and pre-renders its frames on its own share of the
+cores.  What happens at each deadline, the pixel clearing
+and projector repaint, along with every session's serial
+reads and frame cache fetches, still runs on the one GUI
+thread, since Qt widgets can not leave it.  A session that
+keeps the event loop busy delays the others' deadlines,
+watch the jitter column of each PrintTiming file.
+
+For the same reason a session does not look for its
+printer while another session is printing: probing a
+port waits up to 5 seconds, and a firmware update runs
+avrdude for up to 2 minutes, both on that thread.  A
+session that loses its printer, or whose printer needs
+new firmware, waits until no other session is printing.
+Start every session connected and on current firmware.
+******************************************************/
+class B9PrintHost : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit B9PrintHost(QObject *parent = 0);
+    ~B9PrintHost();
+
+    // false if the file lists no printers or a job can not be read.  bSimulate gives every session its own simulator.
+    bool load(QString sHostFile, bool bSimulate = false, double dSimScale = 1.0);
+    int getExitCode(){return m_iExitCode;} // worst of the sessions
+
+public slots:
+    void start();
+
+signals:
+    void finished(int iExitCode);
+
+private slots:
+    void onRunnerFinished(int iExitCode);
+
+private:
+    QList<B9PrintRunner*> m_vRunners;
+    QList<B9FirmwareSim*> m_vSimulators;
+    int m_iRunning;
+    int m_iExitCode;
+};
+
+#endif // B9PRINTHOST_H
@@ -0,0 +1,266 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTimer>
+#include "b9printrunner.h"
+
+B9PrintRunner::B9PrintRunner(QObject *parent, QString sName) :
+    QObject(parent)
+{
+    m_sTag = sName.isEmpty() ? QString("Print Runner:") : "Print Runner "+sName+":";
+    m_iXOff = m_iYOff = 0;
+    m_iLastLayer = 0;
+    m_iTbaseMS = m_iToverMS = m_iTattachMS = 0;
+    m_iNumAttach = 1;
+    m_bPreview = false;
+    m_bResume = false;
+    m_bPlanSet = false;
+    m_iRunState = RUN_IDLE;
+    m_iExitCode = 0;
+    m_pCPJ = new CrushedPrintJob;
+
+    m_pPrinter = new B9Printer(this, sName);
+    m_pController = new B9PrintController(m_pPrinter, this);
+
+    connect(m_pPrinter, SIGNAL(updateConnectionStatus(QString)), this, SLOT(onConnectionStatus(QString)));
+    connect(m_pPrinter, SIGNAL(resetFinished()), this, SLOT(onResetFinished()));
+    connect(m_pPrinter, SIGNAL(resetTimedOut()), this, SLOT(onResetTimedOut()));
+    connect(m_pController, SIGNAL(layerStatus(QString)), this, SLOT(onLayerStatus(QString)));
+    connect(m_pController, SIGNAL(printFinished()), this, SLOT(onPrintFinished()));
+    connect(m_pController, SIGNAL(printAborted(QString)), this, SLOT(onPrintAborted(QString)));
+}
+
+B9PrintRunner::~B9PrintRunner()
+{
+    delete m_pController;
+    delete m_pPrinter;
+    delete m_pCPJ;
+}
+
+bool B9PrintRunner::loadJob(QString sJobFile)
+{
+    m_pCPJ->clearAll();
+    QFile file(sJobFile);
+    if(!m_pCPJ->loadCPJ(&file)) return false;
+    m_pCPJ->showSupports(true);
+    m_sJobFile = sJobFile;
+    m_pController->setJobFile(sJobFile);
+    return true;
+}
+
+bool B9PrintRunner::setPlanFile(QString sPlanFile)
+{
+    QString sError;
+    if(!m_Plan.importPlan(sPlanFile, &sError, m_pPrinter->getComm()->getUpperZLimPU())){
+        qDebug() << qPrintable(m_sTag) << "ERROR:" << sError;
+        return false;
+    }
+    m_bPlanSet = true;
+    return true;
+}
+
+bool B9PrintRunner::usePlan()
+{
+    if(!m_bPlanSet) return true;
+    QString sError;
+    if(!m_Plan.fitsZLimit(m_pPrinter->getComm()->getUpperZLimPU(), &sError)){
+        qDebug() << qPrintable(m_sTag) << "ERROR: exposure plan rejected," << sError;
+        return false;
+    }
+    m_pController->setExposurePlan(m_Plan);
+    return true;
+}
+
+bool B9PrintRunner::exportPlan(QString sPlanFile)
+{
+    if(!computeTimes()) return false;
+    B9ExposurePlan vPlan;
+    vPlan.build(m_pPrinter, m_pCPJ, m_iTbaseMS, m_iToverMS, m_iTattachMS, m_iNumAttach, m_iLastLayer, B9ExposurePlan::toverStepMS());
+    if(!vPlan.exportPlan(sPlanFile)) return false;
+    qDebug() << qPrintable(m_sTag) << vPlan.layerCount() << "layers planned," << vPlan.totalMS()/60000.0 << "minutes, written to" << sPlanFile;
+    return true;
+}
+
+void B9PrintRunner::start()
+{
+    qDebug() << qPrintable(m_sTag) << "waiting for the B9Creator";
+    m_iRunState = RUN_CONNECTING;
+    if(m_pPrinter->isConnected()) onConnectionStatus(MSG_CONNECTED);
+}
+
+void B9PrintRunner::onConnectionStatus(QString sText)
+{
+    Q_UNUSED(sText);
+    if(m_iRunState != RUN_CONNECTING || !m_pPrinter->isConnected()) return;
+
+    int iXYPixelMicrons = m_pCPJ->getXYPixelmm()*1000;
+    if(iXYPixelMicrons != m_pPrinter->getXYPixelSize())
+        qDebug() << qPrintable(m_sTag) << "WARNING job XY pixel size" << iXYPixelMicrons << "does not agree with the printer's calibrated" << m_pPrinter->getXYPixelSize();
+
+    if(!usePlan()){
+        done(1);
+        return;
+    }
+    if(m_bResume){
+        resumePrint(); // never home, the part is on the build table
+        return;
+    }
+
+    if(m_pPrinter->getComm()->getHomeStatus() == B9PrinterStatus::HS_FOUND){
+        startPrint();
+        return;
+    }
+    qDebug() << qPrintable(m_sTag) << "finding home";
+    m_iRunState = RUN_HOMING;
+    m_pPrinter->rcResetHomePos();
+}
+
+void B9PrintRunner::onResetFinished()
+{
+    if(m_iRunState != RUN_HOMING) return;
+    startPrint();
+}
+
+void B9PrintRunner::onResetTimedOut()
+{
+    if(m_iRunState != RUN_HOMING) return;
+    qDebug() << qPrintable(m_sTag) << "ERROR: TIMEOUT attempting to locate home position.  Check connections.";
+    done(1);
+}
+
+bool B9PrintRunner::computeTimes()
+{
+    // Determine times based on thickness, as DlgPrintPrep does
+    B9MatCat* pCatalog = m_pPrinter->getMatCat();
+    QSettings settings;
+    if(m_sMaterial.isEmpty()) m_sMaterial = settings.value("CurrentMaterialLabel","B9R-1-Red").toString();
+    int indexMat = -1;
+    for(int i=0; i<pCatalog->getMaterialCount(); i++) {
+        if(m_sMaterial==pCatalog->getMaterialLabel(i)) {
+            indexMat = i;
+            break;
+        }
+    }
+    if(indexMat<0){
+        qDebug() << qPrintable(m_sTag) << "ERROR: unknown material" << m_sMaterial;
+        return false;
+    }
+    pCatalog->setCurMatIndex(indexMat);
+    pCatalog->setCurXYIndex(((int)(m_pCPJ->getXYPixelmm()*1000+0.5)-25)/25-1);
+
+    m_iTattachMS = pCatalog->getCurTattach().toDouble()*1000;
+    m_iNumAttach = pCatalog->getCurNumberAttach().toInt();
+    m_iTbaseMS = pCatalog->getCurTbaseAtZinMS(m_pCPJ->getZLayermm());
+    m_iToverMS = pCatalog->getCurToverAtZinMS(m_pCPJ->getZLayermm());
+    qDebug() << qPrintable(m_sTag) << m_pCPJ->getName() << "in" << m_sMaterial << "Tbase" << m_iTbaseMS << "Tover" << m_iToverMS << "Tattach" << m_iTattachMS << "x" << m_iNumAttach;
+    return true;
+}
+
+void B9PrintRunner::startPrint()
+{
+    if(!computeTimes()){
+        done(1);
+        return;
+    }
+    m_iRunState = RUN_PRINTING;
+    m_pPrinter->getComm()->m_bIsPrinting = true;
+    m_pController->print3D(m_pCPJ, m_iXOff, m_iYOff, m_iTbaseMS, m_iToverMS, m_iTattachMS, m_iNumAttach, m_iLastLayer, m_bPreview, m_bPreview);
+}
+
+void B9PrintRunner::resumePrint()
+{
+    B9PrintCheckpoint vCheckpoint;
+    if(!B9PrintJournal::read(m_pController->getJournalFile(), &vCheckpoint)){
+        qDebug() << qPrintable(m_sTag) << "ERROR: no print to resume in" << m_pController->getJournalFile();
+        done(1);
+        return;
+    }
+    if(QFileInfo(vCheckpoint.sJobFile).canonicalFilePath() != QFileInfo(m_sJobFile).canonicalFilePath()){
+        qDebug() << qPrintable(m_sTag) << "ERROR: the journaled print is of" << vCheckpoint.sJobFile << "not" << m_sJobFile;
+        done(1);
+        return;
+    }
+    qDebug() << qPrintable(m_sTag) << "resuming" << vCheckpoint.sState << "print after layer" << vCheckpoint.iLayer << "of" << vCheckpoint.iLastLayer;
+
+    m_iRunState = RUN_PRINTING;
+    m_pPrinter->getComm()->m_bIsPrinting = true;
+    if(!m_pController->resumePrint(m_pCPJ, vCheckpoint, m_bPreview, m_bPreview)){
+        qDebug() << qPrintable(m_sTag) << "ERROR: the journal does not match" << m_pCPJ->getName();
+        done(1);
+    }
+}
+
+void B9PrintRunner::onLayerStatus(QString sText)
+{
+    qDebug() << qPrintable(m_sTag) << sText;
+}
+
+void B9PrintRunner::onPrintFinished()
+{
+    qDebug() << qPrintable(m_sTag) << "print finished";
+    done(0);
+}
+
+void B9PrintRunner::onPrintAborted(QString sMessage)
+{
+    qDebug() << qPrintable(m_sTag) << "PRINT ABORTED" << sMessage;
+    done(1);
+}
+
+void B9PrintRunner::done(int iExitCode)
+{
+    if(m_iRunState == RUN_DONE) return;
+    m_iRunState = RUN_DONE;
+    m_iExitCode = iExitCode;
+    m_pPrinter->getComm()->m_bIsPrinting = false;
+    checkDone();
+}
+
+void B9PrintRunner::checkDone()
+{
+    // An abort still raises the build table, let that cycle finish before we go
+    if(m_pPrinter->isCycling()){
+        QTimer::singleShot(500, this, SLOT(checkDone()));
+        return;
+    }
+    emit finished(m_iExitCode);
+}
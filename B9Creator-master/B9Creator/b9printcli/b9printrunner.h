@@ -0,0 +1,119 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTRUNNER_H
+#define B9PRINTRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include "b9printer.h"
+#include "b9printcontroller.h"
+
+/******************************************************
+B9PrintRunner takes one job from the command line to the
+printer: it waits for the B9Creator, finds home if needed,
+works out the exposure times from the material catalog
+the way DlgPrintPrep does, and then lets a
+B9PrintController print it.  With setResume() it instead
+carries on from the printer's journal, without homing.
+finished(iExitCode) is emitted when there is nothing left
+to do.
+******************************************************/
+class B9PrintRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit B9PrintRunner(QObject *parent = 0, QString sName = "");
+    ~B9PrintRunner();
+
+    bool loadJob(QString sJobFile); // false if the .b9j can not be read
+    void setMaterial(QString sMaterial){m_sMaterial = sMaterial;}
+    void setOffset(int iXOff, int iYOff){m_iXOff = iXOff; m_iYOff = iYOff;}
+    void setScreen(int iScreen){m_pPrinter->setProjectorScreen(iScreen);}
+    void setPort(QString sPortName){m_pPrinter->setCommPort(sPortName);}
+    void setRenderThreads(int iThreads){m_pPrinter->setRenderThreads(iThreads);}
+    void setLastLayer(int iLastLayer){m_iLastLayer = iLastLayer;}
+    void setPrintPreview(bool bPreview){m_bPreview = bPreview;}
+    void setResume(bool bResume){m_bResume = bResume;} // continue an interrupted print of the job
+    bool setPlanFile(QString sPlanFile);   // print from an exported exposure plan, false if it can not be read or is out of range
+    bool exportPlan(QString sPlanFile);    // write the job's exposure plan without printing, from the saved printer settings
+    int getExitCode(){return m_iExitCode;} // 0 if the job printed
+
+public slots:
+    void start();
+
+signals:
+    void finished(int iExitCode);
+
+private slots:
+    void onConnectionStatus(QString sText);
+    void onResetFinished();
+    void onResetTimedOut();
+    void onLayerStatus(QString sText);
+    void onPrintFinished();
+    void onPrintAborted(QString sMessage);
+    void checkDone();
+
+private:
+    enum {RUN_IDLE, RUN_CONNECTING, RUN_HOMING, RUN_PRINTING, RUN_DONE};
+
+    bool computeTimes();
+    bool usePlan();   // hands the plan file's plan to the controller once the Z limit is known, false if it does not fit
+    void startPrint();
+    void resumePrint();
+    void done(int iExitCode);
+
+    B9Printer* m_pPrinter;
+    B9PrintController* m_pController;
+    CrushedPrintJob* m_pCPJ;
+    QString m_sJobFile;
+    QString m_sTag;   // prefix for our log lines
+    QString m_sMaterial;
+    int m_iXOff, m_iYOff;
+    int m_iLastLayer;
+    int m_iTbaseMS, m_iToverMS, m_iTattachMS, m_iNumAttach;
+    B9ExposurePlan m_Plan;
+    bool m_bPlanSet;
+    bool m_bPreview;
+    bool m_bResume;
+    int m_iRunState;
+    int m_iExitCode;
+};
+
+#endif // B9PRINTRUNNER_H
@@ -0,0 +1,141 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtGui/QApplication>
+#include <QStringList>
+#include <QTimer>
+#include "b9printrunner.h"
+#include "b9printhost.h"
+#include "b9firmwaresim.h"
+#include "b9printercomm.h"
+#include "logfilemanager.h"
+
+// b9printcli job.b9j [-material label] [-xoff pixels] [-yoff pixels] [-screen n] [-layers n] [-preview] [-resume] [-plan plan.csv] [-exportplan plan.csv] [-simulate [timescale]]
+// b9printcli -host rack.ini [-simulate [timescale]]
+// Prints one job, or one per printer in a host file (see b9printhost.h), with no control panel.
+// Only the projector windows are shown.  -resume carries on with an interrupted print of the job from the journal.
+// -plan prints from an exported exposure plan, -exportplan writes the job's plan (see B9ExposurePlan) and exits.
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+    a.setQuitOnLastWindowClosed(false);
+    QCoreApplication::setOrganizationName("B9Creations, LLC");
+    QCoreApplication::setOrganizationDomain("b9creator.com");
+    QCoreApplication::setApplicationName("B9Creator");
+    LogFileManager LogManager("b9printcli_LOG.txt", "b9printcli Log Entries");
+
+    QStringList vArgs = a.arguments();
+    QString sJobFile;
+    QString sHostFile;
+    QString sMaterial;
+    QString sPlanFile, sExportPlanFile;
+    int iXOff = 0, iYOff = 0, iScreen = -1, iLastLayer = 0;
+    bool bPreview = false;
+    bool bResume = false;
+    bool bSimulate = false;
+    double dSimScale = 1.0;
+    for(int i=1; i<vArgs.count(); i++){
+        QString sArg = vArgs[i];
+        if(sArg=="-host") sHostFile = vArgs.value(++i);
+        else if(sArg=="-material") sMaterial = vArgs.value(++i);
+        else if(sArg=="-xoff") iXOff = vArgs.value(++i).toInt();
+        else if(sArg=="-yoff") iYOff = vArgs.value(++i).toInt();
+        else if(sArg=="-screen") iScreen = vArgs.value(++i).toInt();
+        else if(sArg=="-layers") iLastLayer = vArgs.value(++i).toInt();
+        else if(sArg=="-preview") bPreview = true;
+        else if(sArg=="-resume") bResume = true;
+        else if(sArg=="-plan") sPlanFile = vArgs.value(++i);
+        else if(sArg=="-exportplan") sExportPlanFile = vArgs.value(++i);
+        else if(sArg=="-simulate"){
+            bSimulate = true;
+            bool bOk = false;
+            double dScale = vArgs.value(i+1).toDouble(&bOk);
+            if(bOk){dSimScale = dScale; i++;}
+        }
+        else if(!sArg.startsWith("-")) sJobFile = sArg;
+    }
+    if(!sHostFile.isEmpty()){
+        B9PrintHost Host;
+        if(!Host.load(sHostFile, bSimulate, dSimScale)) return 1;
+        QObject::connect(&Host, SIGNAL(finished(int)), &a, SLOT(quit()));
+        QTimer::singleShot(0, &Host, SLOT(start()));
+        a.exec();
+        return Host.getExitCode();
+    }
+    if(sJobFile.isEmpty()){
+        qWarning("usage: b9printcli job.b9j [-material label] [-xoff pixels] [-yoff pixels] [-screen n] [-layers n] [-preview] [-resume] [-plan plan.csv] [-exportplan plan.csv] [-simulate [timescale]]");
+        qWarning("       b9printcli -host rack.ini [-simulate [timescale]]");
+        return 2;
+    }
+
+    B9FirmwareSim Simulator;
+    if(bSimulate){
+        Simulator.setTimeScale(dSimScale);
+        if(Simulator.openPort()){
+            B9PrinterComm::addVirtualPort(Simulator.portName(), Simulator.timeScale());
+            Simulator.start();
+        }
+    }
+
+    B9PrintRunner Runner;
+    if(!Runner.loadJob(sJobFile)){
+        qWarning("Error Loading File.  Unknown Version?");
+        return 1;
+    }
+    Runner.setMaterial(sMaterial);
+    Runner.setOffset(iXOff, iYOff);
+    Runner.setScreen(iScreen);
+    Runner.setLastLayer(iLastLayer);
+    Runner.setPrintPreview(bPreview);
+    Runner.setResume(bResume);
+    if(!sExportPlanFile.isEmpty()){
+        int iRet = Runner.exportPlan(sExportPlanFile) ? 0 : 1;
+        if(bSimulate) Simulator.stop();
+        return iRet;
+    }
+    if(!sPlanFile.isEmpty() && !Runner.setPlanFile(sPlanFile)){
+        if(bSimulate) Simulator.stop();
+        return 1;
+    }
+    QObject::connect(&Runner, SIGNAL(finished(int)), &a, SLOT(quit()));
+    QTimer::singleShot(0, &Runner, SLOT(start()));
+
+    a.exec();
+    if(bSimulate) Simulator.stop();
+    return Runner.getExitCode();
+}
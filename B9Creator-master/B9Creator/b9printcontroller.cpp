@@ -0,0 +1,486 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtDebug>
+#include "b9printcontroller.h"
+
+B9PrintController::B9PrintController(B9Printer *pPrinter, QObject *parent) :
+    QObject(parent)
+{
+    m_pPrinter = pPrinter;
+    if(m_pPrinter == NULL) qFatal("FATAL Call to B9PrintController with null B9Printer Pointer");
+
+    m_pCPJ = NULL;
+    m_iTbase = m_iTover = 0;
+    m_iTattach = 0;
+    m_iNumAttach = 1;
+    m_iXOff = m_iYOff =0;
+    m_iPrintState = PRINT_NO;
+    m_iPaused = PAUSE_NO;
+    m_bAbort = false;
+    m_sAbortMessage = "Unknown Abort";
+    m_sPauseText = "Pause";
+    m_sAbortText = "Abort";
+    m_bPauseEnabled = m_bAbortEnabled = true;
+    m_iCurLayerNumber = 0;
+    m_dLayerThickness = 0.0;
+    m_iLastLayer = 0;
+    m_iLayersDone = 0;
+    m_iResumeLayer = 0;
+    m_iResumeZPU = -1;
+    m_iTintNum = m_iTintShown = 0;
+    m_iToverStepMS = 17;
+    m_iScheduleID = -1;
+    m_bPlanSet = false;
+    m_dExposurePlannedMS = m_dWorstJitterMS = 0.0;
+
+    m_pScheduler = new B9ExposureScheduler(this);
+    connect(m_pScheduler, SIGNAL(deadlineReached(int,int,double,double)), this, SLOT(onExposureDeadline(int,int,double,double)));
+
+    connect(m_pPrinter, SIGNAL(updateProjector(B9PrinterStatus::ProjectorStatus)), this, SLOT(onUpdateProjector(B9PrinterStatus::ProjectorStatus)));
+    connect(m_pPrinter, SIGNAL(signalAbortPrint(QString)), this, SLOT(onSignalAbortPrint(QString)));
+    connect(m_pPrinter, SIGNAL(PrintReleaseCycleFinished()), this, SLOT(exposeTBaseLayer()));
+    connect(m_pPrinter, SIGNAL(pausePrint()), this, SLOT(onPausePrint()));
+    connect(m_pPrinter, SIGNAL(sendStatusMsg(QString)),this, SLOT(setProjMessage(QString)));
+}
+
+B9PrintController::~B9PrintController()
+{
+    if(m_iPrintState != PRINT_NO) m_pPrinter->setPrintActive(false);
+}
+
+void B9PrintController::setProjMessage(QString sText)
+{
+    m_pPrinter->rcSetProjMessage(sText);
+}
+
+QString B9PrintController::updateTimes()
+{
+    QTime vTimeFinished, vTimeRemains, t;
+    int iTime = (int)(m_Plan.remainingMS(m_iCurLayerNumber)/m_pPrinter->getComm()->timeScale());
+    int iM = iTime/60000;
+    int iH = iM/60;
+    iM = (int)((double)iM+0.5) - iH*60;
+    QString sLZ = ":0"; if(iM>9)sLZ = ":";
+    QString sTimeRemaining = QString::number(iH)+sLZ+QString::number(iM);
+    t.setHMS(0,0,0); vTimeRemains = t.addMSecs(iTime);
+    vTimeFinished = QTime::currentTime().addMSecs(iTime);
+    emit timesUpdated(vTimeFinished, sTimeRemaining);
+    return "Estimated time remaining: "+sTimeRemaining+"  Estimated Completion Time: "+vTimeFinished.toString("hh:mm AP");
+}
+
+double B9PrintController::curLayerIndexMM()
+{
+    // layer "0" has zero thickness
+    return (double)m_iCurLayerNumber * m_dLayerThickness + 0.00001;
+}
+
+void B9PrintController::checkpoint(QString sState, int iZPU)
+{
+    B9PrintCheckpoint vCP;
+    vCP.sJobFile = m_sJobFile;
+    vCP.sJobName = m_pCPJ->getName();
+    vCP.iLastLayer = m_iLastLayer;
+    vCP.iLayer = m_iLayersDone;
+    vCP.iZPU = iZPU;
+    vCP.dLayerThicknessMM = m_dLayerThickness;
+    vCP.iTbase = m_iTbase; vCP.iTover = m_iTover;
+    vCP.iTattach = m_iTattach; vCP.iNumAttach = m_iNumAttach;
+    vCP.iXOff = m_iXOff; vCP.iYOff = m_iYOff;
+    vCP.sState = sState;
+    if(sState=="Aborted") vCP.sNote = m_sAbortMessage;
+    m_Journal.write(vCP);
+}
+
+void B9PrintController::finishAbort()
+{
+    if(m_iPrintState!=PRINT_ABORT) return;
+    m_iPrintState=PRINT_NO;
+    m_Telemetry.finishPrint("Aborted, "+m_sAbortMessage);
+    m_pPrinter->rcCancelPreRender();
+
+    // Handle Abort Signals Here
+    int iZPU;
+    if(m_sAbortMessage.contains("Jammed Mechanism")){
+        m_pPrinter->rcProjectorPwr(false); // Don't try to release if possibly jammed!
+        iZPU = m_pPrinter->getComm()->getCurZPosInPU();
+    }
+    else {
+        m_pPrinter->rcFinishPrint(5); //Finish at current z position + 5 mm, turn Projector Off
+        iZPU = m_pPrinter->getTgtAltitudePU();
+    }
+    // Leave a checkpoint where the table is heading if there is anything on it to resume
+    if(m_iLayersDone>0)
+        checkpoint("Aborted", iZPU);
+    else
+        m_Journal.clear();
+
+    m_pPrinter->onScreenCountChanged(); // toggles off the screen if needed for primary monitor setups
+    m_pPrinter->setUsePrimaryMonitor(false);
+    m_pPrinter->setPrintPreview(false);
+    m_pPrinter->setPrintActive(false);
+    m_pPrinter->onScreenCountChanged();
+    emit printAborted(m_sAbortMessage);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void B9PrintController::print3D(CrushedPrintJob* pCPJ, int iXOff, int iYOff, int iTbase, int iTover, int iTattach, int iNumAttach, int iLastLayer, bool bPrintPreview, bool bUsePrimaryMonitor)
+{
+    // Note if, iLastLayer < 1, print ALL layers.
+    // if bPrintPreview, run without turning on the projector
+    startPrint(pCPJ, iXOff, iYOff, iTbase, iTover, iTattach, iNumAttach, iLastLayer, bPrintPreview, bUsePrimaryMonitor, 0, -1);
+}
+
+bool B9PrintController::resumePrint(CrushedPrintJob *pCPJ, B9PrintCheckpoint vCheckpoint, bool bPrintPreview, bool bUsePrimaryMonitor)
+{
+    if(!vCheckpoint.isValid() || vCheckpoint.iLastLayer>pCPJ->getTotalLayers() ||
+       qAbs(vCheckpoint.dLayerThicknessMM-pCPJ->getZLayer().toDouble())>0.000001){
+        qDebug() << "Print Controller:  Checkpoint does not match" << pCPJ->getName() << ", not resuming";
+        return false;
+    }
+    qDebug() << "Print Controller:  Resuming" << pCPJ->getName() << "at layer" << vCheckpoint.iLayer+1 << "of" << vCheckpoint.iLastLayer << "from Z" << vCheckpoint.iZPU << "PU";
+    startPrint(pCPJ, vCheckpoint.iXOff, vCheckpoint.iYOff, vCheckpoint.iTbase, vCheckpoint.iTover, vCheckpoint.iTattach, vCheckpoint.iNumAttach,
+               vCheckpoint.iLastLayer, bPrintPreview, bUsePrimaryMonitor, vCheckpoint.iLayer, vCheckpoint.iZPU);
+    return true;
+}
+
+void B9PrintController::startPrint(CrushedPrintJob* pCPJ, int iXOff, int iYOff, int iTbase, int iTover, int iTattach, int iNumAttach, int iLastLayer, bool bPrintPreview, bool bUsePrimaryMonitor, int iResumeLayer, int iResumeZPU)
+{
+    // Tover is stepped at about the display refresh rate, late steps are merged by the scheduler slot
+    m_iToverStepMS = B9ExposurePlan::toverStepMS();
+
+    m_iPrintState = PRINT_NO;
+    m_pPrinter->setPrintActive(true);
+    m_pCPJ = pCPJ;
+    m_pPrinter->createNormalizedMask(m_pCPJ->getXYPixelmm());
+    m_iTbase = iTbase; m_iTover = iTover; m_iTattach = iTattach; m_iNumAttach = iNumAttach;
+    m_iXOff = iXOff; m_iYOff = iYOff;
+    m_pPrinter->setProjectorOffset(m_iXOff, m_iYOff);
+    m_iResumeLayer = iResumeLayer; m_iResumeZPU = iResumeZPU;
+    if(m_iResumeLayer<0) m_iResumeLayer = 0;
+    m_iCurLayerNumber = m_iLayersDone = m_iResumeLayer;
+    m_dLayerThickness = m_pCPJ->getZLayer().toDouble();
+    m_iPaused = PAUSE_NO;
+    m_bAbort = false;
+    m_iLastLayer = iLastLayer;
+    if(m_iLastLayer<1)m_iLastLayer = m_pCPJ->getTotalLayers();
+    if(m_bPlanSet && m_Plan.matches(m_pCPJ, m_iLastLayer))
+        qDebug() << "Print Controller:  Printing from the imported exposure plan";
+    else {
+        if(m_bPlanSet) qDebug() << "Print Controller:  Imported exposure plan does not fit" << m_pCPJ->getName() << ", building one";
+        m_Plan.build(m_pPrinter, m_pCPJ, m_iTbase, m_iTover, m_iTattach, m_iNumAttach, m_iLastLayer, m_iToverStepMS);
+    }
+    m_bPlanSet = false;
+    m_Journal.setFileName(getJournalFile());
+    if(m_iResumeLayer<1) m_Journal.clear(); // a new print, the old checkpoint no longer describes what's on the table
+    QString sTimingFile = "B9Creator_PrintTiming.csv";
+    if(!m_pPrinter->getName().isEmpty()) sTimingFile = "B9Creator_PrintTiming_"+m_pPrinter->getName()+".csv";
+    m_Telemetry.startPrint(m_pCPJ->getName(), m_iLastLayer, sTimingFile);
+
+    m_pPrinter->setUsePrimaryMonitor(bUsePrimaryMonitor);
+    m_pPrinter->setPrintPreview(bPrintPreview);
+    m_pPrinter->onScreenCountChanged();
+
+    // Use the projector warm up and Z homing to render every layer's frame ahead of time
+    if(m_vSettings.value("PreRenderFrames",true).toBool())
+        m_pPrinter->rcPreRenderFrames(m_pCPJ, m_iLastLayer, m_iResumeLayer);
+
+    emit progress(m_iCurLayerNumber, m_iLastLayer);
+    emit layerStatus("Total Layers To Print: "+QString::number(m_iLastLayer)+"  Powering up the projector.");
+
+    QString sTimeUpdate = updateTimes();
+    setProjMessage("Total Layers to print: "+QString::number(m_iLastLayer)+"  "+sTimeUpdate);
+
+    setPauseResume("Pause", true);
+    setAbort("Abort", true);
+    if(!bPrintPreview){
+        // Turn on the projector and set the warm up time in ms
+        setPauseResume(false);
+        setAbort(false);
+        m_pPrinter->rcSetWarmUpDelay(20000);
+        m_pPrinter->rcProjectorPwr(true);
+    }
+    else {
+        emit projectorStatus("OFF:  'Print Preview' Mode");
+        startMotion();
+    }
+}
+
+void B9PrintController::startMotion()
+{
+    if(m_iResumeLayer<1){
+        m_iPrintState = PRINT_SETUP1;
+        m_pPrinter->rcBasePrint(-m_pPrinter->getHardZDownMM()); // Dynamic Z Zero, overshoot zero until we are down hard and motor 'skips'
+        return;
+    }
+
+    // Resuming with the part still on the build table, we can't seek Z zero without crushing it into the vat.
+    // If the printer has lost its position, take the journaled one as current and cycle to the next layer from there.
+    if(m_pPrinter->getComm()->getHomeStatus() != B9PrinterStatus::HS_FOUND)
+        m_pPrinter->rcResetCurrentPositionPU(m_iResumeZPU);
+    m_pPrinter->rcSetNextCycle(m_Plan.layer(m_iCurLayerNumber).vCycle);
+    m_pPrinter->rcNextPrintPU(m_Plan.layer(m_iCurLayerNumber).iTgtPU); // the plan's Z, it may have been edited
+    m_Telemetry.releaseStarted(m_iCurLayerNumber, curLayerIndexMM());
+    m_iPrintState = PRINT_RELEASING;
+    emit layerStatus("Resuming, repositioning to layer "+QString::number(m_iCurLayerNumber+1));
+}
+
+void B9PrintController::onUpdateProjector(B9PrinterStatus::ProjectorStatus eStatus)
+{
+    if(m_iPrintState==PRINT_NO && m_pPrinter->isPrintActive() && eStatus==B9PrinterStatus::PS_ON){
+        // Projector is warmed up and on!
+        setPauseResume(true); // Enable pause/resume & abort now
+        setAbort(true);
+        startMotion();
+    }
+}
+
+void B9PrintController::pauseResume()
+{
+    if(m_iPrintState == PRINT_NO) return; // not printing yet.
+
+    if(m_iPaused==PAUSE_YES){
+        // Time to Resume...
+        m_iPaused = PAUSE_NO;
+        setPauseResume("Pause", m_bPauseEnabled);
+        setAbort(true);
+        exposureOfTOverLayersFinished();
+    }
+    else if(m_iPaused==PAUSE_NO){
+        // Time to Pause....
+        m_iPaused = PAUSE_WAIT;
+        setPauseResume("Pausing...", false);
+        setAbort(false);
+        setProjMessage("Pausing...");
+    }
+}
+
+void B9PrintController::abort(QString sAbortText)
+{
+    m_sAbortMessage = sAbortText;
+    if(m_sAbortMessage.contains("Jammed Mechanism")||m_sAbortMessage.contains("Lost Printer Connection")||
+       (m_sAbortMessage.contains("Projector"))){
+        // Special cases, always handle it asap.
+        m_pScheduler->cancel();
+        m_pPrinter->rcSetCPJ(NULL); //blank
+        setAbort("Abort", m_bAbortEnabled);
+        m_iPrintState = PRINT_ABORT;
+        finishAbort();
+        return;
+    }
+
+    if(m_iPrintState == PRINT_NO||m_iPrintState == PRINT_ABORT||m_iPaused==PAUSE_WAIT) return; // no abort if pausing, not printing or already aborting
+    setAbort("Aborting...", false);
+    emit layerStatus("Aborting...");
+    setPauseResume(false);
+    setProjMessage("Aborting...");
+    m_bAbort = true;
+    if(m_iPaused==PAUSE_YES) pauseResume();
+}
+
+void B9PrintController::setSlice(int iSlice)
+{
+    if(m_iLastLayer<1)
+        m_pPrinter->rcSetCPJ(NULL);
+    else {
+        m_pCPJ->setCurrentSlice(iSlice);
+        m_pPrinter->rcSetCPJ(m_pCPJ);
+    }
+}
+
+void B9PrintController::exposeTBaseLayer(){
+    //Release & reposition cycle completed, time to expose the new layer
+    if(m_iPrintState==PRINT_NO || m_iPrintState == PRINT_ABORT)return;
+
+    if(m_iPrintState==PRINT_SETUP1){
+        //We've used -  getHardZDownMM()to overshoot and get to here,
+        // now reset current position to 0 and move up to + getZFlushMM
+        m_pPrinter->rcResetCurrentPositionPU(0);
+        m_pPrinter->rcBasePrint(m_pPrinter->getZFlushMM());
+        m_Telemetry.releaseStarted(0, 0.0); // The flush move stands in for layer 0's release
+        m_iPrintState = PRINT_SETUP2;
+        return;
+    }
+
+    if(m_iPrintState==PRINT_SETUP2){
+        //We should now be flush
+        // reset current position 0 and continue
+        m_pPrinter->rcResetCurrentPositionPU(0);
+        m_iPrintState = PRINT_RELEASING;
+    }
+
+    if(m_iPrintState == PRINT_DONE){
+        m_iPrintState=PRINT_NO;
+        m_Telemetry.finishPrint("Finished");
+        m_Journal.clear();
+        m_pPrinter->rcCancelPreRender();
+        m_pPrinter->setPrintActive(false);
+        if(m_pPrinter->getPrintPreview()){
+            m_pPrinter->setPrintPreview(false);
+            m_pPrinter->setUsePrimaryMonitor(false);
+        }
+        m_pPrinter->onScreenCountChanged();
+        emit printFinished();
+        return;
+    }
+
+    if(m_bAbort){
+        // We're done, release and raise
+        m_pPrinter->rcSetCPJ(NULL); //blank
+        setAbort("Abort", m_bAbortEnabled);
+        m_iPrintState = PRINT_ABORT;
+        finishAbort();
+        return;
+    }
+
+    //Start Tbase Print exposure
+    m_Telemetry.releaseFinished(m_pPrinter->getLastCycleMS(), m_pPrinter->getLastCycleEstMS());
+    emit progress(m_iCurLayerNumber+1, m_iLastLayer);
+    emit layerStatus("Creating Layer "+QString::number(m_iCurLayerNumber+1)+" of "+QString::number(m_iLastLayer)+",  "+QString::number(100.0*(double)(m_iCurLayerNumber+1)/(double)m_iLastLayer,'f',1)+"% Complete");
+    setSlice(m_iCurLayerNumber);
+    QString sTimeUpdate = updateTimes();
+    if(m_iPaused==PAUSE_WAIT){
+        emit layerStatus("Pausing...");
+        setProjMessage("Pausing...");
+    }
+    else{
+        setProjMessage("(Press'p' to pause, 'A' to ABORT)  " + sTimeUpdate+"  Creating Layer "+QString::number(m_iCurLayerNumber+1)+" of "+QString::number(m_iLastLayer));
+    }
+    m_iPrintState = PRINT_EXPOSING;
+
+    // This layer's deadlines from the plan, the first is the end of Tbase and the rest step through Tover
+    QList<double> vDeadlines = m_Plan.deadlines(m_iCurLayerNumber);
+    double dTimeScale = m_pPrinter->getComm()->timeScale(); // a simulated printer exposes as fast as it moves
+    if(dTimeScale!=1.0)
+        for(int i=0; i<vDeadlines.count(); i++) vDeadlines[i] /= dTimeScale;
+    m_iTintNum = m_Plan.layer(m_iCurLayerNumber).iToverSteps;
+    m_dExposurePlannedMS = vDeadlines.last();
+    m_dWorstJitterMS = 0.0;
+    m_iTintShown = 0;
+    m_Telemetry.exposureStarted();
+    m_iScheduleID = m_pScheduler->startSchedule(vDeadlines); // image is out there, start the clock running!
+
+    // The printer is idle while we expose, give it the next release cycle's parameters now so only the 'N' is left for after
+    if(m_iCurLayerNumber+1 < m_iLastLayer)
+        m_pPrinter->rcSendNextCycle(m_Plan.layer(m_iCurLayerNumber+1).vCycle);
+}
+
+void B9PrintController::onExposureDeadline(int iSchedule, int iIndex, double dPlannedMS, double dActualMS)
+{
+    Q_UNUSED(dActualMS);
+    if(iSchedule!=m_iScheduleID || m_iPrintState!=PRINT_EXPOSING) return; // stale signal from a cancelled schedule
+
+    // Timing as seen by the projector, includes any delay getting through our event loop
+    double dJitterMS = m_pScheduler->elapsedMS() - dPlannedMS;
+    if(dJitterMS > m_dWorstJitterMS) m_dWorstJitterMS = dJitterMS;
+
+    // If we fell behind, later deadlines are already queued.  Clearing to the latest level covers the ones we skip.
+    if(iIndex < m_pScheduler->lastFiredIndex() && iIndex < m_iTintNum) return;
+
+    if(m_iTintNum<1){
+        finishLayerExposure();
+        return;
+    }
+
+    // Turn off the pixels at the curent point
+    m_iTintShown++;
+    if(m_pPrinter->rcClearTimedPixels((double)iIndex*255.0/(double)m_iTintNum) || iIndex>=m_iTintNum)
+        finishLayerExposure();  // We're done with Tover
+}
+
+void B9PrintController::finishLayerExposure()
+{
+    m_pScheduler->cancel();
+    double dActualMS = m_pScheduler->elapsedMS();
+    if(dActualMS - m_dExposurePlannedMS > m_iToverStepMS)
+        qDebug() << "EXPOSURE TIMING ERROR:  Layer" << m_iCurLayerNumber << "exposed for" << dActualMS << "ms, planned" << m_dExposurePlannedMS << "ms.  Computer too slow?";
+    qDebug() << "Layer" << m_iCurLayerNumber << "exposure planned" << m_dExposurePlannedMS << "ms, actual" << dActualMS << "ms, worst step jitter" << m_dWorstJitterMS << "ms," << m_iTintNum << "Tover steps";
+    m_Telemetry.exposureFinished(m_dExposurePlannedMS, dActualMS, m_dWorstJitterMS, m_iTintNum, m_iTintShown, m_pPrinter->getProjectorFrameTiming());
+    m_pPrinter->rcDropFrame(m_iCurLayerNumber);
+    m_iLayersDone = m_iCurLayerNumber+1;
+    exposureOfTOverLayersFinished();
+}
+
+void B9PrintController::exposureOfTOverLayersFinished(){
+    if(m_iPrintState==PRINT_NO)return;
+
+    m_pPrinter->rcSetCPJ(NULL); //blank
+    //Cycle to next layer or finish
+    if(m_iPaused==PAUSE_WAIT){
+        m_iPaused=PAUSE_YES;
+        m_pPrinter->rcSTOP();
+        m_pPrinter->rcCloseVat();
+        setPauseResume("Resume", true);
+        setAbort(true);
+        emit layerStatus("Paused.  Manual positioning toggle switches are enabled.");
+        m_pPrinter->rcSetProjMessage(" Paused.  Manual toggle switches are enabled.  Press 'p' when to resume printing, 'A' to abort.");
+        return;
+    }
+
+    if(m_bAbort){
+        // We're done
+        m_pPrinter->rcSetCPJ(NULL); //blank
+        setAbort("Abort", m_bAbortEnabled);
+        m_iPrintState = PRINT_ABORT;
+        finishAbort();
+        return;
+    }
+    else if(m_iCurLayerNumber==m_iLastLayer-1){
+        // We're done, release and raise
+        setAbort(false);
+        setPauseResume(false);
+        m_iPrintState=PRINT_DONE;
+        m_pPrinter->rcFinishPrint(25.4); //Finish at current z position + 25.4 mm, turn Projector Off
+        emit layerStatus("Finished!");
+        setProjMessage("Finished!");
+        return;
+    }
+    else
+    {
+        // do next layer
+        m_iCurLayerNumber++;  // set the next layer number
+        m_pPrinter->rcSetNextCycle(m_Plan.layer(m_iCurLayerNumber).vCycle); // planned from the size of the layer it releases
+        m_pPrinter->rcNextPrintPU(m_Plan.layer(m_iCurLayerNumber).iTgtPU); // the plan's Z, it may have been edited
+        m_Telemetry.releaseStarted(m_iCurLayerNumber, curLayerIndexMM());
+        checkpoint("Printing", m_pPrinter->getTgtAltitudePU()); // synced to disk while the table cycles
+        m_iPrintState = PRINT_RELEASING;
+        emit layerStatus("Releasing Layer "+QString::number(m_iCurLayerNumber)+", repositioning to layer "+QString::number(m_iCurLayerNumber+1));
+        QString sTimeUpdate = updateTimes();
+        setProjMessage("(Press'p' to pause, 'A' to ABORT)  " + sTimeUpdate+"  Release and cycle to Layer "+QString::number(m_iCurLayerNumber+1)+" of "+QString::number(m_iLastLayer));
+     }
+}
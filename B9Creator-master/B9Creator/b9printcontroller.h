@@ -0,0 +1,150 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTCONTROLLER_H
+#define B9PRINTCONTROLLER_H
+
+#include <QObject>
+#include <QTime>
+#include <QSettings>
+#include "b9printer.h"
+#include "b9exposurescheduler.h"
+#include "b9printtelemetry.h"
+#include "b9printjournal.h"
+#include "b9exposureplan.h"
+
+/******************************************************
+B9PrintController runs a print job on a B9Printer: the
+layer by layer release / expose state machine, pause,
+resume and abort.  It has no widgets, a view (B9Print or
+the command line runner) follows it through its signals.
+Every layer is checkpointed in a B9PrintJournal so an
+interrupted print can be resumed with resumePrint().
+******************************************************/
+class B9PrintController : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit B9PrintController(B9Printer *pPrinter, QObject *parent = 0);
+    ~B9PrintController();
+
+    B9Printer* getPrinter(){return m_pPrinter;}
+    bool isPrinting(){return m_iPrintState != PRINT_NO;}
+    bool isPaused(){return m_iPaused == PAUSE_YES;}
+    int getCurLayer(){return m_iCurLayerNumber;}
+    int getLastLayer(){return m_iLastLayer;}
+    void setJobFile(QString sJobFile){m_sJobFile = sJobFile;} // recorded in the journal
+    QString getJournalFile(){return B9PrintJournal::defaultFileName(m_pPrinter->getName());}
+    void setExposurePlan(const B9ExposurePlan &vPlan){m_Plan = vPlan; m_bPlanSet = true;} // print the next job from this plan instead of building one
+    B9ExposurePlan* getExposurePlan(){return &m_Plan;}
+
+    // Continue an interrupted print of pCPJ from vCheckpoint, false if the checkpoint is not for this job
+    bool resumePrint(CrushedPrintJob *pCPJ, B9PrintCheckpoint vCheckpoint, bool bPrintPreview = false, bool bUsePrimaryMonitor = false);
+
+public slots:
+    // If PrintPreview we do not power up the projector.  If UsePrimaryMonitor we force the output to the primary monitor
+    void print3D(CrushedPrintJob *pCPJ, int iXOff, int iYOff, int iTbase, int iTover, int iTattach, int iNumAttach = 1, int iLastLayer = 0, bool bPrintPreview = false, bool bUsePrimaryMonitor = false);
+    void pauseResume();
+    void abort(QString sAbortText = "User Directed Abort.");
+    void setProjMessage(QString sText);
+    QString updateTimes();
+
+signals:
+    void layerStatus(QString sText);            // what the print is doing now
+    void progress(int iLayers, int iTotalLayers);
+    void timesUpdated(QTime vTimeFinished, QString sTimeRemaining);
+    void pauseResumeChanged(QString sText, bool bEnabled);
+    void abortChanged(QString sText, bool bEnabled);
+    void projectorStatus(QString sText);        // status not reported by the printer, e.g. print preview
+    void printFinished();
+    void printAborted(QString sMessage);
+
+private slots:
+    void onUpdateProjector(B9PrinterStatus::ProjectorStatus eStatus);
+    void onSignalAbortPrint(QString sAbortText){abort(sAbortText);}
+    void onPausePrint(){pauseResume();}
+
+    void exposeTBaseLayer();
+    void onExposureDeadline(int iSchedule, int iIndex, double dPlannedMS, double dActualMS);
+    void exposureOfTOverLayersFinished();
+
+private:
+    enum {PRINT_NO, PRINT_SETUP1, PRINT_SETUP2, PRINT_RELEASING, PRINT_EXPOSING, PRINT_ABORT, PRINT_DONE};
+    enum {PAUSE_NO, PAUSE_WAIT, PAUSE_YES};
+
+    void startPrint(CrushedPrintJob *pCPJ, int iXOff, int iYOff, int iTbase, int iTover, int iTattach, int iNumAttach, int iLastLayer, bool bPrintPreview, bool bUsePrimaryMonitor, int iResumeLayer, int iResumeZPU);
+    void startMotion();
+    void checkpoint(QString sState, int iZPU);
+    double curLayerIndexMM();
+    void setSlice(int iSlice);
+    void finishLayerExposure();
+    void finishAbort();
+    void setPauseResume(QString sText, bool bEnabled){m_sPauseText = sText; m_bPauseEnabled = bEnabled; emit pauseResumeChanged(m_sPauseText, m_bPauseEnabled);}
+    void setPauseResume(bool bEnabled){setPauseResume(m_sPauseText, bEnabled);}
+    void setAbort(QString sText, bool bEnabled){m_sAbortText = sText; m_bAbortEnabled = bEnabled; emit abortChanged(m_sAbortText, m_bAbortEnabled);}
+    void setAbort(bool bEnabled){setAbort(m_sAbortText, bEnabled);}
+
+    B9Printer* m_pPrinter;
+    CrushedPrintJob* m_pCPJ;
+    int m_iTbase,  m_iTover, m_iTattach, m_iNumAttach;
+    int m_iXOff, m_iYOff;
+    int m_iPrintState;
+    int m_iCurLayerNumber;
+    int m_iLastLayer;
+    int m_iLayersDone;
+    int m_iResumeLayer, m_iResumeZPU;
+    double m_dLayerThickness;
+    int m_iPaused;
+    bool m_bAbort;
+    QString m_sAbortMessage;
+    QString m_sPauseText, m_sAbortText;
+    bool m_bPauseEnabled, m_bAbortEnabled;
+    int m_iTintNum, m_iTintShown, m_iToverStepMS;
+    B9ExposureScheduler* m_pScheduler;
+    int m_iScheduleID;
+    double m_dExposurePlannedMS, m_dWorstJitterMS;
+    B9PrintTelemetry m_Telemetry;
+    B9ExposurePlan m_Plan;
+    bool m_bPlanSet;
+    B9PrintJournal m_Journal;
+    QString m_sJobFile;
+    QSettings m_vSettings;
+};
+
+#endif // B9PRINTCONTROLLER_H
@@ -0,0 +1,826 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QtDebug>
+#include <QApplication>
+#include <QSettings>
+#include "b9printer.h"
+
+void PCycleSettings::loadSettings()
+{
+    QSettings settings;
+    if(!m_sGroup.isEmpty()) settings.beginGroup(m_sGroup);
+    m_iRSpd1 = settings.value("RSpd1",85).toInt();
+    m_iLSpd1 = settings.value("LSpd1",85).toInt();
+    m_iCloseSpd1 = settings.value("CloseSpd1",100).toInt();
+    m_iOpenSpd1 = settings.value("OpenSpd1",25).toInt();
+    m_dBreatheClosed1 = settings.value("BreatheClosed1",1).toDouble();
+    m_dSettleOpen1 = settings.value("SettleOpen1",1).toDouble();
+    m_dOverLift1 = settings.value("OverLift1",3).toDouble();
+
+    m_iRSpd2 = settings.value("RSpd2",85).toInt();
+    m_iLSpd2 = settings.value("LSpd2",85).toInt();
+    m_iCloseSpd2 = settings.value("CloseSpd2",100).toInt();
+    m_iOpenSpd2 = settings.value("OpenSpd2",100).toInt();
+    m_dBreatheClosed2 = settings.value("BreatheClosed2",0).toDouble();
+    m_dSettleOpen2 = settings.value("SettleOpen2",0).toDouble();
+    m_dOverLift2 = settings.value("OverLift2",0).toDouble();
+
+    m_dBTClearInMM = settings.value("BTClearInMM",5.0).toDouble();
+
+    m_dHardZDownMM = settings.value("HardDownZMM",0.9525).toDouble();
+    m_dZFlushMM    = settings.value("ZFlushMM",   0.7620).toDouble();
+
+    m_CycleModel.loadSettings(&settings);
+    m_CyclePlanner.loadSettings(&settings);
+}
+
+void PCycleSettings::saveSettings()
+{
+    QSettings settings;
+    if(!m_sGroup.isEmpty()) settings.beginGroup(m_sGroup);
+    settings.setValue("RSpd1",m_iRSpd1);
+    settings.setValue("LSpd1",m_iLSpd1);
+    settings.setValue("CloseSpd1",m_iCloseSpd1);
+    settings.setValue("OpenSpd1",m_iOpenSpd1);
+    settings.setValue("BreatheClosed1",m_dBreatheClosed1);
+    settings.setValue("SettleOpen1",m_dSettleOpen1);
+    settings.setValue("OverLift1",m_dOverLift1);
+
+    settings.setValue("RSpd2",m_iRSpd2);
+    settings.setValue("LSpd2",m_iLSpd2);
+    settings.setValue("CloseSpd2",m_iCloseSpd2);
+    settings.setValue("OpenSpd2",m_iOpenSpd2);
+    settings.setValue("BreatheClosed2",m_dBreatheClosed2);
+    settings.setValue("SettleOpen2",m_dSettleOpen2);
+    settings.setValue("OverLift2",m_dOverLift2);
+
+    settings.setValue("BTClearInMM",m_dBTClearInMM);
+
+    settings.setValue("HardDownZMM",m_dHardZDownMM);
+    settings.setValue("ZFlushMM",   m_dZFlushMM   );
+
+    m_CycleModel.saveSettings(&settings);
+    m_CyclePlanner.saveSettings(&settings);
+}
+
+void PCycleSettings::saveCycleModel()
+{
+    QSettings settings;
+    if(!m_sGroup.isEmpty()) settings.beginGroup(m_sGroup);
+    m_CycleModel.saveSettings(&settings);
+}
+
+void PCycleSettings::setFactorySettings()
+{
+    m_iRSpd1 = m_iLSpd1 = 85;
+    m_iRSpd2 = m_iLSpd2 = 85;
+    m_iOpenSpd1 = 25;
+    m_iCloseSpd1 = 100;
+    m_iOpenSpd2 = m_iCloseSpd2 = 100;
+    m_dBreatheClosed1 = 1.0;
+    m_dSettleOpen1 = 3.0;
+    m_dBreatheClosed2 = 0.0;
+    m_dSettleOpen2 = 0.5;
+    m_dOverLift1 = 3.0;
+    m_dOverLift2 = 0.0;
+    m_dBTClearInMM = 5.0;
+    m_dHardZDownMM = 0.9525;
+    m_dZFlushMM = 0.7620;
+    m_CyclePlanner.setFactoryCurve();
+    m_CyclePlanner.setEnabled(false);
+}
+
+B9Printer::B9Printer(QObject *parent, QString sName) :
+    QObject(parent)
+{
+    m_sName = sName;
+    m_iFillLevel = -1;
+    m_iTgtPU = 0;
+    m_iLastCycleEstMS = m_iLastCycleMS = -1;
+    m_bLayerPlanned = false;
+    m_bPrintActive = false;
+    m_bNeedsWarned = true;
+
+    m_pCatalog = new B9MatCat(this);
+    m_pCatalog->load("B9C1");
+
+    pSettings = new PCycleSettings(m_sName.isEmpty() ? QString() : "Printer_"+m_sName);
+    resetLastSentCycleSettings();
+
+    // Always set up the B9PrinterComm in the constructor
+    pPrinterComm = new B9PrinterComm;
+    pPrinterComm->enableBlankCloning(true); // Allow for firmware update of suspected "blank" B9Creator Arduino's
+
+    // The B9Projector is created once we know which screen it is on
+    m_pDesktop = QApplication::desktop();
+    pProjector = NULL;
+    m_pFrameCache = new B9FrameCache(this);
+    m_iProjectorScreen = -1;
+    m_iXOff = m_iYOff = 0;
+    m_bPrimaryScreen = false;
+    m_bPrintPreview = false;
+    m_bUsePrimaryMonitor = false;
+
+    connect(m_pDesktop, SIGNAL(screenCountChanged(int)),this, SLOT(onScreenCountChanged(int)));
+
+    connect(pPrinterComm,SIGNAL(updateConnectionStatus(QString)), this, SIGNAL(updateConnectionStatus(QString)));
+    connect(pPrinterComm,SIGNAL(BC_LostCOMM()),this,SLOT(onBC_LostCOMM()));
+    connect(pPrinterComm,SIGNAL(BC_ModelInfo(QString)),this,SLOT(onBC_ModelInfo(QString)));
+    connect(pPrinterComm,SIGNAL(BC_ProjectorStatusChanged()), this, SLOT(onBC_ProjStatusChanged()));
+    connect(pPrinterComm,SIGNAL(BC_ProjectorFAIL()), this, SLOT(onBC_ProjStatusFAIL()));
+    connect(pPrinterComm, SIGNAL(BC_NativeY(int)), this, SLOT(onBC_NativeY(int)));
+
+    m_pResetTimer = new QTimer(this);
+    connect(m_pResetTimer, SIGNAL(timeout()), this, SLOT(onMotionResetTimeout()));
+    connect(pPrinterComm, SIGNAL(BC_HomeFound()), this, SLOT(onMotionResetComplete()));
+
+    m_pVatTimer = new QTimer(this);
+    connect(m_pVatTimer, SIGNAL(timeout()), this, SLOT(onMotionVatTimeout()));
+    connect(pPrinterComm, SIGNAL(BC_CurrentVatPercentOpen(int)), this, SLOT(onBC_CurrentVatPercentOpen(int)));
+
+    m_pPReleaseCycleTimer = new QTimer(this);
+    connect(m_pPReleaseCycleTimer, SIGNAL(timeout()), this, SLOT(onReleaseCycleTimeout()));
+    connect(pPrinterComm, SIGNAL(BC_PrintReleaseCycleFinished()), this, SLOT(onBC_PrintReleaseCycleFinished()));
+}
+
+B9Printer::~B9Printer()
+{
+    m_pFrameCache->cancel(); // workers may still be reading a print job
+    delete pProjector;
+    delete pPrinterComm;
+    delete pSettings;
+}
+
+void B9Printer::resetLastSentCycleSettings(){
+    m_iD=m_iE=m_iJ=m_iK=m_iL=m_iW=m_iX = -1;
+}
+
+void B9Printer::makeProjectorConnections()
+{
+    // should be called any time we create a new projector object
+    if(pProjector==NULL)return;
+    connect(pProjector, SIGNAL(keyReleased(int)),this, SLOT(getKey(int)));
+    connect(this, SIGNAL(sendStatusMsg(QString)),pProjector, SLOT(setStatusMsg(QString)));
+    connect(this, SIGNAL(sendGrid(bool)),pProjector, SLOT(setShowGrid(bool)));
+    connect(this, SIGNAL(sendCPJ(CrushedPrintJob*)),pProjector, SLOT(setCPJ(CrushedPrintJob*)));
+    connect(this, SIGNAL(sendXoff(int)),pProjector, SLOT(setXoff(int)));
+    connect(this, SIGNAL(sendYoff(int)),pProjector, SLOT(setYoff(int)));
+    pProjector->setXoff(m_iXOff);
+    pProjector->setYoff(m_iYOff);
+    pProjector->setFrameCache(m_pFrameCache);
+}
+
+void B9Printer::getKey(int iKey)
+{
+    emit projectorKey(iKey);
+    if(!m_bPrimaryScreen)return; // Ignore keystrokes from the print window unless we're using the primary monitor
+    switch(iKey){
+    case 112:		// 'p' Pause/Resume
+        emit pausePrint();
+        break;
+    case 65:        // Capital 'A' to abort
+        if(m_bPrintActive){
+            m_pPReleaseCycleTimer->stop();
+            emit signalAbortPrint("User Directed Abort.");
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void B9Printer::warnSingleMonitor(){
+    if(m_bPrimaryScreen && m_bNeedsWarned){
+        m_bNeedsWarned = false;
+        emit singleMonitorWarning();
+    }
+}
+
+void B9Printer::onBC_LostCOMM(){
+    //Broadcast an alert
+    if(m_bPrintActive)emit signalAbortPrint("ERROR: Lost Printer Connection.  Possible reasons: Power Loss, USB cord unplugged.");
+    qDebug() << "BC_LostCOMM signal received.";
+}
+
+void B9Printer::onBC_ModelInfo(QString sModel){
+    m_pCatalog->load(sModel);
+    resetLastSentCycleSettings();
+}
+
+void B9Printer::onBC_NativeY(int iNY){
+    Q_UNUSED(iNY);
+    if(pProjector == NULL) onScreenCountChanged();
+}
+
+void B9Printer::rcProjectorPwr(bool bPwrOn){
+    // Commanded projector power setting has changed
+    emit projectorPowerCmd(bPwrOn);
+    pPrinterComm->cmdProjectorPowerOn(bPwrOn);
+    pPrinterComm->setProjectorPowerCmd(bPwrOn);
+
+    // if m_bPrimaryScreen is true, we need to show it before turning on projector!
+    if(m_bPrimaryScreen) onScreenCountChanged();
+    emit sendStatusMsg("B9Creator - Projector status: TURN ON");
+
+    // We always close the vat when powering up
+    if(bPwrOn){
+        m_pVatTimer->stop();
+        rcCloseVat();
+    }
+}
+
+void B9Printer::onBC_ProjStatusFAIL()
+{
+    onBC_ProjStatusChanged();
+    rcProjectorPwr(pPrinterComm->isProjectorPowerCmdOn());
+}
+
+void B9Printer::onBC_ProjStatusChanged()
+{
+    QString sText = "UNKNOWN";
+    switch (pPrinterComm->getProjectorStatus()){
+    case B9PrinterStatus::PS_OFF:
+        sText = "OFF";
+        break;
+    case B9PrinterStatus::PS_TURNINGON:
+        sText = "TURN ON";
+        break;
+    case B9PrinterStatus::PS_WARMING:
+        sText = "WARM UP";
+        break;
+    case B9PrinterStatus::PS_ON:
+        sText = "ON";
+        break;
+    case B9PrinterStatus::PS_COOLING:
+        sText = "COOL DN";
+        break;
+    case B9PrinterStatus::PS_TIMEOUT:
+        sText = "TIMEOUT";
+        if(m_bPrintActive)emit signalAbortPrint("Timed out while attempting to turn on projector.  Check Projector's Power Cord and RS-232 cable.");
+        break;
+    case B9PrinterStatus::PS_FAIL:
+        sText = "FAIL";
+        if(m_bPrintActive)emit signalAbortPrint("Lost Communications with Projector.  Possible Causes:  Manually powered off, Power Failure, Cord Disconnected or Projector Lamp Failure");
+        break;
+    case B9PrinterStatus::PS_UNKNOWN:
+    default:
+        sText = "UNKNOWN";
+        break;
+    }
+
+    // Show the projector window while it is commanded on
+    if(pProjector!=NULL){
+        if(pPrinterComm->isProjectorPowerCmdOn()) pProjector->show();
+        else pProjector->hide();
+    }
+    emit requestFocus();
+
+    if(m_bPrintActive)emit sendStatusMsg("B9Creator - Projector status: "+sText);
+    if(m_bPrintActive)emit updateProjectorStatus(sText);
+    if(m_bPrintActive)emit updateProjector(pPrinterComm->getProjectorStatus());
+    emit projectorStatusText(sText);
+}
+
+void B9Printer::rcResetHomePos()
+{
+    int iTimeoutEstimate = 80000; // 80 seconds (should never take longer than 75 secs from upper limit)
+
+    // Reset (Find Home) Motion
+    emit resetStarted();
+    m_pResetTimer->start(iTimeoutEstimate);
+    pPrinterComm->SendCmd("R");
+    resetLastSentCycleSettings();
+}
+
+void B9Printer::onMotionResetComplete()
+{
+    m_pResetTimer->stop();
+    emit resetFinished();
+
+    // Check for post reset go to fill command
+    if(m_iFillLevel>=0){
+        pPrinterComm->SendCmd("G"+QString::number(m_iFillLevel));
+        m_iFillLevel=-1;
+    }
+}
+
+void B9Printer::onMotionResetTimeout(){
+    m_pResetTimer->stop();
+    qDebug() << "ERROR: TIMEOUT attempting to locate home position.";
+    emit resetTimedOut();
+}
+
+void B9Printer::rcResetCurrentPositionPU(int iCurPos){
+    pPrinterComm->SendCmd("O"+QString::number(iCurPos));
+}
+
+void B9Printer::rcGotoFillAfterReset(int iFillLevel){
+    m_iFillLevel = iFillLevel;
+}
+
+void B9Printer::rcGotoZ(int iPU)
+{
+    pPrinterComm->SendCmd("G"+QString::number(iPU));
+}
+
+void B9Printer::rcSetVat(int iPercentOpen)
+{
+    if(m_pVatTimer->isActive()) return;
+    m_pVatTimer->start(3000); //should never take that long, even at slow speed
+    emit vatBusy(true);
+    pPrinterComm->SendCmd("V"+QString::number(iPercentOpen));
+}
+
+void B9Printer::rcOpenVat()
+{
+    m_pVatTimer->start(3000); //should never take that long, even at slow speed
+    emit vatBusy(true);
+    pPrinterComm->SendCmd("V100");
+}
+
+void B9Printer::rcCloseVat()
+{
+    m_pVatTimer->start(3000); //should never take that long, even at slow speed
+    emit vatBusy(true);
+    pPrinterComm->SendCmd("V0");
+}
+
+void B9Printer::onMotionVatTimeout(){
+    m_pVatTimer->stop();
+    rcSTOP(); // STOP!
+    qDebug() << "Vat Timed out";
+    emit vatTimedOut();
+    emit vatBusy(false);
+}
+
+void B9Printer::onBC_CurrentVatPercentOpen(int iPO){
+    Q_UNUSED(iPO);
+    m_pVatTimer->stop();
+    emit vatBusy(false);
+}
+
+void B9Printer::rcSTOP()
+{
+    m_pPReleaseCycleTimer->stop();
+    m_pVatTimer->stop();
+    pPrinterComm->SendCmd("S");
+    emit cycleStatus("Cycle Stopped.", false);
+    emit vatBusy(false);
+    resetLastSentCycleSettings();
+}
+
+void B9Printer::rcSetXYPixelSize(int iMicrons)
+{
+    if(getXYPixelSize()==iMicrons) return;
+    pPrinterComm->SendCmd("U"+QString::number(iMicrons));
+    pPrinterComm->SendCmd("A"); // Force refresh of printer stats
+}
+
+void B9Printer::rcSetVerbose(bool bVerbose)
+{
+    if(bVerbose)pPrinterComm->SendCmd("T1"); else pPrinterComm->SendCmd("T0");
+}
+
+void B9Printer::rcSendCommand(QString sCmd)
+{
+    pPrinterComm->SendCmd(sCmd);
+}
+
+void B9Printer::rcSetWarmUpDelay(int iDelayMS)
+{
+    pPrinterComm->setWarmUpDelay(iDelayMS);
+}
+
+void B9Printer::setTgtAltitudePU(int iTgtPU)
+{
+    m_iTgtPU = iTgtPU;
+    emit tgtAltitudeChanged(m_iTgtPU);
+}
+
+void B9Printer::setTgtAltitudeMM(double dTgtMM){
+    double dPU = (double)pPrinterComm->getPU()/100000.0;
+    setTgtAltitudePU((int)(dTgtMM/dPU));
+}
+
+void B9Printer::onBC_PrintReleaseCycleFinished()
+{
+    m_pPReleaseCycleTimer->stop();
+    m_iLastCycleMS = m_vCycleClock.elapsed();
+    // the simulator's clock is scaled, nothing to learn about the real printer from it
+    if(!pPrinterComm->isSimulated() && pSettings->m_CycleModel.learnCycle(&m_LastCycleParts, m_iLastCycleMS))
+        pSettings->saveCycleModel();
+    m_LastCycleParts = B9CycleParts(); // learn each cycle only once
+    emit cycleStatus("Cycle Complete.", false);
+    emit PrintReleaseCycleFinished();
+}
+
+void B9Printer::onReleaseCycleTimeout()
+{
+    m_pPReleaseCycleTimer->stop();
+    qDebug()<<"Release Cycle Timeout waiting on" << pPrinterComm->getPendingCycle() << ".  Possible reasons: Power Loss, Jammed Mechanism.";
+    rcSTOP(); // STOP!
+    emit cycleStatus("ERROR: TimeOut", false);
+    if(m_bPrintActive)emit signalAbortPrint("ERROR: Cycle Timed Out.  Possible reasons: Power Loss, Jammed Mechanism.");
+}
+
+void B9Printer::startCycle(QString sCmd, QString sStatus)
+{
+    // A simulated printer runs its moves, breathe and settle faster than real time
+    double dScale = pPrinterComm->timeScale();
+    int iTimeout = (int)(pSettings->m_CycleModel.estimateMS(&m_LastCycleParts)/dScale);
+    emit cycleStatus(sStatus, true);
+    pPrinterComm->SendCmd(sCmd+QString::number(m_iTgtPU));
+    m_iLastCycleEstMS = iTimeout;
+    m_vCycleClock.start();
+    m_pPReleaseCycleTimer->start(qMax((double)iTimeout, m_LastCycleParts.nominalMS()/dScale) * 2.0); // Timeout after 200% of estimated time required, never tighter than nominal
+}
+
+void B9Printer::cycleBase()
+{
+    m_bLayerPlanned = false;
+    resetLastSentCycleSettings();
+    SetCycleParameters();
+    m_LastCycleParts = getBaseCycleParts(pPrinterComm->getCurZPosInPU(), m_iTgtPU);
+    startCycle("B", "Moving to Base...");
+}
+
+void B9Printer::cycleNext()
+{
+    SetCycleParameters();
+    m_LastCycleParts = getNextCycleParts(pPrinterComm->getCurZPosInPU(), m_iTgtPU, getCycleParams(m_iTgtPU));
+    m_bLayerPlanned = false; // planned for this cycle only
+    startCycle("N", "Cycling to Next...");
+}
+
+void B9Printer::cycleFinal()
+{
+    rcProjectorPwr(false);  // command projector OFF
+    m_bLayerPlanned = false;
+    SetCycleParameters();
+    m_LastCycleParts = getFinalCycleParts(pPrinterComm->getCurZPosInPU(), m_iTgtPU);
+    startCycle("F", "Final Release...");
+}
+
+B9CycleParams B9Printer::getCycleParams(int iTgtPU){
+    if(m_bLayerPlanned) return m_LayerPlan;  // the print's exposure plan has already made the choice below
+    if(pSettings->m_dBTClearInMM*100000/pPrinterComm->getPU()>iTgtPU) return getCycleSetParams(1);
+    return getCycleSetParams(2);
+}
+
+B9CycleParams B9Printer::planCycleParams(int iTgtPU, double dAreaMM2, double dPerimeterMM, int* pCycleSet)
+{
+    int iSet = 2;
+    if(pSettings->m_dBTClearInMM*100000/pPrinterComm->getPU()>iTgtPU) iSet = 1;
+    else if(pSettings->m_CyclePlanner.isEnabled()) iSet = 3; // area adaptive, only past the base clearance
+    if(pCycleSet!=NULL) *pCycleSet = iSet;
+    if(iSet==3) return pSettings->m_CyclePlanner.planLayer(dAreaMM2, dPerimeterMM);
+    return getCycleSetParams(iSet);
+}
+
+B9CycleParams B9Printer::getCycleSetParams(int iSet){
+    B9CycleParams vParams;
+    if(iSet==1){
+        vParams.dBreatheClosed = pSettings->m_dBreatheClosed1;
+        vParams.dSettleOpen = pSettings->m_dSettleOpen1;
+        vParams.dOverLift = pSettings->m_dOverLift1;
+        vParams.iRSpd = pSettings->m_iRSpd1;
+        vParams.iLSpd = pSettings->m_iLSpd1;
+        vParams.iOpenSpd = pSettings->m_iOpenSpd1;
+        vParams.iCloseSpd = pSettings->m_iCloseSpd1;
+    }
+    else{
+        vParams.dBreatheClosed = pSettings->m_dBreatheClosed2;
+        vParams.dSettleOpen = pSettings->m_dSettleOpen2;
+        vParams.dOverLift = pSettings->m_dOverLift2;
+        vParams.iRSpd = pSettings->m_iRSpd2;
+        vParams.iLSpd = pSettings->m_iLSpd2;
+        vParams.iOpenSpd = pSettings->m_iOpenSpd2;
+        vParams.iCloseSpd = pSettings->m_iCloseSpd2;
+    }
+    return vParams;
+}
+
+void B9Printer::SetCycleParameters(){
+    B9CycleParams vParams = getCycleParams(m_iTgtPU);
+    int iD = (int)(vParams.dBreatheClosed*1000.0); // Breathe delay time
+    int iE = (int)(vParams.dSettleOpen*1000.0); // Settle delay time
+    int iJ = (int)(vParams.dOverLift*100000.0/(double)pPrinterComm->getPU()); // Overlift Raise Gap coverted to PU
+    int iK = vParams.iRSpd;  // Raise Speed
+    int iL = vParams.iLSpd;  // Lower Speed
+    int iW = vParams.iOpenSpd;  // Vat open speed
+    int iX = vParams.iCloseSpd; // Vat close speed
+    // Queued, they go out with the cycle command (or rcSendNextCycle's flush) as one write
+    if(iD!=m_iD){pPrinterComm->queueCmd("D"+QString::number(iD)); m_iD = iD;}
+    if(iE!=m_iE){pPrinterComm->queueCmd("E"+QString::number(iE)); m_iE = iE;}
+    if(iJ!=m_iJ){pPrinterComm->queueCmd("J"+QString::number(iJ)); m_iJ = iJ;}
+    if(iK!=m_iK){pPrinterComm->queueCmd("K"+QString::number(iK)); m_iK = iK;}
+    if(iL!=m_iL){pPrinterComm->queueCmd("L"+QString::number(iL)); m_iL = iL;}
+    if(iW!=m_iW){pPrinterComm->queueCmd("W"+QString::number(iW)); m_iW = iW;}
+    if(iX!=m_iX){pPrinterComm->queueCmd("X"+QString::number(iX)); m_iX = iX;}
+}
+
+void B9Printer::rcSendNextCycle(const B9CycleParams &vParams)
+{
+    rcSetNextCycle(vParams);
+    SetCycleParameters();
+    pPrinterComm->flushCmds();
+}
+
+void B9Printer::rcBasePrint(double dBaseMM)
+{
+    setTgtAltitudeMM(dBaseMM);
+    cycleBase();
+}
+
+void B9Printer::rcNextPrint(double dNextMM)
+{
+    setTgtAltitudeMM(dNextMM);
+    cycleNext();
+}
+
+void B9Printer::rcNextPrintPU(int iNextPU)
+{
+    setTgtAltitudePU(iNextPU);
+    cycleNext();
+}
+
+void B9Printer::rcFinishPrint(double dDeltaMM)
+{
+    // Calculates final position based on current + dDeltaMM
+    int newPos = dDeltaMM*100000.0/(double)pPrinterComm->getPU();
+    newPos += pPrinterComm->getCurZPosInPU();
+    if(newPos>pPrinterComm->getUpperZLimPU())newPos = pPrinterComm->getUpperZLimPU();
+    setTgtAltitudePU(newPos);
+    cycleFinal();
+}
+
+void B9Printer::rcSetCPJ(CrushedPrintJob *pCPJ)
+{
+    // Set the pointer to the CMB to be displayed, NULL if blank
+    emit sendCPJ(pCPJ);
+}
+
+void B9Printer::rcPreRenderFrames(CrushedPrintJob *pCPJ, int iLastLayer, int iFirstLayer)
+{
+    // Frames are rendered for the projector as it is now, if it changes they no longer match and drawing falls back to live rendering
+    if(pProjector==NULL)return;
+    m_pFrameCache->startBuild(pCPJ, iLastLayer, pProjector->size(), pProjector->getXoff(), pProjector->getYoff(), pProjector->getNormalizedMask(), iFirstLayer);
+}
+
+void B9Printer::rcSetProjMessage(QString sMsg)
+{
+    if(pProjector==NULL)return;
+    // Pass along the message for the projector screen
+    pProjector->setStatusMsg("B9Creator  -  "+sMsg);
+}
+
+int B9Printer::getLampAdjustedExposureTime(int iBaseTimeMS)
+{
+    if(pPrinterComm==NULL||pPrinterComm->getLampHrs()<0||pPrinterComm->getHalfLife()<0)return iBaseTimeMS;
+
+    //  dLife = 0.0 at zero lamp hours and 1.0 at or above halflife hours.
+    //  We multiply the base time by dLife and return the original amount + the product.
+    //  So at Halflife, we've doubled the standard exposure time.
+    double dLife = (double)pPrinterComm->getLampHrs()/(double)pPrinterComm->getHalfLife();
+    if(dLife > 1.0)dLife = 1.0; // Limit to 100% the amount of applied bulb degradation (reached at HalfLife)
+    return iBaseTimeMS + (double)iBaseTimeMS*dLife;
+}
+
+QTime B9Printer::getEstCompleteTime(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS)
+{
+    return QTime::currentTime().addMSecs(getEstCompleteTimeMS(iCurLayer, iTotLayers, dLayerThicknessMM, iExposeMS));
+}
+
+int B9Printer::getEstCompleteTimeMS(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS)
+{
+    //return estimated completion time
+    int iTransitionPointLayer = (int)(pSettings->m_dBTClearInMM/dLayerThicknessMM);
+
+    int iLowerCount = (int)(pSettings->m_dBTClearInMM/dLayerThicknessMM);
+    int iUpperCount = iTotLayers - iLowerCount;
+
+    if(iLowerCount>iTotLayers)iLowerCount=iTotLayers;
+    if(iUpperCount<0)iUpperCount=0;
+
+    if(iCurLayer<iTransitionPointLayer)iLowerCount = iLowerCount-iCurLayer; else iLowerCount = 0;
+    if(iCurLayer>=iTransitionPointLayer) iUpperCount = iTotLayers - iCurLayer;
+
+    int iTotalTimeMS = iExposeMS*iLowerCount + iExposeMS*iUpperCount;
+
+    iTotalTimeMS = getLampAdjustedExposureTime(iTotalTimeMS);
+
+    // Add Breathe and Settle, these are in seconds
+    iTotalTimeMS += iLowerCount*(pSettings->m_dBreatheClosed1 + pSettings->m_dSettleOpen1)*1000.0;
+    iTotalTimeMS += iUpperCount*(pSettings->m_dBreatheClosed2 + pSettings->m_dSettleOpen2)*1000.0;
+
+    // Z Travel Time
+    int iGap1 = iLowerCount*(int)(pSettings->m_dOverLift1*100000.0/(double)pPrinterComm->getPU());
+    int iGap2 = iUpperCount*(int)(pSettings->m_dOverLift2*100000.0/(double)pPrinterComm->getPU());
+
+    int iZRaiseDistance1 = iGap1 + iLowerCount*(int)(dLayerThicknessMM*100000.0/(double)pPrinterComm->getPU());
+    int iZLowerDistance1 = iGap1;
+
+    int iZRaiseDistance2 = iGap2 + iUpperCount*(int)(dLayerThicknessMM*100000.0/(double)pPrinterComm->getPU());
+    int iZLowerDistance2 = iGap2;
+
+    iTotalTimeMS += getZMoveTime(iZRaiseDistance1,pSettings->m_iRSpd1);
+    iTotalTimeMS += getZMoveTime(iZRaiseDistance2,pSettings->m_iRSpd2);
+    iTotalTimeMS += getZMoveTime(iZLowerDistance1,pSettings->m_iLSpd1);
+    iTotalTimeMS += getZMoveTime(iZLowerDistance2,pSettings->m_iLSpd2);
+
+    // Vat movement Time
+    iTotalTimeMS += iLowerCount*getVatMoveTime(pSettings->m_iOpenSpd1) + iLowerCount*getVatMoveTime(pSettings->m_iCloseSpd1);
+    iTotalTimeMS += iUpperCount*getVatMoveTime(pSettings->m_iOpenSpd2) + iUpperCount*getVatMoveTime(pSettings->m_iCloseSpd2);
+
+    // Per cycle overhead the model has measured (communication, acceleration)
+    iTotalTimeMS += (iLowerCount + iUpperCount)*pSettings->m_CycleModel.overheadMS();
+    return iTotalTimeMS;
+}
+
+int B9Printer::getZMoveTime(int iDelta, int iSpd){
+    // returns milliseconds required to move iDelta PU's, as learned from this printer's cycles
+    return (int)(getNominalZMoveTime(iDelta, iSpd)*pSettings->m_CycleModel.zFactor(iSpd));
+}
+
+int B9Printer::getVatMoveTime(int iSpeed){
+    return (int)(getNominalVatMoveTime(iSpeed)*pSettings->m_CycleModel.vatFactor(iSpeed));
+}
+
+double B9Printer::getNominalZMoveTime(int iDelta, int iSpd){
+    // returns time to travel iDelta PUs distance in milliseconds
+    // Accurate but assumes that 100% is 140rpm and 0% is 10rpm
+    // Also assumes 200 PU (Steps) per revolution
+    // returns milliseconds required to move iDelta PU's
+    if(iDelta==0)return 0;
+    double dPUms; // printer units per millisecond
+    dPUms = ((double)iSpd/100.0)*130.0 + 10.0;
+    dPUms *= 200.0; // PU per minute
+    dPUms /= 60; // PU per second
+    dPUms /= 1000; // PU per millisecond
+    return double(iDelta)/dPUms;
+}
+
+double B9Printer::getNominalVatMoveTime(int iSpeed){
+    double dPercent = (double)iSpeed/100.0;
+//    return 999 - dPercent*229.0; // based on speed tests of B9C1 on 11/14/2012
+    return 1500 - dPercent*229.0; // updated based on timeouts on pre-production model tests 11/18/2012
+}
+
+int B9Printer::getEstBaseCycleTime(int iCur, int iTgt){
+    B9CycleParts vParts = getBaseCycleParts(iCur, iTgt);
+    return pSettings->m_CycleModel.estimateMS(&vParts);
+}
+
+int B9Printer::getEstNextCycleTime(int iCur, int iTgt){
+    return getEstNextCycleTime(iCur, iTgt, getCycleParams(iTgt));
+}
+
+int B9Printer::getEstNextCycleTime(int iCur, int iTgt, const B9CycleParams &vParams){
+    B9CycleParts vParts = getNextCycleParts(iCur, iTgt, vParams);
+    return pSettings->m_CycleModel.estimateMS(&vParts);
+}
+
+int B9Printer::getEstFinalCycleTime(int iCur, int iTgt){
+    B9CycleParts vParts = getFinalCycleParts(iCur, iTgt);
+    return pSettings->m_CycleModel.estimateMS(&vParts);
+}
+
+B9CycleParts B9Printer::getBaseCycleParts(int iCur, int iTgt){
+    B9CycleParts vParts;
+    B9CycleParams vParams = getCycleParams(iTgt);
+    int iDelta = abs(iTgt - iCur);
+    // Time to move iDelta
+    vParts.addZMove(vParams.iLSpd, getNominalZMoveTime(iDelta, vParams.iLSpd));
+    // Plus time to open vat
+    vParts.addVatMove(vParams.iOpenSpd, getNominalVatMoveTime(vParams.iOpenSpd));
+    // Plus settle time;
+    vParts.addDelay((int)(vParams.dSettleOpen*1000.0));
+    return vParts;
+}
+
+B9CycleParts B9Printer::getNextCycleParts(int iCur, int iTgt, const B9CycleParams &vParams){
+    B9CycleParts vParts;
+    int iDelta = abs(iTgt - iCur);
+    int iGap = (int)(vParams.dOverLift*100000.0/(double)pPrinterComm->getPU());
+    // Time to move +iDelta + iGap, up and down
+    vParts.addZMove(vParams.iRSpd, getNominalZMoveTime(iDelta+iGap, vParams.iRSpd));
+    vParts.addZMove(vParams.iLSpd, getNominalZMoveTime(iDelta+iGap, vParams.iLSpd));
+    // Plus time to close + open the vat
+    vParts.addVatMove(vParams.iCloseSpd, getNominalVatMoveTime(vParams.iCloseSpd));
+    vParts.addVatMove(vParams.iOpenSpd, getNominalVatMoveTime(vParams.iOpenSpd));
+    // Plus breathe & settle time;
+    vParts.addDelay((int)(vParams.dBreatheClosed*1000.0) + (int)(vParams.dSettleOpen*1000.0));
+    return vParts;
+}
+
+B9CycleParts B9Printer::getFinalCycleParts(int iCur, int iTgt){
+    B9CycleParts vParts;
+    B9CycleParams vParams = getCycleParams(iTgt);
+    int iDelta = abs(iTgt - iCur);
+    // Time to move +iDelta up
+    vParts.addZMove(vParams.iRSpd, getNominalZMoveTime(iDelta, vParams.iRSpd));
+    // time to close the vat
+    vParts.addVatMove(vParams.iCloseSpd, getNominalVatMoveTime(vParams.iCloseSpd));
+    return vParts;
+}
+
+void B9Printer::onScreenCountChanged(int iCount){
+    QString sVideo = "Disconnected or Primary Monitor";
+    if(pProjector) {
+        delete pProjector;
+        pProjector = NULL;
+        if(pPrinterComm->getProjectorStatus()==B9PrinterStatus::PS_ON)
+            if(m_bPrintActive)emit signalAbortPrint("Print Aborted:  Connection to Projector Lost or Changed During Print Cycle");
+    }
+    pProjector = new B9Projector(true, 0,Qt::WindowStaysOnTopHint);
+    makeProjectorConnections();
+    int i=iCount;
+    int screenCount = m_pDesktop->screenCount();
+    QRect screenGeometry;
+
+    if(m_bUsePrimaryMonitor)
+    {
+        screenGeometry = m_pDesktop->screenGeometry(0);
+    }
+    else if(m_iProjectorScreen>=0 && m_iProjectorScreen<screenCount){
+        // We were told which screen the projector is on
+        i = m_iProjectorScreen;
+        screenGeometry = m_pDesktop->screenGeometry(i);
+        sVideo = "Connected to Monitor: " + QString::number(i+1);
+        m_bNeedsWarned = true;
+    }
+    else{
+        for(i=screenCount-1;i>= 0;i--) {
+            screenGeometry = m_pDesktop->screenGeometry(i);
+            if(screenGeometry.width() == pPrinterComm->getNativeX() && screenGeometry.height() == pPrinterComm->getNativeY()) {
+                //Found the projector!
+                sVideo = "Connected to Monitor: " + QString::number(i+1);
+                m_bNeedsWarned = true;
+                break;
+            }
+        }
+    }
+    if(i<=0||m_bUsePrimaryMonitor)m_bPrimaryScreen = true; else m_bPrimaryScreen = false;
+
+    emit updateProjectorOutput(sVideo);
+
+    pProjector->setShowGrid(true);
+    pProjector->setCPJ(NULL);
+
+    emit sendStatusMsg("B9Creator - Idle");
+    pProjector->setGeometry(screenGeometry);
+    if(!m_bPrimaryScreen){
+        pProjector->showFullScreen(); // Only show it if it is a secondary monitor
+        pProjector->hide();
+        emit requestFocus(); // if not using primary monitor, take focus back to the panel.
+    }
+    else if(m_bPrintPreview||(pPrinterComm->getProjectorStatus() != B9PrinterStatus::PS_OFF &&
+            pPrinterComm->getProjectorStatus() != B9PrinterStatus::PS_COOLING &&
+            pPrinterComm->getProjectorStatus() != B9PrinterStatus::PS_UNKNOWN)) {
+        // if the projector is not turned off, we better put up the blank screen now!
+        pProjector->showFullScreen();
+    }
+    else warnSingleMonitor();
+}
+
+void B9Printer::createNormalizedMask(double XYPS, double dZ, double dOhMM)
+{
+    //call when we show or resize
+    pProjector->createNormalizedMask(XYPS, dZ, dOhMM);
+}
@@ -0,0 +1,269 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTER_H
+#define B9PRINTER_H
+
+#include <QObject>
+#include <QDesktopWidget>
+#include <QTimer>
+#include <QTime>
+#include <QElapsedTimer>
+#include "b9printercomm.h"
+#include "b9projector.h"
+#include "b9matcat.h"
+#include "b9cyclemodel.h"
+#include "b9cycleplanner.h"
+
+class PCycleSettings {
+public:
+    PCycleSettings(QString sGroup = ""){m_sGroup = sGroup; loadSettings();}
+    ~PCycleSettings(){}
+
+    void loadSettings();
+    void saveSettings();
+    void setFactorySettings();
+    void saveCycleModel(); // just the learned model, it is updated during a print
+    QString m_sGroup; // settings group, one per printer when a host drives several
+    int m_iRSpd1, m_iLSpd1, m_iRSpd2, m_iLSpd2;
+    int m_iOpenSpd1, m_iCloseSpd1, m_iOpenSpd2, m_iCloseSpd2;
+    double m_dBreatheClosed1, m_dSettleOpen1, m_dBreatheClosed2, m_dSettleOpen2;
+    double m_dOverLift1, m_dOverLift2;
+    double m_dBTClearInMM;
+    double m_dHardZDownMM;
+    double m_dZFlushMM;
+    B9CycleModel m_CycleModel; // learned from measured cycles, not reset by factory settings
+    B9CyclePlanner m_CyclePlanner; // per layer parameters above the base clearance, when enabled
+};
+
+/******************************************************
+B9Printer is one B9Creator as the host sees it: the comm
+link, the projector window and the release cycle logic,
+with no control panel of its own.  B9Terminal puts a GUI
+on one, B9PrintController prints with one, and a program
+that needs no GUI can use it directly.
+******************************************************/
+class B9Printer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // sName tells printers apart when one host drives several, each keeps its own cycle settings
+    explicit B9Printer(QObject *parent = 0, QString sName = "");
+    ~B9Printer();
+
+    QString getName(){return m_sName;}
+    void setCommPort(QString sPortName){pPrinterComm->setPort(sPortName);} // empty searches for any B9Creator
+    void setRenderThreads(int iThreads){m_pFrameCache->setMaxThreads(iThreads);}
+
+    B9PrinterComm* getComm(){return pPrinterComm;}
+    PCycleSettings* getSettings(){return pSettings;}
+    B9MatCat* getMatCat() {return m_pCatalog;}
+    B9Projector* getProjector(){return pProjector;}
+
+    bool isConnected(){return pPrinterComm->isConnected();}
+
+    // While a print is active faults are raised with signalAbortPrint
+    void setPrintActive(bool bActive){m_bPrintActive = bActive;}
+    bool isPrintActive(){return m_bPrintActive;}
+
+    double getHardZDownMM(){return pSettings->m_dHardZDownMM;}
+    double getZFlushMM(){return pSettings->m_dZFlushMM;}
+
+    int getEstBaseCycleTime(int iCur, int iTgt);
+    int getEstNextCycleTime(int iCur, int iTgt);
+    int getEstNextCycleTime(int iCur, int iTgt, const B9CycleParams &vParams);
+    int getEstFinalCycleTime(int iCur, int iTgt);
+
+    QTime getEstCompleteTime(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS);
+    int getEstCompleteTimeMS(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS);
+    int getLampAdjustedExposureTime(int iBaseTimeMS);
+
+    // The parameters a release cycle to iTgtPU would use for a layer of this size, pCycleSet gets 1 or 2 for the settings or 3 if planned
+    B9CycleParams planCycleParams(int iTgtPU, double dAreaMM2, double dPerimeterMM, int* pCycleSet = NULL);
+    void rcSetNextCycle(const B9CycleParams &vParams){m_LayerPlan = vParams; m_bLayerPlanned = true;} // used by the next 'N' cycle only
+    void rcSendNextCycle(const B9CycleParams &vParams); // as rcSetNextCycle, and send the parameters now while the printer is idle
+
+    void setUsePrimaryMonitor(bool bFlag){m_bUsePrimaryMonitor=bFlag; }
+    bool getUsePrimaryMonitor(){return m_bUsePrimaryMonitor;}
+    void setPrintPreview(bool bFlag){m_bPrintPreview=bFlag; }
+    bool getPrintPreview(){return m_bPrintPreview;}
+    void setProjectorScreen(int iScreen){m_iProjectorScreen = iScreen;} // -1 finds the screen matching the projector's native resolution
+    int getProjectorScreen(){return m_iProjectorScreen;}
+    void setProjectorOffset(int iXOff, int iYOff){m_iXOff = iXOff; m_iYOff = iYOff; emit sendXoff(m_iXOff); emit sendYoff(m_iYOff);} // layer image offset in projector pixels
+    bool isPrimaryScreen(){return m_bPrimaryScreen;}
+    void createNormalizedMask(double XYPS=0.1, double dZ = 257.0, double dOhMM = 91.088); //call when we show or resize
+
+    int getXYPixelSize(){return pPrinterComm->getXYPixelSize();}
+    int getTgtAltitudePU(){return m_iTgtPU;}
+    bool isCycling(){return m_pPReleaseCycleTimer->isActive();}
+
+    // Timing of the most recent Base/Next/Final cycle, from command sent to 'F' received
+    int getLastCycleEstMS(){return m_iLastCycleEstMS;}
+    int getLastCycleMS(){return m_iLastCycleMS;}
+    B9FrameTiming getProjectorFrameTiming(){if(pProjector==NULL)return B9FrameTiming(); return pProjector->getFrameTiming();}
+
+    // Pre-rendering of the print job's frames for the current projector, see B9FrameCache
+    void rcPreRenderFrames(CrushedPrintJob *pCPJ, int iLastLayer, int iFirstLayer = 0);
+    void rcDropFrame(int iLayer){m_pFrameCache->dropFrame(iLayer);} // layer has been printed
+    void rcCancelPreRender(){m_pFrameCache->cancel();}
+
+public slots:
+    void rcResetHomePos();
+    void rcResetCurrentPositionPU(int iCurPos);
+    void rcBasePrint(double dBaseMM); // Position for Base Layer Exposure.
+    void rcNextPrint(double dNextMM); // Position for Next Layer Exposure.
+    void rcNextPrintPU(int iNextPU);  // Position for Next Layer Exposure, in printer units as an exposure plan gives it
+    void rcFinishPrint(double dDeltaMM); // Calculates a final Z position at current + dDelta, closes vat, raises z, turns off projector.
+    void rcSTOP();
+    void rcCloseVat();
+    void rcOpenVat();
+    void rcSetVat(int iPercentOpen);
+    void rcGotoZ(int iPU);
+    void rcSetWarmUpDelay(int iDelayMS);
+
+    void rcProjectorPwr(bool bPwrOn);
+    void rcSetCPJ(CrushedPrintJob *pCPJ); // Set the pointer to the CMB to be displayed, NULL if blank
+    void rcCreateToverMap(int iRadius){pProjector->createToverMap(iRadius);}
+    bool rcClearTimedPixels(int iLevel){return pProjector->clearTimedPixels(iLevel);}
+    void rcSetProjMessage(QString sMsg);
+    void rcGotoFillAfterReset(int iFillLevel);
+    void rcSetXYPixelSize(int iMicrons);
+    void rcSetVerbose(bool bVerbose);
+    void rcSendCommand(QString sCmd);
+
+    // Release cycles to the current target altitude
+    void setTgtAltitudePU(int iTgtPU);
+    void setTgtAltitudeMM(double dTgtMM);
+    void cycleBase();
+    void cycleNext();
+    void cycleFinal();
+
+    void onScreenCountChanged(int iCount = 0);  // Signal that the number of monitors has changed
+
+signals:
+    void signalAbortPrint(QString sMessage);
+    void pausePrint();
+    void updateConnectionStatus(QString sText); // Connected or Searching
+    void updateProjectorOutput(QString sText);  // Data on video to projector connection
+    void updateProjectorStatus(QString sText);  // Projector Power Status Changes
+    void updateProjector(B9PrinterStatus::ProjectorStatus eStatus);
+    void PrintReleaseCycleFinished();
+
+    void sendStatusMsg(QString text);					// signal to the Projector window to change the status msg
+    void sendGrid(bool bshow);							// signal to the Projector window to update the grid display
+    void sendCPJ(CrushedPrintJob * pCPJ);				// signal to the Projector window to show a crushed bit map image
+    void sendXoff(int xOff);							// signal to the Projector window to update the X offset
+    void sendYoff(int yOff);							// signal to the Projector window to update the Y offset
+
+    // For a control panel, B9Terminal
+    void projectorPowerCmd(bool bOn);            // commanded projector power changed
+    void projectorStatusText(QString sText);     // projector state, every change
+    void projectorKey(int iKey);                 // key released in the projector window
+    void singleMonitorWarning();                 // projector appears to be on the primary monitor
+    void requestFocus();                         // projector window was shown, a panel may want focus back
+    void cycleStatus(QString sText, bool bBusy); // release cycle progress, bBusy while a cycle runs
+    void tgtAltitudeChanged(int iTgtPU);
+    void resetStarted();
+    void resetFinished();
+    void resetTimedOut();
+    void vatBusy(bool bBusy);
+    void vatTimedOut();
+
+private slots:
+    void makeProjectorConnections();
+    void getKey(int iKey);					    // Signal that we received a (released) key from the projector
+
+    void onBC_LostCOMM();
+    void onBC_ProjStatusChanged();
+    void onBC_ProjStatusFAIL();
+    void onBC_ModelInfo(QString sModel);
+    void onBC_NativeY(int iNY);
+    void onBC_CurrentVatPercentOpen(int iPO);
+    void onMotionResetTimeout();
+    void onMotionResetComplete();
+    void onMotionVatTimeout();
+    void onBC_PrintReleaseCycleFinished();
+    void onReleaseCycleTimeout();
+    void SetCycleParameters();
+
+private:
+    int getZMoveTime(int iDelta, int iSpd);     // learned travel times
+    int getVatMoveTime(int iSpeed);
+    double getNominalZMoveTime(int iDelta, int iSpd);  // data sheet travel times the model is relative to
+    double getNominalVatMoveTime(int iSpeed);
+    B9CycleParts getBaseCycleParts(int iCur, int iTgt);
+    B9CycleParts getNextCycleParts(int iCur, int iTgt, const B9CycleParams &vParams);
+    B9CycleParts getFinalCycleParts(int iCur, int iTgt);
+    B9CycleParts m_LastCycleParts; // the cycle in progress, learned from when it finishes
+    B9CycleParams getCycleParams(int iTgtPU);  // the parameters a cycle to iTgtPU is run with
+    B9CycleParams getCycleSetParams(int iSet);  // cycle settings 1, below the base clearance, or 2
+    B9CycleParams m_LayerPlan;  // from rcSetNextCycle, used by the next 'N' cycle only
+    bool m_bLayerPlanned;
+    void startCycle(QString sCmd, QString sStatus);
+    void warnSingleMonitor();
+
+    B9MatCat* m_pCatalog;
+    PCycleSettings *pSettings;
+    int m_iD, m_iE, m_iJ, m_iK, m_iL, m_iW, m_iX;
+    void resetLastSentCycleSettings();
+
+    B9PrinterComm *pPrinterComm;
+    B9Projector *pProjector;
+    B9FrameCache *m_pFrameCache;
+    QDesktopWidget* m_pDesktop;
+    QString m_sName;
+    int m_iProjectorScreen;
+    int m_iXOff, m_iYOff;
+    bool m_bPrimaryScreen;
+    bool m_bPrintPreview;
+    bool m_bUsePrimaryMonitor;
+    bool m_bPrintActive;
+    bool m_bNeedsWarned;
+
+    QTimer *m_pResetTimer;
+    QTimer *m_pPReleaseCycleTimer;
+    QTimer *m_pVatTimer;
+    QElapsedTimer m_vCycleClock;
+    int m_iLastCycleEstMS, m_iLastCycleMS;
+
+    int m_iTgtPU;
+    int m_iFillLevel;
+};
+
+#endif // B9PRINTER_H
@@ -38,8 +38,10 @@
 
 #include <QtGui/QApplication>
 #include <QDir>
+#include <QFileInfo>
 #include <QProcess>
 #include <QTimer>
+#include <string.h>
 #include "b9printercomm.h"
 #include "qextserialport.h"
 #include "qextserialenumerator.h"
@@ -152,32 +154,120 @@ bool B9FirmwareUpdate::UploadHex(QString sCurPort)
     return true;
 }
 
+QStringList B9PrinterComm::s_vVirtualPorts;
+QList<double> B9PrinterComm::s_vVirtualScales;
+QList<B9PrinterComm*> B9PrinterComm::s_vInstances;
+
 B9PrinterComm::B9PrinterComm()
 {
     m_bIsPrinting = false;
     pPorts = new QList<QextPortInfo>;
+    pNewPorts = new QList<QextPortInfo>;
     pEnumerator = new QextSerialEnumerator();
     m_serialDevice = NULL;
     m_bCloneBlanks = false;
     m_Status.reset();
     m_iWarmUpDelayMS = 15000;
+    m_baRx.resize(RXBUFFERSIZE);
+    m_iRxLen = 0;
+    m_bInRead = false;
+    s_vInstances.append(this);
     qDebug() << "B9Creator COMM Start";
-    QTimer::singleShot(500, this, SLOT(RefreshCommPortItems())); // Check in .5 seconds
+
+    m_pRefreshTimer = new QTimer(this);
+    m_pRefreshTimer->setSingleShot(true);
+    connect(m_pRefreshTimer, SIGNAL(timeout()), this, SLOT(RefreshCommPortItems()));
+
+    // Let the enumerator tell us when ports are plugged in or pulled instead of polling for them.
+    // Ports already present are announced during setUpNotifications, we connect after it
+    // so the first full scan below picks those up.
+#if defined(Q_OS_WIN) || defined(Q_OS_MAC) || (defined(Q_OS_LINUX) && !defined(QESP_NO_UDEV))
+    // udev, or the OS equivalent, can still fail at run time, then we poll as if we had no notifications at all
+    m_bHotplug = pEnumerator->setUpNotifications();
+    if(!m_bHotplug) qDebug() << "Serial port notifications unavailable, polling for printers";
+    connect(pEnumerator, SIGNAL(deviceDiscovered(QextPortInfo)), this, SLOT(onPortAdded(QextPortInfo)));
+    connect(pEnumerator, SIGNAL(deviceRemoved(QextPortInfo)), this, SLOT(onPortRemoved(QextPortInfo)));
+#else
+    m_bHotplug = false;
+#endif
+    m_pRefreshTimer->start(500); // Check in .5 seconds
 }
 
 B9PrinterComm::~B9PrinterComm()
 {
     if(pPorts)delete pPorts;
+    if(pNewPorts)delete pNewPorts;
     if(pEnumerator) pEnumerator->deleteLater();
     if(m_serialDevice) delete m_serialDevice;
+    s_vInstances.removeAll(this);
     qDebug() << "B9Creator COMM End";
 }
 
+bool B9PrinterComm::isSimulated()
+{
+    return m_serialDevice!=NULL && s_vVirtualPorts.contains(m_serialDevice->portName());
+}
+
+double B9PrinterComm::timeScale()
+{
+    if(m_serialDevice==NULL) return 1.0;
+    int i = s_vVirtualPorts.indexOf(m_serialDevice->portName());
+    return i<0 ? 1.0 : s_vVirtualScales.value(i, 1.0);
+}
+
+bool B9PrinterComm::isPortInUse(QString sPortName)
+{
+    for(int i=0; i<s_vInstances.count(); i++){
+        B9PrinterComm* pComm = s_vInstances[i];
+        if(pComm!=this && pComm->m_serialDevice!=NULL && pComm->m_serialDevice->portName()==sPortName) return true;
+    }
+    return false;
+}
+
+bool B9PrinterComm::isOtherPrinting()
+{
+    for(int i=0; i<s_vInstances.count(); i++)
+        if(s_vInstances[i]!=this && s_vInstances[i]->m_bIsPrinting) return true;
+    return false;
+}
+
 void B9PrinterComm::SendCmd(QString sCmd)
 {
-    if(m_serialDevice)m_serialDevice->write(sCmd.toAscii()+'\n');
-    if(sCmd == "r" || sCmd == "R") m_Status.setHomeStatus(B9PrinterStatus::HS_SEEKING);
-    qDebug() << "SendCmd->" << sCmd;
+    // Anything queued goes first, in the same write
+    queueCmd(sCmd);
+    flushCmds();
+}
+
+void B9PrinterComm::queueCmd(QString sCmd)
+{
+    if(sCmd.isEmpty()) return;
+    QChar cCmd = sCmd.at(0).toUpper();
+    if(QString(CMDSETTINGS).contains(cCmd)){
+        for(int i=0; i<m_vTxQueue.count(); i++){
+            if(m_vTxQueue[i].at(0).toUpper()==cCmd){
+                m_vTxQueue.removeAt(i);
+                break;
+            }
+        }
+    }
+    m_vTxQueue.append(sCmd);
+}
+
+void B9PrinterComm::flushCmds()
+{
+    if(m_vTxQueue.isEmpty()) return;
+    QByteArray baBatch;
+    for(int i=0; i<m_vTxQueue.count(); i++){
+        const QString &sCmd = m_vTxQueue.at(i);
+        baBatch += sCmd.toAscii()+'\n';
+        if(sCmd == "r" || sCmd == "R") m_Status.setHomeStatus(B9PrinterStatus::HS_SEEKING);
+        QChar cCmd = sCmd.at(0).toUpper();
+        if(cCmd=='B' || cCmd=='N' || cCmd=='F') m_sPendingCycle = sCmd;
+    }
+    if(m_serialDevice)m_serialDevice->write(baBatch);
+    flushLog();  // what we've received so far goes in the log ahead of what we send
+    qDebug() << "SendCmd->" << qPrintable(m_vTxQueue.join(" "));
+    m_vTxQueue.clear();
 }
 
 void B9PrinterComm::watchDog()
@@ -206,6 +296,7 @@ void B9PrinterComm::watchDog()
         m_serialDevice = NULL;
     }
     //Attempt to pick up were we lost contact if we find the port again within a short time
+    flushLog();
     qDebug() << "WATCHDOG:  LOST CONTACT WITH B9CREATOR!";
 
     emit updateConnectionStatus(MSG_SEARCHING);
@@ -216,6 +307,8 @@ void B9PrinterComm::watchDog()
 }
 
 void B9PrinterComm::handleLostComm(){
+    m_vTxQueue.clear();
+    m_sPendingCycle.clear();
     emit BC_LostCOMM();
 }
 
@@ -225,26 +318,115 @@ void B9PrinterComm::startWatchDogTimer()
     QTimer::singleShot(10000, this, SLOT(watchDog())); // Check in 10 seconds
 }
 
+void B9PrinterComm::scheduleRefresh(bool bSoon)
+{
+    // Without hotplug notices we poll: every 5 seconds to see our port is still there, every second while searching.
+    // With them a full scan is only a fallback for ports we are never told about (simulator ptys, a failed monitor).
+    int iMS;
+    if(bSoon) iMS = 1000;
+    else if(m_bHotplug) iMS = m_serialDevice ? 0 : HOTPLUGFALLBACKMS;
+    else iMS = m_serialDevice ? 5000 : 1000;
+    if(iMS > 0) m_pRefreshTimer->start(iMS);
+    else m_pRefreshTimer->stop();
+}
+
+QString B9PrinterComm::portId(const QextPortInfo &vInfo)
+{
+#ifdef Q_WS_X11
+    return vInfo.physName; // linux ID's ports by physName
+#else
+    return vInfo.portName; // Windows and OSX use portName to ID ports
+#endif
+}
+
+bool B9PrinterComm::isB9CreatorPort(const QextPortInfo &vInfo, QString *pPortName)
+{
+    QString sPortName = portId(vInfo);
+    *pPortName = sPortName;
+    if(!m_sFixedPort.isEmpty() && sPortName != m_sFixedPort) return false;
+    if(isPortInUse(sPortName)) return false; // another printer's
+    if(sPortName == m_sFixedPort || s_vVirtualPorts.contains(sPortName)) return true;
+#ifdef Q_WS_X11
+    // We filter ports by requiring the portName to begin with "ttyA"
+    // (udev reports the device node, "/dev/ttyACM0", so look at the file name only)
+    return QFileInfo(vInfo.portName).fileName().left(4) == "ttyA";
+#else
+    // We filter ports by requiring vendorID value of 9025 (Arduino)
+    return vInfo.vendorID==9025;
+#endif
+}
+
+void B9PrinterComm::onPortAdded(const QextPortInfo &vInfo)
+{
+    qDebug() << "Serial Port Added:" << portId(vInfo);
+    if(m_serialDevice!=NULL) return; // already connected, nothing to find
+    pNewPorts->append(vInfo);
+    QTimer::singleShot(HOTPLUGSETTLEMS, this, SLOT(probeNewPorts()));
+}
+
+void B9PrinterComm::onPortRemoved(const QextPortInfo &vInfo)
+{
+    QString sPortName = portId(vInfo);
+    qDebug() << "Serial Port Removed:" << sPortName;
+    for(int i=pNewPorts->count()-1; i>=0; i--)
+        if(portId(pNewPorts->at(i)) == sPortName) pNewPorts->removeAt(i);
+    if(m_serialDevice==NULL || m_serialDevice->portName() != sPortName) return;
+
+    // Our printer went away, no need to wait for the watchdog to notice
+    if (m_serialDevice->isOpen())
+        m_serialDevice->close();
+    delete m_serialDevice;
+    m_serialDevice = NULL;
+    m_Status.reset();
+    qDebug() << "Lost Comm, port removed:" << sPortName;
+    emit updateConnectionStatus(MSG_SEARCHING);
+    emit BC_ConnectionStatusDetailed("Lost Comm on previous port. Searching...");
+    handleLostComm();
+    scheduleRefresh();
+}
+
+void B9PrinterComm::probeNewPorts()
+{
+    // Only the ports we were told about, not a full scan
+    if(pNewPorts->isEmpty()) return; // several notices, one probe
+    if(m_bIsPrinting || m_serialDevice!=NULL){
+        pNewPorts->clear();
+        return;
+    }
+    if(isOtherPrinting()){
+        // Leave it to the refresh, it waits until the other print is done
+        pNewPorts->clear();
+        scheduleRefresh();
+        return;
+    }
+    *pPorts = *pNewPorts;
+    pNewPorts->clear();
+    scheduleRefresh(searchPorts());
+}
+
 void B9PrinterComm::RefreshCommPortItems()
 {
     if(m_bIsPrinting)return; // We assume we stay connected during the print proccess.  If we are disconnected, the watchdog timer will fire
-    QString sCommPortStatus = MSG_SEARCHING;
-    QString sCommPortDetailedStatus = MSG_SEARCHING;
-    QString sPortName;
     // Load the current enumerated available ports
     *pPorts = pEnumerator->getPorts();
+    for(int i=s_vVirtualPorts.count()-1; i>=0; i--){
+        // The enumerator doesn't list ptys, add the simulators' by hand
+        QextPortInfo vVirtual;
+        vVirtual.portName = s_vVirtualPorts[i];
+        vVirtual.physName = s_vVirtualPorts[i];
+        vVirtual.friendName = "B9Creator Simulator";
+        vVirtual.vendorID = 0;
+        vVirtual.productID = 0;
+        pPorts->prepend(vVirtual);
+    }
 
     if(m_serialDevice){
         // We've previously located the printer, are we still connected?
         for (int i = 0; i < pPorts->size(); i++) {
         // Check each existing port to see if our's still exists
-        #ifdef Q_WS_X11
-            if(pPorts->at(i).physName == m_serialDevice->portName()){
-        #else
-            if(pPorts->at(i).portName == m_serialDevice->portName()){
-        #endif
-                // We're still connected, set a timer to check again in 5 seconds and then exit
-                QTimer::singleShot(5000, this, SLOT(RefreshCommPortItems()));
+            if(portId(pPorts->at(i)) == m_serialDevice->portName()){
+                // We're still connected, set a timer to check again and then exit
+                scheduleRefresh();
                 return;
             }
         }
@@ -254,21 +436,37 @@ void B9PrinterComm::RefreshCommPortItems()
         delete m_serialDevice;
         m_serialDevice = NULL;
         m_Status.reset();
-        qDebug() << sCommPortStatus;
-        emit updateConnectionStatus(sCommPortStatus);
-        sCommPortDetailedStatus = "Lost Comm on previous port. Searching...";
+        qDebug() << MSG_SEARCHING;
+        emit updateConnectionStatus(MSG_SEARCHING);
         emit BC_ConnectionStatusDetailed("Lost Comm on previous port. Searching...");
         handleLostComm();
     }
 
+    // Probing waits up to 5 seconds per port and flashing up to 2 minutes, all on the shared GUI thread,
+    // a print in another session would miss its exposure deadlines meanwhile.  Look again later.
+    if(isOtherPrinting()){
+        qDebug() << "Another printer is printing, not searching for a B9Creator until it is done";
+        scheduleRefresh();
+        return;
+    }
+
     // Now we search for a B9Creator
-    int eTime = 1000;  // 1 second search cylce time for while not connected
+    scheduleRefresh(searchPorts());
+}
 
+bool B9PrinterComm::searchPorts()
+{
+    // Try each port in pPorts until we find a B9Creator
+    QString sCommPortStatus = MSG_SEARCHING;
+    QString sCommPortDetailedStatus = MSG_SEARCHING;
+    QString sPortName;
+    bool bUpdateFirmware = false;
     sNoFirmwareAurdinoPort = "";  // Reset to null string before scanning ports
     if(pPorts->size()>0){
         // Some ports are available, are they the B9Creator?
         qDebug() << "Scanning For Serial Port Devices (" << pPorts->size() << "found )";
         for (int i = 0; i < pPorts->size(); i++) {
+            if(isOtherPrinting()) break; // started while we were waiting on the last port, don't keep blocking it
             qDebug() << "  port name   " << pPorts->at(i).portName;
             qDebug() << "  locationInfo" << pPorts->at(i).physName;
          #ifndef Q_WS_X11
@@ -277,26 +475,14 @@ void B9PrinterComm::RefreshCommPortItems()
             qDebug() << "  vendorID    " << pPorts->at(i).vendorID;
             qDebug() << "  productID   " << pPorts->at(i).productID;
          #endif
-         #ifdef Q_WS_X11
-            // linux ID's ports by physName
-            sPortName = pPorts->at(i).physName;
-            // We filter ports by requiring the portName to begin with "ttyA"
-            if(pPorts->at(i).portName.left(4) == "ttyA" && OpenB9CreatorCommPort(sPortName)){
-         #else
-            // Windows and OSX use portName to ID ports
-            sPortName = pPorts->at(i).portName;
-            // We filter ports by requiring vendorID value of 9025 (Arduino)
-            if(pPorts->at(i).vendorID==9025 && OpenB9CreatorCommPort(sPortName)){
-         #endif
+            if(isB9CreatorPort(pPorts->at(i), &sPortName) && OpenB9CreatorCommPort(sPortName)){
                 // Connected!
                 sCommPortStatus = MSG_CONNECTED;
                 sCommPortDetailedStatus = "Connected on Port: "+m_serialDevice->portName();
-                eTime = 5000;  // Re-check connection again in 5 seconds
                 if(m_serialDevice && m_Status.isCurrentVersion())startWatchDogTimer();  // Start B9Creator "crash" watchDog
                 break;
             }
         }
-        bool bUpdateFirmware = false;
         if( m_serialDevice==NULL && sNoFirmwareAurdinoPort!=""){
             // We did not find a B9Creator with valid firmware, but we did find an Arduino
             // We assume this is a new B9Creator and needs firmware!
@@ -323,6 +509,13 @@ void B9PrinterComm::RefreshCommPortItems()
             m_serialDevice = NULL;
             m_Status.reset();
         }
+        if(bUpdateFirmware && isOtherPrinting()){
+            // avrdude would block the GUI thread the other print's deadlines are served on
+            qDebug() << "Another printer is printing, firmware update on port" << sPortName << "put off until it is done";
+            bUpdateFirmware = false;
+            sCommPortStatus = MSG_SEARCHING;
+            sCommPortDetailedStatus = "Firmware update on port "+sPortName+" waits for the other printers to finish";
+        }
         if(bUpdateFirmware){
             // Update the firmware on device on sPortName
             emit updateConnectionStatus(MSG_FIRMUPDATE);
@@ -337,7 +530,7 @@ void B9PrinterComm::RefreshCommPortItems()
         emit updateConnectionStatus(sCommPortStatus);
         emit BC_ConnectionStatusDetailed(sCommPortDetailedStatus);
     }
-    QTimer::singleShot(eTime, this, SLOT(RefreshCommPortItems())); // Check again in 5 seconds if connected, 1 secs if not
+    return bUpdateFirmware;
 }
 
 bool B9PrinterComm::OpenB9CreatorCommPort(QString sPortName)
@@ -391,6 +584,64 @@ QString B9PrinterComm::errorString(){
     return m_serialDevice->errorString();
 }
 
+// What we know about each command character the printer broadcasts
+static int s_CommandFlags[128];
+static bool initCommandFlags()
+{
+    const int K = B9CommEvent::CF_KNOWN, N = B9CommEvent::CF_NUMERIC, Q = B9CommEvent::CF_QUIET;
+    for(int i=0; i<128; i++) s_CommandFlags[i] = 0;
+    s_CommandFlags['U'] = K;
+    s_CommandFlags['Q'] = K;
+    s_CommandFlags['P'] = K|N|Q;  // projector status, several a second, only logged when it changes
+    s_CommandFlags['L'] = K|N|Q;  // lamp hours, likewise
+    s_CommandFlags['X'] = K|N;
+    s_CommandFlags['R'] = K|N;
+    s_CommandFlags['K'] = K|N;
+    s_CommandFlags['D'] = K|N;
+    s_CommandFlags['E'] = K|N;
+    s_CommandFlags['H'] = K|N;
+    s_CommandFlags['I'] = K|N;
+    s_CommandFlags['A'] = K|N;
+    s_CommandFlags['J'] = K|N;
+    s_CommandFlags['M'] = K|N;
+    s_CommandFlags['Z'] = K|N;
+    s_CommandFlags['S'] = K|N;
+    s_CommandFlags['C'] = K;
+    s_CommandFlags['F'] = K;
+    s_CommandFlags['V'] = K;
+    s_CommandFlags['W'] = K;
+    s_CommandFlags['Y'] = K|N;
+    return true;
+}
+static bool s_bCommandFlagsInit = initCommandFlags();
+
+bool B9CommEvent::parse(const char* pLine, int iLen, B9CommEvent* pEvent)
+{
+    if(iLen<1) return false;
+    char c = pLine[0];
+    if(c>='a' && c<='z') c -= 'a'-'A';
+    pEvent->cCmd = c;
+    pEvent->iFlags = ((unsigned char)c<128) ? s_CommandFlags[(unsigned char)c] : 0;
+    pEvent->pText = pLine+1;
+    pEvent->iTextLen = iLen-1;
+    pEvent->iValue = 0;
+    if(!(pEvent->iFlags & CF_NUMERIC)) return true;
+
+    // optional white space and sign, digits, optional white space, anything else and the value is 0
+    const char* p = pEvent->pText;
+    const char* pEnd = p + pEvent->iTextLen;
+    while(p<pEnd && (*p==' ' || *p=='\t')) p++;
+    bool bNeg = false;
+    if(p<pEnd && (*p=='-' || *p=='+')) {bNeg = *p=='-'; p++;}
+    const char* pDigits = p;
+    int iValue = 0;
+    while(p<pEnd && *p>='0' && *p<='9') {iValue = iValue*10 + (*p-'0'); p++;}
+    bool bOk = p>pDigits;
+    while(p<pEnd && (*p==' ' || *p=='\t')) p++;
+    if(bOk && p==pEnd) pEvent->iValue = bNeg ? -iValue : iValue;
+    return true;
+}
+
 void B9PrinterComm::ReadAvailable() {
     if(m_serialDevice==NULL) qFatal("Error:  slot 'ReadAvailable()' but NULL Port Handle");
 
@@ -401,152 +652,192 @@ void B9PrinterComm::ReadAvailable() {
         // we'll set the status to HS_FOUND once we recieve a 'X' diff broadcast
     }
 
-    QByteArray ba = m_serialDevice->readAll();  // read block of available raw data
-
-    // We process the raw data one line at a time, keeping in mind they may be spread across multiple blocks.
-    int iCurPos = 0;
-    int iLampHrs = -1;
-    int iInput = -1;
-    char c;
-    while(iCurPos<ba.size()){
-        c = ba.at(iCurPos);
-        iCurPos++;
-        if(c!='\r') m_sSerialString+=QString(c);
-        if(c=='\n'){
-            // Line Read Complete, process data
-
-           if(m_sSerialString.left(1) != "P" && m_sSerialString.left(1) != "L" && m_sSerialString.length()>0){
-                // We only emit this data for display & log purposes
-                if(m_sSerialString.left(1) == "C"){
-                    qDebug() << m_sSerialString.right(m_sSerialString.length()-1) << "\n";
-                }
-                else{
-                    emit BC_RawData(m_sSerialString);
-                    qDebug() << m_sSerialString << "\n";
-                }
-            }
-
-            int iCmdID = m_sSerialString.left(1).toUpper().toAscii().at(0);
-            switch (iCmdID){
-            case 'U':  // Mechanical failure of encoder?
-                qDebug() << "WARNING:  Printer has sent 'U' report, runaway X Motor indication: " + m_sSerialString << "\n";
-                break;
-            case 'Q':  // Printer got tired of waiting for command and shut down projectors
-                       // We will likely never see this as something bad has happened
-                       // (like we have crashed or been shut off during a print process
-                       // So if we get it, we'll just post it to the log and wait for
-                       // timeouts to correct things.
-                qDebug() << "WARNING:  Printer has sent 'Q' report, lost comm with host." << "\n";
-                break;
-            case 'P':  // take care of projector status
-                iInput = m_sSerialString.right(m_sSerialString.length()-1).toInt();
-                if(iInput!=1)iInput = 0;
-                if(handleProjectorBC(iInput)){
-                    //projector status changed
-                    emit BC_RawData(m_sSerialString);
-                    qDebug() << m_sSerialString << "\n";
-                }
-                break;
-            case 'L':  // take care of projector Lamp hours update
-                iLampHrs = m_sSerialString.right(m_sSerialString.length()-1).toInt();
-                if(m_Status.getLampHrs()!= iLampHrs){
-                    m_Status.setLampHrs(iLampHrs);
-                    emit BC_ProjectorStatusChanged();
-                    emit BC_RawData(m_sSerialString);
-                    qDebug() << m_sSerialString << "\n";
-                }
-                break;
-
-            case 'X':  // Found Home with this Difference Offset
-                m_Status.setHomeStatus(B9PrinterStatus::HS_FOUND);
-                m_Status.setLastHomeDiff(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_HomeFound();
-                break;
-
-            case 'R':  // Needs Reset?
-                iInput = m_sSerialString.right(m_sSerialString.length()-1).toInt();
-                if(iInput==0) m_Status.setHomeStatus(B9PrinterStatus::HS_FOUND);
-                else m_Status.setHomeStatus(B9PrinterStatus::HS_UNKNOWN);
-                break;
-
-            case 'K':  // Current Lamp 1/2 life
-                m_Status.setHalfLife(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_HalfLife(m_Status.getHalfLife());
-                break;
-
-            case 'D':  // Current Native X Projector resolution
-                m_Status.setNativeX(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_NativeX(m_Status.getNativeX());
-                break;
-
-            case 'E':  // Current Native Y Projector resolution
-                m_Status.setNativeY(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_NativeY(m_Status.getNativeY());
-                break;
-
-            case 'H':  // Current XY Pixel Size
-                m_Status.setXYPixelSize(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_XYPixelSize(m_Status.getXYPixelSize());
-                break;
-
-            case 'I':  // Current PU
-                m_Status.setPU(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_PU(m_Status.getPU());
-                break;
-
-            case 'A':  // Projector Control capability
-                m_Status.setProjectorRemoteCapable(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_ProjectorRemoteCapable(m_Status.isProjectorRemoteCapable());
-                break;
-
-            case 'J':  // Projector Shutter capability
-                m_Status.setHasShutter(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_HasShutter(m_Status.hasShutter());
-                break;
-
-            case 'M':  // Current Z Upper Limit in PUs
-                m_Status.setUpperZLimPU(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_UpperZLimPU(m_Status.getUpperZLimPU());
-                break;
-
-            case 'Z':  // Current Z Position Update
-                m_Status.setCurZPosInPU(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_CurrentZPosInPU(m_Status.getCurZPosInPU());
-                break;
-
-            case 'S':  // Current Vat(Shutter) Percent Open Position Update
-                m_Status.setCurVatPercentOpen(m_sSerialString.right(m_sSerialString.length()-1).toInt());
-                emit BC_CurrentVatPercentOpen(m_Status.getCurVatPercentOpen());
-                break;
-
-            case 'C':  // Comment
-                emit BC_Comment(m_sSerialString.right(m_sSerialString.length()-1));
-                break;
-
-            case 'F':  // Print release cycle finished
-                emit BC_PrintReleaseCycleFinished();
-                break;
+    // Some of the slots our events reach open modal dialogs, whose event loop can call us again.
+    // Leave the data in the port, the outer call reads it once that slot returns so lines stay in order.
+    if(m_bInRead){
+        flushLog();
+        return;
+    }
+    m_bInRead = true;
+    while(m_serialDevice!=NULL && m_serialDevice->bytesAvailable()>0 && readLines());
+    m_bInRead = false;
+    flushLog();
+}
 
-            case 'V':  // Version
-                m_Status.setVersion(m_sSerialString.right(m_sSerialString.length()-1).trimmed());
-                emit BC_FirmVersion(m_Status.getVersion());
-                break;
+bool B9PrinterComm::readLines()
+{
+    // Read straight in behind any partial line left from the last block
+    qint64 iAvail = m_serialDevice->bytesAvailable();
+    if(m_iRxLen + iAvail > m_baRx.size()) m_baRx.resize(m_iRxLen + iAvail);
+    qint64 iRead = m_serialDevice->read(m_baRx.data() + m_iRxLen, iAvail);
+    if(iRead<=0) return false;
+    m_iRxLen += iRead;
+
+    // Take the complete lines out and keep the partial one for next time, before anything is dispatched
+    char* pBuf = m_baRx.data();
+    char* pLast = pBuf + m_iRxLen - 1;
+    while(pLast>=pBuf && *pLast!='\n') pLast--;
+    QByteArray baLines(pBuf, pLast + 1 - pBuf);
+    m_iRxLen = pBuf + m_iRxLen - (pLast + 1);
+    if(m_iRxLen > RXBUFFERSIZE){
+        m_vLogBatch.append("WARNING:  Dropped " + QString::number(m_iRxLen) + " bytes of unterminated printer data");
+        m_iRxLen = 0;
+    }
+    else if(m_iRxLen>0 && pLast>=pBuf) memmove(pBuf, pLast + 1, m_iRxLen);
+    if(m_baRx.size() > RXBUFFERSIZE && m_iRxLen <= RXBUFFERSIZE) m_baRx.resize(RXBUFFERSIZE);
+
+    // We process the raw data one line at a time, lines may be spread across multiple blocks.
+    char* pLine = baLines.data();
+    char* pEnd = pLine + baLines.size();
+    char* pEOL;
+    B9CommEvent vEvent;
+    while(pLine<pEnd && (pEOL = (char*)memchr(pLine, '\n', pEnd - pLine)) != NULL){
+        // drop carriage returns, in place (they are normally only at the end of the line)
+        char* pLineEnd = pEOL;
+        if(memchr(pLine, '\r', pEOL - pLine) != NULL){
+            pLineEnd = pLine;
+            for(char* p = pLine; p<pEOL; p++) if(*p!='\r') *pLineEnd++ = *p;
+        }
+        if(B9CommEvent::parse(pLine, pLineEnd - pLine, &vEvent)) handleEvent(vEvent);
+        pLine = pEOL + 1;
+    }
+    return true;
+}
 
-            case 'W':  // Model
-                m_Status.setModel(m_sSerialString.right(m_sSerialString.length()-1).trimmed());
-                emit BC_ModelInfo(m_Status.getModel());
-                break;
+void B9PrinterComm::flushLog()
+{
+    if(m_vLogBatch.isEmpty()) return;
+    qDebug() << qPrintable(m_vLogBatch.join("\n"));
+    m_vLogBatch.clear();
+}
 
-            case 'Y':  // Current Z Home position in PU's
-                // ignored
-                break;
+void B9PrinterComm::handleEvent(const B9CommEvent &vEvent)
+{
+    if(!(vEvent.iFlags & B9CommEvent::CF_QUIET)){
+        // We only emit this data for display & log purposes
+        if(vEvent.cCmd == 'C'){
+            m_vLogBatch.append(vEvent.text());
+        }
+        else{
+            emit BC_RawData(vEvent.line()+"\n");
+            m_vLogBatch.append(vEvent.line());
+        }
+    }
 
-            default:
-                qDebug() <<"WARNING:  IGNORED UNKNOWN CMD:  " << m_sSerialString << "\n";
-                break;
-            }
-            m_sSerialString=""; // Line processed, clear it for next line
+    switch (vEvent.cCmd){
+    case 'U':  // Mechanical failure of encoder?
+        m_vLogBatch.append("WARNING:  Printer has sent 'U' report, runaway X Motor indication: " + vEvent.line());
+        break;
+    case 'Q':  // Printer got tired of waiting for command and shut down projectors
+               // We will likely never see this as something bad has happened
+               // (like we have crashed or been shut off during a print process
+               // So if we get it, we'll just post it to the log and wait for
+               // timeouts to correct things.
+        m_vLogBatch.append("WARNING:  Printer has sent 'Q' report, lost comm with host.");
+        break;
+    case 'P':  // take care of projector status
+        if(handleProjectorBC(vEvent.iValue==1 ? 1 : 0)){
+            //projector status changed
+            emit BC_RawData(vEvent.line()+"\n");
+            m_vLogBatch.append(vEvent.line());
+        }
+        break;
+    case 'L':  // take care of projector Lamp hours update
+        if(m_Status.getLampHrs()!= vEvent.iValue){
+            m_Status.setLampHrs(vEvent.iValue);
+            emit BC_ProjectorStatusChanged();
+            emit BC_RawData(vEvent.line()+"\n");
+            m_vLogBatch.append(vEvent.line());
         }
+        break;
+
+    case 'X':  // Found Home with this Difference Offset
+        m_Status.setHomeStatus(B9PrinterStatus::HS_FOUND);
+        m_Status.setLastHomeDiff(vEvent.iValue);
+        emit BC_HomeFound();
+        break;
+
+    case 'R':  // Needs Reset?
+        if(vEvent.iValue==0) m_Status.setHomeStatus(B9PrinterStatus::HS_FOUND);
+        else m_Status.setHomeStatus(B9PrinterStatus::HS_UNKNOWN);
+        break;
+
+    case 'K':  // Current Lamp 1/2 life
+        m_Status.setHalfLife(vEvent.iValue);
+        emit BC_HalfLife(m_Status.getHalfLife());
+        break;
+
+    case 'D':  // Current Native X Projector resolution
+        m_Status.setNativeX(vEvent.iValue);
+        emit BC_NativeX(m_Status.getNativeX());
+        break;
+
+    case 'E':  // Current Native Y Projector resolution
+        m_Status.setNativeY(vEvent.iValue);
+        emit BC_NativeY(m_Status.getNativeY());
+        break;
+
+    case 'H':  // Current XY Pixel Size
+        m_Status.setXYPixelSize(vEvent.iValue);
+        emit BC_XYPixelSize(m_Status.getXYPixelSize());
+        break;
+
+    case 'I':  // Current PU
+        m_Status.setPU(vEvent.iValue);
+        emit BC_PU(m_Status.getPU());
+        break;
+
+    case 'A':  // Projector Control capability
+        m_Status.setProjectorRemoteCapable(vEvent.iValue);
+        emit BC_ProjectorRemoteCapable(m_Status.isProjectorRemoteCapable());
+        break;
+
+    case 'J':  // Projector Shutter capability
+        m_Status.setHasShutter(vEvent.iValue);
+        emit BC_HasShutter(m_Status.hasShutter());
+        break;
+
+    case 'M':  // Current Z Upper Limit in PUs
+        m_Status.setUpperZLimPU(vEvent.iValue);
+        emit BC_UpperZLimPU(m_Status.getUpperZLimPU());
+        break;
+
+    case 'Z':  // Current Z Position Update
+        m_Status.setCurZPosInPU(vEvent.iValue);
+        emit BC_CurrentZPosInPU(m_Status.getCurZPosInPU());
+        break;
+
+    case 'S':  // Current Vat(Shutter) Percent Open Position Update
+        m_Status.setCurVatPercentOpen(vEvent.iValue);
+        emit BC_CurrentVatPercentOpen(m_Status.getCurVatPercentOpen());
+        break;
+
+    case 'C':  // Comment
+        emit BC_Comment(vEvent.text()+"\n");
+        break;
+
+    case 'F':  // Print release cycle finished
+        m_sPendingCycle.clear();
+        emit BC_PrintReleaseCycleFinished();
+        break;
+
+    case 'V':  // Version
+        m_Status.setVersion(vEvent.text().trimmed());
+        emit BC_FirmVersion(m_Status.getVersion());
+        break;
+
+    case 'W':  // Model
+        m_Status.setModel(vEvent.text().trimmed());
+        emit BC_ModelInfo(m_Status.getModel());
+        break;
+
+    case 'Y':  // Current Z Home position in PU's
+        // ignored
+        break;
+
+    default:
+        m_vLogBatch.append("WARNING:  IGNORED UNKNOWN CMD:  " + vEvent.line());
+        break;
     }
 }
 
@@ -625,7 +916,7 @@ bool B9PrinterComm::handleProjectorBC(int iBC){
             bStatusChanged = true;
             break;
         case B9PrinterStatus::PS_WARMING:
-            if(startWarmingTime.elapsed()>m_iWarmUpDelayMS){
+            if(startWarmingTime.elapsed()>m_iWarmUpDelayMS/timeScale()){
                 // All warmed up now, ready to use.
                 m_Status.setProjectorStatus(B9PrinterStatus::PS_ON);
                 emit BC_ProjectorStatusChanged();
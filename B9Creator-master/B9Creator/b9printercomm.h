@@ -41,6 +41,7 @@
 #include <QObject>
 #include <QTime>
 #include <QtDebug>
+#include <QStringList>
 
 // The Firmware version is tied to a specific version
 // These defines determine how we attempt to update Firmware
@@ -51,8 +52,14 @@
 #define MSG_CONNECTED "Connected"
 #define MSG_FIRMUPDATE "Updating Firmware..."
 
+#define RXBUFFERSIZE 4096   // bytes of unframed input we hold, a line longer than this is garbage and dropped
+#define CMDSETTINGS "DEJKLWX" // commands that only set a cycle parameter, a newer one replaces a queued one
+#define HOTPLUGSETTLEMS 500     // wait after a port appears before we probe it, the device node may not be ready
+#define HOTPLUGFALLBACKMS 30000 // full port scan interval while searching when we also get hotplug notices
+
 
 class  QextSerialPort;
+class  QTimer;
 class  QextSerialEnumerator;
 struct QextPortInfo;
 
@@ -172,6 +179,21 @@ private:
     QString sHexFilePath;
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// One broadcast line from the printer, parsed in place without allocating
+struct B9CommEvent {
+    enum Flags{CF_KNOWN=1, CF_NUMERIC=2, CF_QUIET=4};
+    char cCmd;          // command character, upper cased
+    int iFlags;         // from the command table
+    int iValue;         // numeric payload for CF_NUMERIC commands, 0 if it doesn't parse (like QString::toInt)
+    const char* pText;  // payload after the command character, points into the receive buffer
+    int iTextLen;
+
+    static bool parse(const char* pLine, int iLen, B9CommEvent* pEvent); // false for an empty line
+    QString line() const {return QString(cCmd)+QString::fromLatin1(pText, iTextLen);}
+    QString text() const {return QString::fromLatin1(pText, iTextLen);}
+};
+
 /////////////////////////////////////////////////////////////////////////////
 //  The B9PrinterComm should be created once by the main window
 //  and shared by and class that needs signal/slot access
@@ -184,6 +206,11 @@ public:
     ~B9PrinterComm();
 
     bool isConnected(){return m_Status.isValidVersion();}
+    bool isSimulated(); // true if we are talking to the firmware simulator, not a printer
+    double timeScale(); // how much faster than real time the printer runs, the simulator's time scale or 1.0
+    static void addVirtualPort(QString sPortName, double dTimeScale = 1.0){s_vVirtualPorts.append(sPortName); s_vVirtualScales.append(dTimeScale);} // extra port to search, e.g. a simulator's pty
+    void setPort(QString sPortName){m_sFixedPort = sPortName;} // only connect on this port, empty to search them all
+    QString getPort(){return m_sFixedPort;}
     void enableBlankCloning(bool bEnable){m_bCloneBlanks = bEnable;}
 
     void cmdProjectorPowerOn(bool bOn){m_Status.cmdProjectorPowerOn(bOn);}
@@ -192,6 +219,7 @@ public:
     int getLampHrs(){return m_Status.getLampHrs();}
     int getPU(){return m_Status.getPU();}
     int getUpperZLimPU(){return m_Status.getUpperZLimPU();}
+    int getCurZPosInPU(){return m_Status.getCurZPosInPU();}
     int getHalfLife(){return m_Status.getHalfLife();}
     int getNativeX(){return m_Status.getNativeX();}
     int getNativeY(){return m_Status.getNativeY();}
@@ -201,6 +229,11 @@ public:
     void setHomeStatus(B9PrinterStatus::HomeStatus eHS) {m_Status.setHomeStatus(eHS);}
     QString errorString();
 
+    void queueCmd(QString sCmd);  // held until flushCmds() or the next SendCmd()
+    void flushCmds();             // everything queued goes out in one write
+    int getQueuedCmds(){return m_vTxQueue.count();}
+    QString getPendingCycle(){return m_sPendingCycle;} // B, N or F command the printer has not reported finished, empty if none
+
 signals:
     void updateConnectionStatus(QString sText); // Connected or Searching
     void BC_ConnectionStatusDetailed(QString sText); // Connected or Searching
@@ -235,6 +268,9 @@ public slots:
 private slots:
     void ReadAvailable();
     void RefreshCommPortItems();
+    void onPortAdded(const QextPortInfo &vInfo);
+    void onPortRemoved(const QextPortInfo &vInfo);
+    void probeNewPorts();
     void watchDog();  // Checks to see we're receiving regular updates from the Ardunio
 
 public:
@@ -244,13 +280,34 @@ private:
     QextSerialPort *m_serialDevice;
     QextSerialEnumerator *pEnumerator;		// enumerator for finding available comm ports
     QList<QextPortInfo> *pPorts;			// list of available comm ports
+    QList<QextPortInfo> *pNewPorts;         // ports we were notified of and have not probed yet
+    bool m_bHotplug;                        // pEnumerator tells us when ports come and go, we don't need to poll
+    QTimer *m_pRefreshTimer;                // next full scan, see scheduleRefresh
     QString sNoFirmwareAurdinoPort;         // if we locate an arduino without firmware, set this to the portname as a flag
     bool m_bCloneBlanks;                    // if false, we will not burn firmware into suspected blank Arduinos
 
-    QString m_sSerialString; // Used by ReadAvailable to store current broadcast line
+    QStringList m_vTxQueue;   // commands not yet written, see queueCmd
+    QString m_sPendingCycle;  // outstanding release cycle command
+    QByteArray m_baRx;  // Used by ReadAvailable to hold input until we have whole lines
+    int m_iRxLen;       // bytes of m_baRx in use
+    QStringList m_vLogBatch; // lines for the log, written with one qDebug per read
+    bool m_bInRead;          // ReadAvailable is dispatching, a nested call leaves the data for it
+    bool readLines();        // one read from the port, false if nothing came
+    void flushLog();         // writes m_vLogBatch, call before any other qDebug so the log stays in order
+    void handleEvent(const B9CommEvent &vEvent);
     B9PrinterStatus m_Status;
+    static QStringList s_vVirtualPorts;
+    static QList<double> s_vVirtualScales; // time scale of each virtual port's simulator
+    static QList<B9PrinterComm*> s_vInstances; // every comm in this process, so they don't fight over ports
+    QString m_sFixedPort;
+    bool isPortInUse(QString sPortName); // open, or being probed, by another B9PrinterComm
+    bool isOtherPrinting(); // another B9PrinterComm in this process is printing, we must not block its GUI thread
 
     bool OpenB9CreatorCommPort(QString sPortName);
+    bool isB9CreatorPort(const QextPortInfo &vInfo, QString *pPortName); // passes our port filters
+    QString portId(const QextPortInfo &vInfo); // the name we open the port by
+    bool searchPorts(); // true if we flashed firmware, scan again soon
+    void scheduleRefresh(bool bSoon = false);
     void startWatchDogTimer();
     void handleLostComm();
     bool handleProjectorBC(int iBC);
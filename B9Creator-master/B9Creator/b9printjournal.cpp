@@ -0,0 +1,145 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QtDebug>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "b9printjournal.h"
+
+QString B9PrintJournal::defaultFileName(QString sPrinterName)
+{
+    if(sPrinterName.isEmpty()) return QCoreApplication::applicationDirPath()+"/B9Creator_PrintJournal.txt";
+    return QCoreApplication::applicationDirPath()+"/B9Creator_PrintJournal_"+sPrinterName+".txt";
+}
+
+bool B9PrintJournal::write(const B9PrintCheckpoint &vCheckpoint)
+{
+    if(m_sFileName.isEmpty()) return false;
+    QString sTemp = m_sFileName+".tmp";
+    QFile file(sTemp);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        qDebug() << "Print Journal:  Unable to write" << sTemp;
+        return false;
+    }
+    {
+        QTextStream ts(&file);
+        ts << "JobFile=" << vCheckpoint.sJobFile << "\n";
+        ts << "JobName=" << vCheckpoint.sJobName << "\n";
+        ts << "LastLayer=" << vCheckpoint.iLastLayer << "\n";
+        ts << "Layer=" << vCheckpoint.iLayer << "\n";
+        ts << "ZPU=" << vCheckpoint.iZPU << "\n";
+        ts << "LayerThicknessMM=" << QString::number(vCheckpoint.dLayerThicknessMM,'g',10) << "\n";
+        ts << "Tbase=" << vCheckpoint.iTbase << "\n";
+        ts << "Tover=" << vCheckpoint.iTover << "\n";
+        ts << "Tattach=" << vCheckpoint.iTattach << "\n";
+        ts << "NumAttach=" << vCheckpoint.iNumAttach << "\n";
+        ts << "XOff=" << vCheckpoint.iXOff << "\n";
+        ts << "YOff=" << vCheckpoint.iYOff << "\n";
+        ts << "State=" << vCheckpoint.sState << "\n";
+        ts << "Note=" << QString(vCheckpoint.sNote).replace('\n',' ') << "\n";
+        ts << "Time=" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+        ts << "End\n"; // a journal without this was cut short
+    }
+    file.flush();
+#ifdef Q_OS_WIN
+    _commit(file.handle());
+#else
+    fsync(file.handle());
+#endif
+    file.close();
+
+    // QFile::rename won't replace an existing file
+    QFile::remove(m_sFileName);
+    if(!QFile::rename(sTemp, m_sFileName)){
+        qDebug() << "Print Journal:  Unable to replace" << m_sFileName;
+        return false;
+    }
+    return true;
+}
+
+void B9PrintJournal::clear()
+{
+    if(m_sFileName.isEmpty()) return;
+    QFile::remove(m_sFileName);
+    QFile::remove(m_sFileName+".tmp");
+}
+
+bool B9PrintJournal::read(QString sFileName, B9PrintCheckpoint* pCheckpoint)
+{
+    // If we crashed between the remove and the rename in write() only the temporary file is left
+    QFile file(sFileName);
+    if(!file.exists()) file.setFileName(sFileName+".tmp");
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+
+    B9PrintCheckpoint vCP;
+    bool bEnd = false;
+    QTextStream ts(&file);
+    while(!ts.atEnd()){
+        QString sLine = ts.readLine();
+        if(sLine=="End"){bEnd = true; break;}
+        int iEq = sLine.indexOf('=');
+        if(iEq<1) continue;
+        QString sKey = sLine.left(iEq);
+        QString sValue = sLine.mid(iEq+1);
+        if(sKey=="JobFile") vCP.sJobFile = sValue;
+        else if(sKey=="JobName") vCP.sJobName = sValue;
+        else if(sKey=="LastLayer") vCP.iLastLayer = sValue.toInt();
+        else if(sKey=="Layer") vCP.iLayer = sValue.toInt();
+        else if(sKey=="ZPU") vCP.iZPU = sValue.toInt();
+        else if(sKey=="LayerThicknessMM") vCP.dLayerThicknessMM = sValue.toDouble();
+        else if(sKey=="Tbase") vCP.iTbase = sValue.toInt();
+        else if(sKey=="Tover") vCP.iTover = sValue.toInt();
+        else if(sKey=="Tattach") vCP.iTattach = sValue.toInt();
+        else if(sKey=="NumAttach") vCP.iNumAttach = sValue.toInt();
+        else if(sKey=="XOff") vCP.iXOff = sValue.toInt();
+        else if(sKey=="YOff") vCP.iYOff = sValue.toInt();
+        else if(sKey=="State") vCP.sState = sValue;
+        else if(sKey=="Note") vCP.sNote = sValue;
+        else if(sKey=="Time") vCP.vTime = QDateTime::fromString(sValue, Qt::ISODate);
+    }
+    if(!bEnd || !vCP.isValid()) return false;
+    *pCheckpoint = vCP;
+    return true;
+}
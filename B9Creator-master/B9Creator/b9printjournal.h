@@ -0,0 +1,87 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTJOURNAL_H
+#define B9PRINTJOURNAL_H
+
+#include <QString>
+#include <QDateTime>
+
+// Where an interrupted print can pick up again
+struct B9PrintCheckpoint {
+    B9PrintCheckpoint(){iLastLayer = iLayer = iZPU = -1; dLayerThicknessMM = 0.0; iTbase = iTover = iTattach = 0; iNumAttach = 1; iXOff = iYOff = 0;}
+    bool isValid(){return iLayer>0 && iLayer<iLastLayer && iZPU>=0;}
+
+    QString sJobFile;       // the .b9j, when known
+    QString sJobName;
+    int iLastLayer;         // layers in the print
+    int iLayer;             // layers completely exposed, the one to resume with
+    int iZPU;               // where the build table was last sent, in printer units
+    double dLayerThicknessMM;
+    int iTbase, iTover, iTattach, iNumAttach;
+    int iXOff, iYOff;
+    QString sState;         // "Printing" or "Aborted"
+    QString sNote;          // abort reason
+    QDateTime vTime;
+};
+
+/******************************************************
+B9PrintJournal keeps the checkpoint of the print in
+progress in a small text file.  Each write goes to a
+temporary file that is synced to disk and then renamed
+over the journal, so a crash at any point leaves either
+the old checkpoint or the new one.
+******************************************************/
+class B9PrintJournal
+{
+public:
+    B9PrintJournal(){}
+
+    void setFileName(QString sFileName){m_sFileName = sFileName;}
+    QString fileName(){return m_sFileName;}
+    static QString defaultFileName(QString sPrinterName = ""); // next to the executable, one per printer
+
+    bool write(const B9PrintCheckpoint &vCheckpoint);
+    void clear();  // print finished or abandoned, nothing to resume
+    static bool read(QString sFileName, B9PrintCheckpoint* pCheckpoint); // false if there is no usable checkpoint
+
+private:
+    QString m_sFileName;
+};
+
+#endif // B9PRINTJOURNAL_H
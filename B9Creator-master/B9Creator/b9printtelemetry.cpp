@@ -0,0 +1,156 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#include <QDesktopServices>
+#include <QDir>
+#include <QDateTime>
+#include <QtDebug>
+#include "b9printtelemetry.h"
+
+B9PrintTelemetry::B9PrintTelemetry()
+{
+    reset();
+}
+
+void B9PrintTelemetry::reset()
+{
+    m_iTotalLayers = 0;
+    m_iLayer = -1;
+    m_dZMM = 0.0;
+    m_dReleaseStartMS = m_dReleaseMS = m_dExposureStartMS = m_dPrepMS = 0.0;
+    m_iCycleMS = m_iCycleEstMS = -1;
+    m_iLayersLogged = m_iOverrunLayers = 0;
+    m_dTotReleaseMS = m_dTotCycleMS = m_dTotCycleEstMS = m_dTotPrepMS = 0.0;
+    m_dTotExposurePlannedMS = m_dTotExposureMS = m_dWorstOverrunMS = m_dWorstJitterMS = 0.0;
+    m_dTotInflateMS = m_dTotToverMapMS = m_dTotMaskMS = m_dTotClearMS = 0.0;
+}
+
+void B9PrintTelemetry::startPrint(QString sJobName, int iTotalLayers, QString sFileName)
+{
+    finishPrint("Restarted");
+    reset();
+    m_sJobName = sJobName;
+    m_iTotalLayers = iTotalLayers;
+    m_Clock.start();
+
+    // The application directory is often read only once installed, so this goes in the user's data location
+    QString sPath = QDesktopServices::storageLocation(QDesktopServices::DataLocation);
+    if(sPath.isEmpty() || !QDir().mkpath(sPath)) sPath = QDir::tempPath();
+    m_File.setFileName(sPath+"/"+sFileName);
+    if(!m_File.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)){
+        qDebug() << "Unable to open print timing log" << m_File.fileName();
+        return;
+    }
+    qDebug() << "Print timing log:" << m_File.fileName();
+    m_Stream.setDevice(&m_File);
+    m_Stream << "# B9Creator print timing, job: " << m_sJobName << ", layers: " << m_iTotalLayers
+             << ", started: " << QDateTime::currentDateTime().toString("yy.MM.dd hh:mm:ss") << "\n";
+    m_Stream << "layer,z_mm,release_start_ms,release_ms,cycle_ms,cycle_est_ms,prep_ms,fetch_ms,inflate_ms,tover_map_ms,mask_ms,draw_ms,"
+                "exposure_start_ms,exposure_planned_ms,exposure_ms,overrun_ms,worst_jitter_ms,tover_steps,tover_steps_shown,clear_ms,worst_paint_ms\n";
+}
+
+void B9PrintTelemetry::releaseStarted(int iLayer, double dZMM)
+{
+    m_iLayer = iLayer;
+    m_dZMM = dZMM;
+    m_dReleaseStartMS = nowMS();
+}
+
+void B9PrintTelemetry::releaseFinished(int iCycleMS, int iCycleEstMS)
+{
+    m_dReleaseMS = nowMS() - m_dReleaseStartMS;
+    m_iCycleMS = iCycleMS;
+    m_iCycleEstMS = iCycleEstMS;
+    m_dPrepMS = nowMS(); // until the image is out there
+}
+
+void B9PrintTelemetry::exposureStarted()
+{
+    m_dExposureStartMS = nowMS();
+    m_dPrepMS = m_dExposureStartMS - m_dPrepMS;
+}
+
+void B9PrintTelemetry::exposureFinished(double dPlannedMS, double dActualMS, double dWorstJitterMS, int iToverSteps, int iToverStepsShown, B9FrameTiming vFrame)
+{
+    if(!isActive()) return;
+    double dOverrunMS = dActualMS - dPlannedMS;
+    m_Stream << m_iLayer << "," << QString::number(m_dZMM,'f',4) << ","
+             << QString::number(m_dReleaseStartMS,'f',1) << "," << QString::number(m_dReleaseMS,'f',1) << ","
+             << m_iCycleMS << "," << m_iCycleEstMS << "," << QString::number(m_dPrepMS,'f',2) << ","
+             << QString::number(vFrame.dFetchMS,'f',2) << ","
+             << QString::number(vFrame.dInflateMS,'f',2) << "," << QString::number(vFrame.dToverMapMS,'f',2) << ","
+             << QString::number(vFrame.dMaskMS,'f',2) << "," << QString::number(vFrame.dDrawMS,'f',2) << ","
+             << QString::number(m_dExposureStartMS,'f',1) << "," << QString::number(dPlannedMS,'f',2) << ","
+             << QString::number(dActualMS,'f',2) << "," << QString::number(dOverrunMS,'f',2) << ","
+             << QString::number(dWorstJitterMS,'f',2) << "," << iToverSteps << "," << iToverStepsShown << ","
+             << QString::number(vFrame.dClearMS,'f',2) << "," << QString::number(vFrame.dPaintMS,'f',2) << "\n";
+
+    m_iLayersLogged++;
+    m_dTotReleaseMS += m_dReleaseMS;
+    if(m_iCycleMS>0) m_dTotCycleMS += m_iCycleMS;
+    if(m_iCycleEstMS>0) m_dTotCycleEstMS += m_iCycleEstMS;
+    m_dTotPrepMS += m_dPrepMS;
+    m_dTotExposurePlannedMS += dPlannedMS;
+    m_dTotExposureMS += dActualMS;
+    m_dTotInflateMS += vFrame.dInflateMS;
+    m_dTotToverMapMS += vFrame.dToverMapMS;
+    m_dTotMaskMS += vFrame.dMaskMS;
+    m_dTotClearMS += vFrame.dClearMS;
+    if(dOverrunMS > 1.0) m_iOverrunLayers++;
+    if(dOverrunMS > m_dWorstOverrunMS) m_dWorstOverrunMS = dOverrunMS;
+    if(dWorstJitterMS > m_dWorstJitterMS) m_dWorstJitterMS = dWorstJitterMS;
+}
+
+void B9PrintTelemetry::finishPrint(QString sResult)
+{
+    if(!isActive()) return;
+    double dTotalMS = nowMS();
+    QString sSummary = "Print " + sResult + ": " + QString::number(m_iLayersLogged) + " of " + QString::number(m_iTotalLayers) +
+            " layers in " + QString::number(dTotalMS/1000.0,'f',1) + " s.  Release " + QString::number(m_dTotReleaseMS/1000.0,'f',1) +
+            " s (printer cycles " + QString::number(m_dTotCycleMS/1000.0,'f',1) + " s, estimated " + QString::number(m_dTotCycleEstMS/1000.0,'f',1) +
+            " s), frame prep " + QString::number(m_dTotPrepMS/1000.0,'f',1) + " s (inflate " + QString::number(m_dTotInflateMS/1000.0,'f',1) +
+            " s, Tover map " + QString::number(m_dTotToverMapMS/1000.0,'f',1) + " s, mask " + QString::number(m_dTotMaskMS/1000.0,'f',1) +
+            " s), exposure " + QString::number(m_dTotExposureMS/1000.0,'f',1) + " s of " + QString::number(m_dTotExposurePlannedMS/1000.0,'f',1) +
+            " s planned (Tover clearing " + QString::number(m_dTotClearMS/1000.0,'f',1) + " s).  " + QString::number(m_iOverrunLayers) +
+            " layers overran, worst by " + QString::number(m_dWorstOverrunMS,'f',1) + " ms, worst step jitter " + QString::number(m_dWorstJitterMS,'f',1) + " ms.";
+    m_Stream << "# " << sSummary << "\n";
+    m_Stream.flush();
+    m_Stream.setDevice(0);
+    m_File.close();
+    qDebug() << sSummary;
+}
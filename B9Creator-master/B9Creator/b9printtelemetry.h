@@ -0,0 +1,91 @@
+/*************************************************************************************
+//
+//  LICENSE INFORMATION
+//
+//  BCreator(tm)
+//  Software for the control of the 3D Printer, "B9Creator"(tm)
+//
+//  Copyright 2011-2012 B9Creations, LLC
+//  B9Creations(tm) and B9Creator(tm) are trademarks of B9Creations, LLC
+//
+//  This file is part of B9Creator
+//
+//    B9Creator is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    B9Creator is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with B9Creator .  If not, see <http://www.gnu.org/licenses/>.
+//
+//  The above copyright notice and this permission notice shall be
+//    included in all copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+//    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+//    LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+//    WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+*************************************************************************************/
+
+#ifndef B9PRINTTELEMETRY_H
+#define B9PRINTTELEMETRY_H
+
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include "b9projector.h"
+
+/******************************************************
+B9PrintTelemetry records where the wall clock time goes
+for every layer of a print and writes one CSV row per
+layer, with a summary appended when the print ends.
+All timestamps are ms from the start of the print.
+******************************************************/
+class B9PrintTelemetry
+{
+public:
+    B9PrintTelemetry();
+    ~B9PrintTelemetry(){finishPrint("Closed");}
+
+    void startPrint(QString sJobName, int iTotalLayers, QString sFileName = "B9Creator_PrintTiming.csv");
+    void finishPrint(QString sResult);  // writes the summary and closes the log
+    bool isActive(){return m_File.isOpen();}
+
+    void releaseStarted(int iLayer, double dZMM);  // motion command sent for iLayer
+    void releaseFinished(int iCycleMS, int iCycleEstMS);  // printer reported the cycle done, image about to go out
+    void exposureStarted();  // image is on the projector
+    void exposureFinished(double dPlannedMS, double dActualMS, double dWorstJitterMS, int iToverSteps, int iToverStepsShown, B9FrameTiming vFrame);
+
+private:
+    void reset();
+    double nowMS(){return (double)m_Clock.nsecsElapsed()/1000000.0;}
+
+    QFile m_File;
+    QTextStream m_Stream;
+    QElapsedTimer m_Clock;
+    QString m_sJobName;
+    int m_iTotalLayers;
+
+    // current layer
+    int m_iLayer;
+    double m_dZMM;
+    double m_dReleaseStartMS, m_dReleaseMS, m_dExposureStartMS, m_dPrepMS;
+    int m_iCycleMS, m_iCycleEstMS;
+
+    // print totals for the summary
+    int m_iLayersLogged, m_iOverrunLayers;
+    double m_dTotReleaseMS, m_dTotCycleMS, m_dTotCycleEstMS, m_dTotPrepMS;
+    double m_dTotExposurePlannedMS, m_dTotExposureMS, m_dWorstOverrunMS, m_dWorstJitterMS;
+    double m_dTotInflateMS, m_dTotToverMapMS, m_dTotMaskMS, m_dTotClearMS;
+};
+
+#endif // B9PRINTTELEMETRY_H
@@ -37,8 +37,11 @@
 *************************************************************************************/
 
 #include <QtGui>
+#include <QElapsedTimer>
 #include "b9projector.h"
 
+QHash<QString, QImage> B9Projector::s_NormalizedMaskCache;
+
 B9Projector::B9Projector(bool bPrintWindow, QWidget *parent, Qt::WFlags flags)
 	: QWidget(parent, flags)
 {
@@ -47,6 +50,7 @@ B9Projector::B9Projector(bool bPrintWindow, QWidget *parent, Qt::WFlags flags)
     m_bGrid = true;
 	mStatusMsg = "B9Creator - www.b9creator.com";
 	mpCPJ = NULL;
+    m_pFrameCache = NULL;
 	m_xOffset = m_yOffset = 0;
     m_bIsPrintWindow = bPrintWindow;
     m_iLevel = -1;
@@ -92,59 +96,97 @@ void B9Projector::setCPJ(CrushedPrintJob * pCPJ)
 {
     m_iLevel = -1;
 	mpCPJ = pCPJ;
+    if(mpCPJ!=NULL) m_FrameTiming = B9FrameTiming();
+    QElapsedTimer vTimer;
+    vTimer.start();
 	drawAll();
+    if(mpCPJ!=NULL) m_FrameTiming.dDrawMS = vTimer.nsecsElapsed()/1000000.0;
 }
 
 bool B9Projector::clearTimedPixels(int iLevel)
 {
-    int width = mCurSliceImage.width();
-    int height = mCurSliceImage.height();
-    QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+    QElapsedTimer vTimer;
+    vTimer.start();
     bool bAllClear = true;
 //    qDebug() <<"iLevel " <<iLevel;
-    m_iLevel = iLevel;
+    if(iLevel>255) iLevel = 255;
 
-    // clear the mCurSliceImage image as required
+    // clear the mCurSliceImage image as required, the pixels are bucketed by Tover level
+    // so we only visit the ones that go dark at this step
     // if all the pixels are cleared, return true
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++){
-            if((uchar)m_vToverMap[x+y*width]<=(uchar)m_iLevel)
-                pixels[x+y*width] = qRgba(0,0,0,0);
-            if(bAllClear && qAlpha(pixels[x+y*width])>0)bAllClear = false;
-        }
+    if(m_vLevelStart.size()==257 && !mCurSliceImage.isNull()){
+        QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+        const int *pStart = m_vLevelStart.constData();
+        const int *pPixels = m_vLevelPixels.constData();
+        for (int l = qMax(m_iLevel+1, 0); l <= iLevel; l++)
+            for (int i = pStart[l]; i < pStart[l+1]; i++)
+                pixels[pPixels[i]] = qRgba(0,0,0,0);
+        if(iLevel>=0) bAllClear = pStart[qMax(iLevel, m_iLevel)+1] >= m_vLevelPixels.size();
+        else bAllClear = m_vLevelPixels.isEmpty();
     }
+    if(iLevel>m_iLevel) m_iLevel = iLevel;
     drawAll();
+    m_FrameTiming.dClearMS += vTimer.nsecsElapsed()/1000000.0;
+    m_FrameTiming.iClears++;
     return bAllClear;
 }
 
 
 void B9Projector::createToverMap(int iRadius)
+{
+    createToverMap(iRadius, mCurSliceImage, m_vToverMap);
+    createLevelBuckets(mCurSliceImage, m_vToverMap, m_vLevelStart, m_vLevelPixels);
+}
+
+void B9Projector::createToverMap(int iRadius, const QImage &vSlice, QByteArray &vToverMap)
 {
     switch (iRadius){
     case 0:
-        createToverMap0();
+        createToverMap0(vSlice, vToverMap);
         break;
     case 1:
-        createToverMap1();
+        createToverMap1(vSlice, vToverMap);
         break;
     case 2:
-        createToverMap2();
+        createToverMap2(vSlice, vToverMap);
         break;
     case 3:
-        createToverMap3();
+        createToverMap3(vSlice, vToverMap);
         break;
     default:
         break;
     }
 }
 
-void B9Projector::createToverMap3()
+void B9Projector::createLevelBuckets(const QImage &vSlice, const QByteArray &vToverMap, QVector<int> &vLevelStart, QVector<int> &vLevelPixels)
 {
-    int width = mCurSliceImage.width();
-    int height = mCurSliceImage.height();
-    QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+    // Counting sort of the lit pixels by Tover level, pixels of level L are vLevelPixels[vLevelStart[L]] up to vLevelPixels[vLevelStart[L+1]]
+    int iSize = vSlice.width()*vSlice.height();
+    vLevelStart.fill(0, 257);
+    vLevelPixels.clear();
+    if(iSize<1 || vToverMap.size()<iSize) return;
+    const QRgb *pixels = (const QRgb *)vSlice.constScanLine(0);
+    const uchar *pMap = (const uchar *)vToverMap.constData();
+    int *pStart = vLevelStart.data();
+    for (int i = 0; i < iSize; i++)
+        if(qAlpha(pixels[i])>0) pStart[pMap[i]+1]++;
+    for (int l = 0; l < 256; l++)
+        pStart[l+1] += pStart[l];
+    vLevelPixels.resize(pStart[256]);
+    int *pPixels = vLevelPixels.data();
+    QVector<int> vNext(vLevelStart);
+    int *pNext = vNext.data();
+    for (int i = 0; i < iSize; i++)
+        if(qAlpha(pixels[i])>0) pPixels[pNext[pMap[i]]++] = i;
+}
+
+void B9Projector::createToverMap3(const QImage &vSlice, QByteArray &vToverMap)
+{
+    int width = vSlice.width();
+    int height = vSlice.height();
+    const QRgb *pixels = (const QRgb *)vSlice.constScanLine(0);
     double dBlobVal;
-    m_vToverMap.resize(width*height);
+    vToverMap.resize(width*height);
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
@@ -246,11 +288,11 @@ void B9Projector::createToverMap3()
                 //( 1, 2)
                 if(!(x>=width-1||y>=height-3)) if(qAlpha(pixels[(x + 1) + (y + 3)*width])==0) dBlobVal += 9.581825183;
 
-                m_vToverMap[x + y*width] = (uchar)dBlobVal;
+                vToverMap[x + y*width] = (uchar)dBlobVal;
             }
             else
             {
-                m_vToverMap[x + y*width] = (uchar)0;
+                vToverMap[x + y*width] = (uchar)0;
             }
         }
     }
@@ -258,13 +300,13 @@ void B9Projector::createToverMap3()
 
 
 
-void B9Projector::createToverMap2()
+void B9Projector::createToverMap2(const QImage &vSlice, QByteArray &vToverMap)
 {
-    int width = mCurSliceImage.width();
-    int height = mCurSliceImage.height();
-    QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+    int width = vSlice.width();
+    int height = vSlice.height();
+    const QRgb *pixels = (const QRgb *)vSlice.constScanLine(0);
     double dBlobVal;
-    m_vToverMap.resize(width*height);
+    vToverMap.resize(width*height);
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
@@ -323,26 +365,26 @@ void B9Projector::createToverMap2()
                 //( 1, 2)
                 if(!(x>=width-1||y>=height-2)) if(qAlpha(pixels[(x + 1) + (y + 2)*width])==0) dBlobVal += 16.04138272;
 
-                m_vToverMap[x + y*width] = (uchar)dBlobVal;
+                vToverMap[x + y*width] = (uchar)dBlobVal;
             }
             else
             {
-                m_vToverMap[x + y*width] = (uchar)0;
+                vToverMap[x + y*width] = (uchar)0;
             }
         }
     }
 }
 
 
-void B9Projector::createToverMap1()
+void B9Projector::createToverMap1(const QImage &vSlice, QByteArray &vToverMap)
 {
-    int width = mCurSliceImage.width();
-    int height = mCurSliceImage.height();
-    QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+    int width = vSlice.width();
+    int height = vSlice.height();
+    const QRgb *pixels = (const QRgb *)vSlice.constScanLine(0);
 
     double dBlobVal;
 
-    m_vToverMap.resize(width*height);
+    vToverMap.resize(width*height);
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
@@ -369,12 +411,12 @@ void B9Projector::createToverMap1()
                 //( 1, 1)
                 if(!(x>=width-1||y>=height-1)) if(qAlpha(pixels[(x + 1) + (y + 1)*width])==0) dBlobVal += 37.3138854;
 
-                m_vToverMap[x + y*width] = (uchar)dBlobVal;
+                vToverMap[x + y*width] = (uchar)dBlobVal;
 
             }
             else
             {
-                m_vToverMap[x + y*width] = (uchar)0;
+                vToverMap[x + y*width] = (uchar)0;
             }
         }
     }
@@ -382,16 +424,16 @@ void B9Projector::createToverMap1()
 
 
 
-void B9Projector::createToverMap0()
+void B9Projector::createToverMap0(const QImage &vSlice, QByteArray &vToverMap)
 {
     //Simple perimeter/empty center (255/0)
-    int width = mCurSliceImage.width();
-    int height = mCurSliceImage.height();
-    QRgb *pixels = (QRgb *)mCurSliceImage.scanLine(0);
+    int width = vSlice.width();
+    int height = vSlice.height();
+    const QRgb *pixels = (const QRgb *)vSlice.constScanLine(0);
 
 
     //Simple edge detection, set pixel to 255 if "next to"(above, below, left, right) a black pixel
-    m_vToverMap.resize(width*height);
+    vToverMap.resize(width*height);
     for (int y = 0; y < height; y++)
     {
         for (int x = 0; x < width; x++)
@@ -401,25 +443,25 @@ void B9Projector::createToverMap0()
 
                 if(y==0 || y==height-1 || x==0 || x==width-1) // first check if we're a border pixel, always set these
                 {
-                    m_vToverMap[x + y*width] = (uchar)255;
+                    vToverMap[x + y*width] = (uchar)255;
                 }
                 else if(    qBlue(pixels[(x + 1) + (y    )*width])==0 ||
                             qBlue(pixels[(x - 1) + (y    )*width])==0 ||
                             qBlue(pixels[(x    ) + (y + 1)*width])==0 ||
                             qBlue(pixels[(x    ) + (y - 1)*width])==0   )
                 {
-                    m_vToverMap[x + y*width] = (uchar)255;
-                    //qDebug() << x << ", " << y << " Value" << (uchar)m_vToverMap[x + y*width];
+                    vToverMap[x + y*width] = (uchar)255;
+                    //qDebug() << x << ", " << y << " Value" << (uchar)vToverMap[x + y*width];
                 }
                 else
                 {
-                    m_vToverMap[x + y*width] = (uchar)0;
-                    //qDebug() << x << ", " << y << " Value" << (uchar)m_vToverMap[x + y*width];
+                    vToverMap[x + y*width] = (uchar)0;
+                    //qDebug() << x << ", " << y << " Value" << (uchar)vToverMap[x + y*width];
                 }
             }
             else
             {
-                m_vToverMap[x + y*width] = (uchar)0;
+                vToverMap[x + y*width] = (uchar)0;
             }
         }
     }
@@ -480,43 +522,147 @@ void B9Projector::createNormalizedMask( double XYPS, double dZ, double dOhMM)
 {
     if(mpCPJ!=NULL)
         XYPS = mpCPJ->getXYPixelmm();
-    double xsqrmm, ysqrmm;
+
+    // The mask only depends on the window size and the optical parameters, reuse it when we can
+    QString sKey = QString("%1_%2_%3_%4_%5").arg(width()).arg(height()).arg(XYPS,0,'f',6).arg(dZ,0,'f',6).arg(dOhMM,0,'f',6);
+    if(s_NormalizedMaskCache.contains(sKey)){
+        m_NormalizedMask = s_NormalizedMaskCache.value(sKey);
+        return;
+    }
+    if(!loadNormalizedMask(sKey)){
+        computeNormalizedMask(XYPS, dZ, dOhMM);
+        saveNormalizedMask(sKey);
+    }
+    if(s_NormalizedMaskCache.size()>=MAXCACHEDMASKS) s_NormalizedMaskCache.clear();
+    s_NormalizedMaskCache.insert(sKey, m_NormalizedMask);
+}
+
+void B9Projector::computeNormalizedMask( double XYPS, double dZ, double dOhMM)
+{
+    int iWidth = width();
+    int iHeight = height();
     double zsqrmm = dZ*dZ;
     double Oh = dOhMM;
-    double Ol = width()*XYPS*0.5;
+    double Ol = iWidth*XYPS*0.5;
     double dDimRg = 255.0/sqrt(Ol*Ol + Oh*Oh + zsqrmm);
 
     //Here we create a gray scale mask to normalize the projector's output
-    m_NormalizedMask = QImage(width(),height(),QImage::Format_ARGB32_Premultiplied);
+    m_NormalizedMask = QImage(iWidth,iHeight,QImage::Format_ARGB32_Premultiplied);
     m_NormalizedMask.fill(qRgba(0,0,0,0));
+    if(iWidth<1 || iHeight<1) return;
+
+    // The distance is separable in x and y, so the x squared terms are computed once per column
+    QVector<double> vXsqrmm(iWidth);
+    QVector<double> vRow(iWidth);
+    double* pXsqrmm = vXsqrmm.data();
+    double* pRow = vRow.data();
+    double d;
+    for (int x = 0; x < iWidth; ++x){
+        d = -Ol + (double)x*0.1;
+        pXsqrmm[x] = d*d;
+    }
+
+    int igs;
+    for (int y = 0; y < iHeight; ++y) {
+        d = Oh - (double)y*0.1;
+        double dYZsqrmm = d*d + zsqrmm;
+        // branch free so the compiler can vectorize the row
+        for (int x = 0; x < iWidth; ++x)
+            pRow[x] = sqrt(pXsqrmm[x] + dYZsqrmm)*dDimRg;
+
+        QRgb *scanLine = (QRgb *)m_NormalizedMask.scanLine(y);
+        for (int x = 0; x < iWidth; ++x){
+            igs = (int)pRow[x];
+            scanLine[x] = qRgba(igs,igs,igs,255);
+        }
+    }
+}
+
+QString B9Projector::normalizedMaskFileName(QString sKey)
+{
+    QString sPath = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+    if(sPath.isEmpty()) return "";
+    QDir().mkpath(sPath);
+    return sPath + "/NormalizedMask_" + sKey + ".b9n";
+}
+
+bool B9Projector::loadNormalizedMask(QString sKey)
+{
+    QString sFile = normalizedMaskFileName(sKey);
+    if(sFile.isEmpty()) return false;
+    QFile inFile(sFile);
+    if(!inFile.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&inFile);
+    quint32 uMagic, uWidth, uHeight;
+    QByteArray baGray;
+    in >> uMagic >> uWidth >> uHeight >> baGray;
+    inFile.close();
+    if(uMagic != MASKFILEMAGIC || (int)uWidth != width() || (int)uHeight != height() ||
+       baGray.size() != (int)(uWidth*uHeight)) return false;
+
+    // We only store the gray level, expand it back out to the ARGB mask
+    m_NormalizedMask = QImage(uWidth,uHeight,QImage::Format_ARGB32_Premultiplied);
+    const uchar* pGray = (const uchar*)baGray.constData();
     int igs;
-    for (quint32 y = 0; y < (quint32)m_NormalizedMask.height(); ++y) {
+    for (quint32 y = 0; y < uHeight; ++y) {
         QRgb *scanLine = (QRgb *)m_NormalizedMask.scanLine(y);
-        for (quint32 x = 0; x < (quint32)m_NormalizedMask.width(); ++x){
-            xsqrmm = pow((-Ol + (double)x*0.1),2.0);
-            ysqrmm = pow(( Oh - (double)y*0.1),2.0);
-            igs = sqrt(xsqrmm+ysqrmm+zsqrmm)*dDimRg;
+        for (quint32 x = 0; x < uWidth; ++x){
+            igs = pGray[x + y*uWidth];
             scanLine[x] = qRgba(igs,igs,igs,255);
         }
     }
+    return true;
+}
+
+void B9Projector::saveNormalizedMask(QString sKey)
+{
+    QString sFile = normalizedMaskFileName(sKey);
+    if(sFile.isEmpty() || m_NormalizedMask.isNull()) return;
+    quint32 uWidth = m_NormalizedMask.width();
+    quint32 uHeight = m_NormalizedMask.height();
+    QByteArray baGray;
+    baGray.resize(uWidth*uHeight);
+    uchar* pGray = (uchar*)baGray.data();
+    for (quint32 y = 0; y < uHeight; ++y) {
+        const QRgb *scanLine = (const QRgb *)m_NormalizedMask.constScanLine(y);
+        for (quint32 x = 0; x < uWidth; ++x)
+            pGray[x + y*uWidth] = (uchar)qBlue(scanLine[x]);
+    }
+
+    QFile outFile(sFile);
+    if(!outFile.open(QIODevice::WriteOnly)) return;
+    QDataStream out(&outFile);
+    out << (quint32)MASKFILEMAGIC << uWidth << uHeight << baGray;
+    outFile.close();
 }
 
 void B9Projector::drawCBM()
 {
     if(mpCPJ==NULL) return;
-    if(m_iLevel<0)  // Only inflate and normalize the slice if we've not started clearing it
+    if(m_iLevel<0 && fetchCachedFrame())
+    {
+        // Pre-rendered, the slice, Tover buckets and normalization are already done
+    }
+    else if(m_iLevel<0)  // Only inflate and normalize the slice if we've not started clearing it
     {
         // Here we inflate the slice
-
+        QElapsedTimer vTimer;
+        vTimer.start();
         mCurSliceImage = QImage(width(),height(),QImage::Format_ARGB32_Premultiplied);
         mCurSliceImage.fill(qRgba(0,0,0,0));
-        mpCPJ->inflateCurrentSlice(&mCurSliceImage, m_xOffset, m_yOffset);
+        mpCPJ->inflateSlice(mpCPJ->getCurrentSlice(), &mCurSliceImage, m_xOffset, m_yOffset); // on a copy, the frame cache's workers may be reading the same slices
+        m_FrameTiming.dInflateMS = vTimer.nsecsElapsed()/1000000.0;
+        vTimer.restart();
         createToverMap(3);  //calculate effect of pixels up to a radius of 3 pixel's away.
+        m_FrameTiming.dToverMapMS = vTimer.nsecsElapsed()/1000000.0;
+        vTimer.restart();
 
         // Here we copy the gray scale over using the slice as a mask
         QPainter mPainter(&mCurSliceImage);
         mPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
         mPainter.drawImage(0,0,m_NormalizedMask);
+        mPainter.end();
+        m_FrameTiming.dMaskMS = vTimer.nsecsElapsed()/1000000.0;
     }
 
     // Here we copy the resulting normalized slice to the mImage
@@ -525,11 +671,37 @@ void B9Projector::drawCBM()
     mPainter2.drawImage(0,0,mCurSliceImage);
 }
 
+bool B9Projector::fetchCachedFrame()
+{
+    if(m_pFrameCache==NULL) return false;
+    if(!m_pFrameCache->isValidFor(mpCPJ, size(), m_xOffset, m_yOffset, m_NormalizedMask)){
+        // Recreated or resized since the frames were rendered, so none of them fit any more
+        if(m_pFrameCache->rebuildFor(mpCPJ, size(), m_xOffset, m_yOffset, m_NormalizedMask, mpCPJ->getCurrentSlice()+1))
+            qDebug() << "Frame Cache:  Projector geometry changed, re-rendering from layer" << mpCPJ->getCurrentSlice()+1;
+        return false;  // this layer is rendered live
+    }
+    QElapsedTimer vTimer;
+    vTimer.start();
+    B9RenderedFrame vFrame;
+    if(!m_pFrameCache->fetchFrame(mpCPJ->getCurrentSlice(), &vFrame)) return false;
+    mCurSliceImage = vFrame.vSlice;
+    m_vLevelStart = vFrame.vLevelStart;
+    m_vLevelPixels = vFrame.vLevelPixels;
+    m_vToverMap.clear(); // not needed, clearing works from the buckets
+    m_FrameTiming.dFetchMS = vTimer.nsecsElapsed()/1000000.0;
+    return true;
+}
+
 void B9Projector::paintEvent (QPaintEvent * pEvent)
 {
+    QElapsedTimer vTimer;
+    vTimer.start();
 	QPainter painter(this);
 	QRect dirtyRect = pEvent->rect();
 	painter.drawImage(dirtyRect, mImage, dirtyRect);
+    painter.end();
+    double dPaintMS = vTimer.nsecsElapsed()/1000000.0;
+    if(dPaintMS > m_FrameTiming.dPaintMS) m_FrameTiming.dPaintMS = dPaintMS;
 }
 
 void B9Projector::keyReleaseEvent(QKeyEvent * pEvent)
@@ -44,7 +44,26 @@
 #include <QImage>
 #include <QColor>
 #include <QByteArray>
+#include <QHash>
+#include <QVector>
 #include "crushbitmap.h"
+#include "b9framecache.h"
+
+// Where the projector spent its time on the current layer, in milliseconds
+struct B9FrameTiming {
+    B9FrameTiming(){dFetchMS=dInflateMS=dToverMapMS=dMaskMS=dDrawMS=dClearMS=dPaintMS=0.0; iClears=0;}
+    double dFetchMS;     // unpacking a pre-rendered frame, zero if the frame was rendered here
+    double dInflateMS;   // inflating the crushed slice
+    double dToverMapMS;  // building the Tover map and its level buckets
+    double dMaskMS;      // applying the normalization mask
+    double dDrawMS;      // composing the first full frame, includes the three above
+    double dClearMS;     // total spent clearing Tover levels and recomposing
+    double dPaintMS;     // worst repaint of the window
+    int iClears;         // number of Tover levels cleared
+};
+
+#define MAXCACHEDMASKS 8        // normalized masks kept in memory, one per screen geometry is typical
+#define MASKFILEMAGIC 0xB94D0001 // identifies a normalized mask cache file
 
 class B9Projector : public QWidget
 {
@@ -67,6 +86,17 @@ public slots:
     void setXoff(int xOff){m_xOffset = xOff;drawAll();} // x offset for layer image
     void setYoff(int yOff){m_yOffset = yOff;drawAll();} // y offset for layer image
     void createNormalizedMask(double XYPS=0.1, double dZ = 257.0, double dOhMM = 91.088); //call when we show or resize
+    void setFrameCache(B9FrameCache* pCache){m_pFrameCache = pCache;} // pre-rendered frames to use when they match, NULL for none
+
+public:
+    B9FrameTiming getFrameTiming(){return m_FrameTiming;} // timing since the last slice was set
+    int getXoff(){return m_xOffset;}
+    int getYoff(){return m_yOffset;}
+    QImage getNormalizedMask(){return m_NormalizedMask;}
+
+    // The Tover map and level buckets for a slice, shared with the frame cache's worker threads
+    static void createToverMap(int iRadius, const QImage &vSlice, QByteArray &vToverMap);
+    static void createLevelBuckets(const QImage &vSlice, const QByteArray &vToverMap, QVector<int> &vLevelStart, QVector<int> &vLevelPixels);
 
 signals:
     void eventHiding();             // signal to the parent that we are being hidden
@@ -89,10 +119,17 @@ private:
 	void drawStatusMsg();	// draws the current status msg on the projector screen
 	void drawCBM();			// draws the current CBM pointed to by mpCBM, returns if mpCBM is null
 
-    void createToverMap0();
-    void createToverMap1();
-    void createToverMap2();
-    void createToverMap3();
+    bool fetchCachedFrame();  // takes the current slice from m_pFrameCache, false if it's not there
+
+    static void createToverMap0(const QImage &vSlice, QByteArray &vToverMap);
+    static void createToverMap1(const QImage &vSlice, QByteArray &vToverMap);
+    static void createToverMap2(const QImage &vSlice, QByteArray &vToverMap);
+    static void createToverMap3(const QImage &vSlice, QByteArray &vToverMap);
+
+    void computeNormalizedMask(double XYPS, double dZ, double dOhMM);
+    QString normalizedMaskFileName(QString sKey);   // disk cache location for the mask, empty if none available
+    bool loadNormalizedMask(QString sKey);          // returns false if no valid cached mask was found
+    void saveNormalizedMask(QString sKey);
 	
     bool m_bIsPrintWindow;  // set to true if we lock the window to full screen when shown
     bool m_bGrid;			// if true, grid is to be drawn
@@ -101,9 +138,14 @@ private:
     QImage mCurSliceImage;  // Current Normalized slice, possible that has some or all pixels cleared
     int m_iLevel;
     QImage m_NormalizedMask;
+    static QHash<QString, QImage> s_NormalizedMaskCache; // masks shared by all projector windows, keyed by size and optics
 	QString mStatusMsg;
 	int m_xOffset, m_yOffset;
     QByteArray m_vToverMap;
+    QVector<int> m_vLevelStart;     // 257 entries, where each Tover level starts in m_vLevelPixels
+    QVector<int> m_vLevelPixels;    // offsets of the lit pixels in mCurSliceImage, sorted by Tover level
+    B9FrameCache* m_pFrameCache;
+    B9FrameTiming m_FrameTiming;
 
 };
 
@@ -42,36 +42,18 @@
 #include <QDesktopWidget>
 #include <QtGui/QWidget>
 #include <QHideEvent>
-#include <QTimer>
-#include <QTime>
-#include "b9printercomm.h"
+#include "b9printer.h"
 #include "logfilemanager.h"
-#include "b9projector.h"
-#include "b9matcat.h"
-
-
-class PCycleSettings {
-public:
-    PCycleSettings(){loadSettings();}
-    ~PCycleSettings(){}
-    void updateValues(); // Opens a dialog and allows user to change settings
-
-    void loadSettings();
-    void saveSettings();
-    void setFactorySettings();
-    int m_iRSpd1, m_iLSpd1, m_iRSpd2, m_iLSpd2;
-    int m_iOpenSpd1, m_iCloseSpd1, m_iOpenSpd2, m_iCloseSpd2;
-    double m_dBreatheClosed1, m_dSettleOpen1, m_dBreatheClosed2, m_dSettleOpen2;
-    double m_dOverLift1, m_dOverLift2;
-    double m_dBTClearInMM;
-    double m_dHardZDownMM;
-    double m_dZFlushMM;
-};
 
 namespace Ui {
 class B9Terminal;
 }
 
+/******************************************************
+B9Terminal is the manual control panel for a B9Printer.
+It owns the printer and passes the rc calls through, so
+callers that only need a printer should use getPrinter().
+******************************************************/
 class B9Terminal : public QWidget
 {
     Q_OBJECT
@@ -80,55 +62,67 @@ public:
     explicit B9Terminal(QWidget *parent = 0, Qt::WFlags flags = Qt::Widget);
     ~B9Terminal();
 
-    bool isConnected(){return pPrinterComm->isConnected();}
+    B9Printer* getPrinter(){return m_pPrinter;}
+    bool isConnected(){return m_pPrinter->isConnected();}
 
-    double getHardZDownMM(){return pSettings->m_dHardZDownMM;}
-    double getZFlushMM(){return pSettings->m_dZFlushMM;}
+    double getHardZDownMM(){return m_pPrinter->getHardZDownMM();}
+    double getZFlushMM(){return m_pPrinter->getZFlushMM();}
 
-    int getEstBaseCycleTime(int iCur, int iTgt);
-    int getEstNextCycleTime(int iCur, int iTgt);
-    int getEstFinalCycleTime(int iCur, int iTgt);
+    int getEstBaseCycleTime(int iCur, int iTgt){return m_pPrinter->getEstBaseCycleTime(iCur, iTgt);}
+    int getEstNextCycleTime(int iCur, int iTgt){return m_pPrinter->getEstNextCycleTime(iCur, iTgt);}
+    int getEstFinalCycleTime(int iCur, int iTgt){return m_pPrinter->getEstFinalCycleTime(iCur, iTgt);}
 
-    QTime getEstCompleteTime(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS);
-    int getEstCompleteTimeMS(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS);
-    int getLampAdjustedExposureTime(int iBaseTimeMS);
+    QTime getEstCompleteTime(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS){return m_pPrinter->getEstCompleteTime(iCurLayer, iTotLayers, dLayerThicknessMM, iExposeMS);}
+    int getEstCompleteTimeMS(int iCurLayer, int iTotLayers, double dLayerThicknessMM, int iExposeMS){return m_pPrinter->getEstCompleteTimeMS(iCurLayer, iTotLayers, dLayerThicknessMM, iExposeMS);}
+    int getLampAdjustedExposureTime(int iBaseTimeMS){return m_pPrinter->getLampAdjustedExposureTime(iBaseTimeMS);}
 
-    B9MatCat* getMatCat() {return m_pCatalog;}
+    B9MatCat* getMatCat() {return m_pPrinter->getMatCat();}
 
-    void setUsePrimaryMonitor(bool bFlag){m_bUsePrimaryMonitor=bFlag; }
-    bool getUsePrimaryMonitor(){return m_bUsePrimaryMonitor;}
-    void setPrintPreview(bool bFlag){m_bPrintPreview=bFlag; }
-    bool getPrintPreview(){return m_bPrintPreview;}
-    void createNormalizedMask(double XYPS=0.1, double dZ = 257.0, double dOhMM = 91.088); //call when we show or resize
+    void setUsePrimaryMonitor(bool bFlag){m_pPrinter->setUsePrimaryMonitor(bFlag);}
+    bool getUsePrimaryMonitor(){return m_pPrinter->getUsePrimaryMonitor();}
+    void setPrintPreview(bool bFlag){m_pPrinter->setPrintPreview(bFlag);}
+    bool getPrintPreview(){return m_pPrinter->getPrintPreview();}
+    void createNormalizedMask(double XYPS=0.1, double dZ = 257.0, double dOhMM = 91.088){m_pPrinter->createNormalizedMask(XYPS, dZ, dOhMM);} //call when we show or resize
 
-    int getXYPixelSize(){return pPrinterComm->getXYPixelSize();}
+    int getXYPixelSize(){return m_pPrinter->getXYPixelSize();}
 
     void setIsPrinting(bool bFlag){
         pPrinterComm->m_bIsPrinting = bFlag;}
 
+    // Timing of the most recent Base/Next/Final cycle, from command sent to 'F' received
+    int getLastCycleEstMS(){return m_pPrinter->getLastCycleEstMS();}
+    int getLastCycleMS(){return m_pPrinter->getLastCycleMS();}
+    B9FrameTiming getProjectorFrameTiming(){return m_pPrinter->getProjectorFrameTiming();}
+
+    // Pre-rendering of the print job's frames for the current projector, see B9FrameCache
+    void rcPreRenderFrames(CrushedPrintJob *pCPJ, int iLastLayer){m_pPrinter->rcPreRenderFrames(pCPJ, iLastLayer);}
+    void rcDropFrame(int iLayer){m_pPrinter->rcDropFrame(iLayer);} // layer has been printed
+    void rcCancelPreRender(){m_pPrinter->rcCancelPreRender();}
+
 public slots:
     void dlgEditMatCat();
 
-    void rcResetHomePos();
-    void rcResetCurrentPositionPU(int iCurPos);
-    void rcBasePrint(double dBaseMM); // Position for Base Layer Exposure.
-    void rcNextPrint(double dNextMM); // Position for Next Layer Exposure.
-    void rcFinishPrint(double dDeltaMM); // Calculates a final Z position at current + dDelta, closes vat, raises z, turns off projector.
-    void rcSTOP();
-    void rcCloseVat();
-    void rcSetWarmUpDelay(int iDelayMS);
-
-    void rcProjectorPwr(bool bPwrOn);
-    void rcSetCPJ(CrushedPrintJob *pCPJ); // Set the pointer to the CMB to be displayed, NULL if blank
-    void rcCreateToverMap(int iRadius){pProjector->createToverMap(iRadius);}
-    bool rcClearTimedPixels(int iLevel){return pProjector->clearTimedPixels(iLevel);}
-    void rcSetProjMessage(QString sMsg);
-    void rcGotoFillAfterReset(int iFillLevel);
+    void rcResetHomePos(){m_pPrinter->rcResetHomePos();}
+    void rcResetCurrentPositionPU(int iCurPos){m_pPrinter->rcResetCurrentPositionPU(iCurPos);}
+    void rcBasePrint(double dBaseMM){m_pPrinter->rcBasePrint(dBaseMM);} // Position for Base Layer Exposure.
+    void rcNextPrint(double dNextMM){m_pPrinter->rcNextPrint(dNextMM);} // Position for Next Layer Exposure.
+    void rcSetNextCycle(const B9CycleParams &vParams){m_pPrinter->rcSetNextCycle(vParams);}
+    void rcFinishPrint(double dDeltaMM){m_pPrinter->rcFinishPrint(dDeltaMM);} // Calculates a final Z position at current + dDelta, closes vat, raises z, turns off projector.
+    void rcSTOP(){m_pPrinter->rcSTOP();}
+    void rcCloseVat(){m_pPrinter->rcCloseVat();}
+    void rcSetWarmUpDelay(int iDelayMS){m_pPrinter->rcSetWarmUpDelay(iDelayMS);}
+
+    void rcProjectorPwr(bool bPwrOn){m_pPrinter->rcProjectorPwr(bPwrOn);}
+    void rcSetCPJ(CrushedPrintJob *pCPJ){m_pPrinter->rcSetCPJ(pCPJ);} // Set the pointer to the CMB to be displayed, NULL if blank
+    void rcCreateToverMap(int iRadius){m_pPrinter->rcCreateToverMap(iRadius);}
+    bool rcClearTimedPixels(int iLevel){return m_pPrinter->rcClearTimedPixels(iLevel);}
+    void rcSetProjMessage(QString sMsg){m_pPrinter->rcSetProjMessage(sMsg);}
+    void rcGotoFillAfterReset(int iFillLevel){m_pPrinter->rcGotoFillAfterReset(iFillLevel);}
 
     void showIt(){show();setEnabledWarned();}
-    void onScreenCountChanged(int iCount = 0);  // Signal that the number of monitors has changed
+    void onScreenCountChanged(int iCount = 0){m_pPrinter->onScreenCountChanged(iCount);}  // Signal that the number of monitors has changed
 
-    void updateCycleValues(){pSettings->updateValues();}
+    void updateCycleValues(); // Opens a dialog and allows user to change the cycle settings
 
 signals:
     void signalAbortPrint(QString sMessage);
@@ -138,36 +132,31 @@ signals:
     void updateProjectorStatus(QString sText);  // Projector Power Status Changes
     void updateProjector(B9PrinterStatus::ProjectorStatus eStatus);
     void PrintReleaseCycleFinished();
-
     void sendStatusMsg(QString text);					// signal to the Projector window to change the status msg
-    void sendGrid(bool bshow);							// signal to the Projector window to update the grid display
-    void sendCPJ(CrushedPrintJob * pCPJ);				// signal to the Projector window to show a crushed bit map image
-    void sendXoff(int xOff);							// signal to the Projector window to update the X offset
-    void sendYoff(int yOff);							// signal to the Projector window to update the Y offset
 
     void eventHiding();
 
 private slots:
-    void makeProjectorConnections();
-    void getKey(int iKey);					    // Signal that we received a (released) key from the projector
-
+    void onProjectorKey(int iKey);               // Signal that we received a (released) key from the projector
+    void onSingleMonitorWarning();
+    void onRequestFocus(){activateWindow();}
 
     void on_pushButtonProjPower_toggled(bool checked);  //Remote slot for turning projector on/off
     void on_pushButtonCmdReset_clicked(); // Remote slot for commanding Reset (find home) motion
     void sendCommand();
-    void setProjectorPowerCmd(bool bPwrFlag); // call to send projector power on/off command
-    void onUpdateConnectionStatus(QString sText);
     void onBC_ConnectionStatusDetailed(QString sText);
     void onUpdatePrinterComm(QString sText);
     void onUpdateRAWPrinterComm(QString sText);
-    void onBC_LostCOMM();
-    void onBC_ProjStatusChanged();
-    void onBC_ProjStatusFAIL();
+    void onProjectorPowerCmd(bool bOn);
+    void onProjectorStatusText(QString sText);
 
-    void onMotionResetTimeout();
+    void onMotionResetStarted();
     void onMotionResetComplete();
+    void onMotionResetTimeout();
 
+    void onVatBusy(bool bBusy);
     void onMotionVatTimeout();
+    void onCycleStatus(QString sText, bool bBusy);
 
     void onBC_ModelInfo(QString sModel);
     void onBC_FirmVersion(QString sVersion);
@@ -182,12 +171,10 @@ private slots:
     void onBC_NativeY(int iNY);
     void onBC_XYPixelSize(int iPS);
 
-    void setTgtAltitudePU(int iTgtPU);
-    void setTgtAltitudeMM(double iTgtMM);
-    void setTgtAltitudeIN(double iTgtIN);
-
-    void onBC_PrintReleaseCycleFinished();
-    void onReleaseCycleTimeout();
+    void onTgtAltitudeChanged(int iTgtPU);
+    void setTgtAltitudePU(int iTgtPU){m_pPrinter->setTgtAltitudePU(iTgtPU);}
+    void setTgtAltitudeMM(double dTgtMM){m_pPrinter->setTgtAltitudeMM(dTgtMM);}
+    void setTgtAltitudeIN(double dTgtIN){m_pPrinter->setTgtAltitudeMM(dTgtIN*25.4);}
 
     void on_lineEditTgtZPU_editingFinished();
 
@@ -213,8 +200,6 @@ private slots:
 
     void on_pushButtonPrintFinal_clicked();
 
-    void SetCycleParameters();
-
     void on_pushButtonStop_clicked();
 
     void on_checkBoxVerbose_clicked(bool checked);
@@ -230,35 +215,14 @@ private:
     Ui::B9Terminal *ui;
     void hideEvent(QHideEvent *event);
 
-    int getZMoveTime(int iDelta, int iSpd);
-    int getVatMoveTime(int iSpeed);
-
-    B9MatCat* m_pCatalog;
+    B9Printer *m_pPrinter;
+    B9PrinterComm *pPrinterComm;   // the printer's, for status
     QString m_sModelName;
-    PCycleSettings *pSettings;
-    int m_iD, m_iE, m_iJ, m_iK, m_iL, m_iW, m_iX;
-    void resetLastSentCycleSettings();
-
-    B9PrinterComm *pPrinterComm;
-    LogFileManager *pLogManager;
-    B9Projector *pProjector;
-    QDesktopWidget* m_pDesktop;
-    bool m_bPrimaryScreen;
-    bool m_bPrintPreview;
-    bool m_bUsePrimaryMonitor;
-
-    QTimer *m_pResetTimer;
-    QTimer *m_pPReleaseCycleTimer;
-    QTimer *m_pVatTimer;
-
-    int m_iFillLevel;
 
     void setEnabledWarned(); // Set the enabled status based on connection and user response
-    void warnSingleMonitor();
     bool m_bWaiverPresented;
     bool m_bWaiverAccepted;
     bool m_bWavierActive;
-    bool m_bNeedsWarned;
 };
 
 #endif // B9TERMINAL_H
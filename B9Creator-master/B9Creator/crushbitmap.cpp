@@ -112,6 +112,7 @@ CrushedBitMap::CrushedBitMap(QImage* pImage)
 {
 	mIndex = 0;
 	uiWhitePixels = 0;
+	m_xOffset = m_yOffset = 0;
 	crushSlice(pImage);
 	m_bIsBaseLayer=false;
 }
@@ -120,6 +121,7 @@ CrushedBitMap::CrushedBitMap(QPixmap* pPixmap)
 {
 	mIndex = 0;
 	uiWhitePixels = 0;
+	m_xOffset = m_yOffset = 0;
 	crushSlice(pPixmap);
 	m_bIsBaseLayer=false;
 }
@@ -227,6 +229,93 @@ void CrushedBitMap::inflateSlice(QImage* pImage, int xOffset, int yOffset, bool
 	return;
 }
 
+QSize CrushedBitMap::inflateRuns(SliceRuns* pRows)
+{
+	pRows->clear();
+	if(m_bIsBaseLayer) return QSize(m_iWidth, m_iHeight);
+
+	mIndex = 0; // Reset to start
+	m_iWidth = popBits(16);
+	m_iHeight = popBits(16);
+	if(m_iWidth<1 || m_iHeight<1) return QSize(0,0);
+	bool bCurColorIsWhite = (popBits(1)==1);
+	unsigned uImageSize = m_iWidth * m_iHeight;
+	unsigned uCurrentPos = 0;
+	pRows->resize(m_iHeight);
+
+	int iKey = popBits(5);
+	unsigned uData = popBits(iKey+1);
+	while((uData > 0) && (uCurrentPos < uImageSize)) {
+		unsigned uEnd = qMin(uCurrentPos + uData, uImageSize);
+		if(bCurColorIsWhite) {
+			// a run may carry on over several rows
+			for(unsigned uStart = uCurrentPos; uStart < uEnd; ) {
+				int y = uStart / m_iWidth;
+				unsigned uRowEnd = qMin(uEnd, (unsigned)(y+1)*m_iWidth);
+				(*pRows)[y] << (int)(uStart - y*m_iWidth) << (int)(uRowEnd - y*m_iWidth);
+				uStart = uRowEnd;
+			}
+		}
+		uCurrentPos = uEnd;
+		iKey = popBits(5);
+		uData = popBits(iKey+1);
+		bCurColorIsWhite = !bCurColorIsWhite;
+	}
+	return QSize(m_iWidth, m_iHeight);
+}
+
+bool CrushedBitMap::crushRuns(int iWidth, int iHeight, const SliceRuns &vRows)
+{
+	// Stores what crushSlice would for an image lit on these runs
+	m_iWidth = iWidth;
+	m_iHeight = iHeight;
+	uiWhitePixels = 0;
+	if (mBitarray.size()>0) mBitarray.resize(0);
+	mIndex = 0;
+	mExtents.setBottomRight(QPoint(0,0));
+	mExtents.setTopLeft(QPoint(iWidth,iHeight));
+	pushBits(iWidth,16);
+	pushBits(iHeight,16);
+
+	// The lit runs as positions in the whole image, joining those that carry on into the next row
+	QVector<unsigned> vRuns;
+	for(int y=0; y<iHeight && y<vRows.count(); y++) {
+		const QVector<int> &vRow = vRows[y];
+		for(int r=0; r+1<vRow.count(); r+=2) {
+			if(vRow[r] >= vRow[r+1]) continue;
+			unsigned uStart = y*iWidth + vRow[r];
+			unsigned uEnd = y*iWidth + vRow[r+1];
+			if(!vRuns.isEmpty() && vRuns.last() == uStart) vRuns.last() = uEnd;
+			else vRuns << uStart << uEnd;
+			uiWhitePixels += vRow[r+1] - vRow[r];
+			if(vRow[r]   < mExtents.left()  ) mExtents.setLeft(vRow[r]);
+			if(vRow[r+1]-1 > mExtents.right() ) mExtents.setRight(vRow[r+1]-1);
+			if(y > mExtents.bottom()) mExtents.setBottom(y);
+			if(y < mExtents.top()   ) mExtents.setTop(y);
+		}
+	}
+
+	// The alternating run lengths, starting with the color of the first pixel
+	unsigned uImageSize = iWidth * iHeight;
+	QVector<unsigned> vLengths;
+	unsigned uCurrentPos = 0;
+	for(int r=0; r<vRuns.count(); r+=2) {
+		if(vRuns[r] > uCurrentPos) vLengths << vRuns[r] - uCurrentPos;
+		vLengths << vRuns[r+1] - vRuns[r];
+		uCurrentPos = vRuns[r+1];
+	}
+	if(uCurrentPos < uImageSize || vLengths.isEmpty()) vLengths << uImageSize - uCurrentPos;
+	pushBits(!vRuns.isEmpty() && vRuns[0] == 0, 1);
+
+	for(int i=0; i<vLengths.count(); i++) {
+		int iKey = computeKeySize(vLengths[i]);
+		if(iKey<0) return false;
+		pushBits(iKey, 5);
+		pushBits(vLengths[i], iKey+1);
+	}
+	return true;
+}
+
 void CrushedBitMap::setWhiteImagePixel(QImage* pImage, unsigned uCurPos)
 {
 	// define a white pixel
@@ -333,7 +422,7 @@ void CrushedBitMap::pushBits(int iValue, int iBits)
 	//  iBits should always be smaller than 33
 	if (mIndex + iBits > mBitarray.size()) mBitarray.resize(mIndex + iBits);
     for (int i=iBits-1; i>=0; i--) {
-		mBitarray.setBit(mIndex, iValue & (int)qPow(2.0,i));
+		mBitarray.setBit(mIndex, (iValue >> i) & 1);
 		mIndex++;
 	}
 }
@@ -368,18 +457,18 @@ bool CrushedBitMap::isWhitePixel(QPoint qPoint){
 	bCurColorIsWhite = (popBits(1)==1);
 	uImageSize = m_iWidth * m_iHeight;
 
+	int x = qPoint.x() - m_xOffset;
+	int y = qPoint.y() - m_yOffset;
+	if(x < 0 || y < 0 || x >= m_iWidth || y >= m_iHeight) return false;
+	unsigned uPointPos = y*m_iWidth + x;
+
 	iKey = popBits(5);
 	uData = popBits(iKey+1);
-	int x, y;
 
 	while((uData > 0) && (uCurrentPos < uImageSize)) {
-		for(unsigned ui=0; ui<uData; ui++) {
-
-			y = (uCurrentPos / m_iWidth) + m_yOffset;
-			x = (uCurrentPos - y*m_iWidth) + m_xOffset;
-			if(qPoint == QPoint(x,y)) return bCurColorIsWhite;
-			uCurrentPos++;
-		}
+		// skip whole runs until we get to the one holding the point
+		if(uPointPos < uCurrentPos + uData) return bCurColorIsWhite;
+		uCurrentPos += uData;
 		// pop length of next run of pixels
 		iKey = popBits(5);
 		uData = popBits(iKey+1);
@@ -527,6 +616,55 @@ uint CrushedPrintJob::getTotalWhitePixels(int iFirst, int iLast)
 	return iTotal;
 }
 
+uint CrushedPrintJob::getWhitePixels(int iSlice)
+{
+    if(iSlice<0 || iSlice>=getTotalLayers()) return 0;
+    if(iSlice>=mBase) return mSlices[iSlice-mBase].getWhitePixels();
+    if(iSlice<mFilled) return mJobExtents.width()*mJobExtents.height();
+    return 0;
+}
+
+QRect CrushedPrintJob::getExtents(int iSlice)
+{
+    if(iSlice<0 || iSlice>=getTotalLayers()) return QRect();
+    if(iSlice>=mBase) return mSlices[iSlice-mBase].getExtents();
+    if(iSlice<mFilled) return mJobExtents;
+    return QRect();
+}
+
+// Length of the pixels lit in one of two rows of runs but not the other
+static uint runsDifference(const QVector<int> &vA, const QVector<int> &vB)
+{
+    uint uLitA = 0, uLitB = 0, uBoth = 0;
+    for(int a=0; a+1<vA.count(); a+=2) uLitA += vA[a+1] - vA[a];
+    for(int b=0; b+1<vB.count(); b+=2) uLitB += vB[b+1] - vB[b];
+    int a = 0, b = 0;
+    while(a+1<vA.count() && b+1<vB.count()) {
+        int iStart = qMax(vA[a], vB[b]);
+        int iEnd = qMin(vA[a+1], vB[b+1]);
+        if(iEnd > iStart) uBoth += iEnd - iStart;
+        if(vA[a+1] < vB[b+1]) a+=2; else b+=2;
+    }
+    return uLitA + uLitB - 2*uBoth;
+}
+
+uint CrushedPrintJob::getEdgePixels(int iSlice)
+{
+    if(iSlice<0 || iSlice>=getTotalLayers()) return 0;
+    if(iSlice<mBase) return iSlice<mFilled ? 2*(mJobExtents.width()+mJobExtents.height()) : 0;
+
+    SliceRuns vRows;
+    inflateRuns(copySlice(iSlice), &vRows);
+    uint uEdges = 0;
+    QVector<int> vNone;
+    for(int y=0; y<=vRows.count(); y++) {
+        const QVector<int> &vRow = y<vRows.count() ? vRows[y] : vNone;
+        uEdges += (vRow.count()/2)*2;  // the two ends of each run
+        uEdges += runsDifference(vRow, y>0 ? vRows[y-1] : vNone);  // lit above or below but not both
+    }
+    return uEdges;
+}
+
 void CrushedPrintJob::clearAll(int iLayers) {
     mTotalWhitePixels=0;
 	mBase=0; 
@@ -548,6 +686,35 @@ void CrushedPrintJob::clearAll(int iLayers) {
 }
 
 void CrushedPrintJob::inflateCurrentSlice(QImage* pImage, int xOffset, int yOffset, bool bUseNaturalSize) {
+    if(m_CurrentSlice < 0 || m_CurrentSlice >= getTotalLayers()) return;
+
+	getCBMSlice(m_CurrentSlice)->inflateSlice(pImage, xOffset, yOffset, bUseNaturalSize);
+    renderSliceExtras(m_CurrentSlice, pImage, xOffset, yOffset);
+}
+
+void CrushedPrintJob::inflateSlice(int iSlice, QImage* pImage, int xOffset, int yOffset) {
+    if(iSlice < 0 || iSlice >= getTotalLayers()) return;
+
+    // inflating moves the CBM's read index, so we work on a copy (the bit array itself is shared, not copied)
+    CrushedBitMap CBM = copySlice(iSlice);
+    CBM.inflateSlice(pImage, xOffset, yOffset);
+    renderSliceExtras(iSlice, pImage, xOffset, yOffset);
+}
+
+CrushedBitMap CrushedPrintJob::copySlice(int iSlice) {
+    CrushedBitMap CBM;
+    if(iSlice>=mBase && iSlice<getTotalLayers())
+        CBM = mSlices[iSlice-mBase];
+    else {
+        // blank base layers are not stored, fake one like getCBMSlice does
+        CBM.setWidth(m_Width);
+        CBM.setHeight(m_Height);
+        CBM.setIsBaseLayer(true);
+    }
+    return CBM;
+}
+
+void CrushedPrintJob::renderSliceExtras(int iSlice, QImage* pImage, int xOffset, int yOffset) {
 	float WinWidth;
 	float WinHeight;
 	float SliceWidth;
@@ -556,10 +723,6 @@ void CrushedPrintJob::inflateCurrentSlice(QImage* pImage, int xOffset, int yOffs
 	int heightOff;
 	SimpleSupport sSimple;
 
-    if(m_CurrentSlice < 0 || m_CurrentSlice >= getTotalLayers()) return;
-
-	getCBMSlice(m_CurrentSlice)->inflateSlice(pImage, xOffset, yOffset, bUseNaturalSize);
-
 	//Todo Render filled Extent && Supports
 	if(mShowSupports){
 		WinWidth = pImage->width()/2.0;
@@ -574,7 +737,7 @@ void CrushedPrintJob::inflateCurrentSlice(QImage* pImage, int xOffset, int yOffs
 		QRect rOffset = mJobExtents;
 		rOffset.moveCenter(rOffset.center() + QPoint(xOffset, yOffset));
 
-		if(m_CurrentSlice < mFilled){
+		if(iSlice < mFilled){
 			// Render extents if filled layer
 			QPainter tPainter(pImage);
 			tPainter.setPen(QColor(255,255,255));
@@ -585,12 +748,11 @@ void CrushedPrintJob::inflateCurrentSlice(QImage* pImage, int xOffset, int yOffs
 		else {
 			// Render Supports
 			//Loop through supports list, if current slice has support, draw it
-			for(int i=0; i<mSupports.size(); i++){
-				if((m_CurrentSlice<mBase && mSupports[i].getStart()==0)||(m_CurrentSlice >= mSupports[i].getStart() + mBase && m_CurrentSlice <= mSupports[i].getEnd() + mBase)){
-					sSimple = mSupports[i];
-					sSimple.setPoint(sSimple.getPoint()+QPoint(xOffset, yOffset));
-					sSimple.draw(pImage);
-				}
+			QList<SimpleSupport> vSupports = getSupports(iSlice);
+			for(int i=0; i<vSupports.size(); i++){
+				sSimple = vSupports[i];
+				sSimple.setPoint(sSimple.getPoint()+QPoint(xOffset, yOffset));
+				sSimple.draw(pImage);
 			}
 		}
 	}	
@@ -599,18 +761,37 @@ void CrushedPrintJob::inflateCurrentSlice(QImage* pImage, int xOffset, int yOffs
 bool CrushedPrintJob::addImage(QImage* pImage){
 	CrushedBitMap CBM;
 	if(!CBM.crushSlice(pImage))return false;
-	
+	addCrushed(CBM);
+	return true;
+}
+
+bool CrushedPrintJob::crushImage(QImage* pImage, CrushedBitMap* pCBM){
+	return pCBM->crushSlice(pImage);
+}
+
+void CrushedPrintJob::addCrushed(const CrushedBitMap &crushed){
+	CrushedBitMap CBM = crushed;
+	growJob(&CBM);
+	addCBM(CBM);
+}
+
+void CrushedPrintJob::setCrushed(int iSlice, const CrushedBitMap &crushed){
+	if(iSlice < mBase || iSlice >= getTotalLayers()) return;
+	CrushedBitMap CBM = crushed;
+	growJob(&CBM);
+	mSlices[iSlice-mBase] = CBM;
+}
+
+void CrushedPrintJob::growJob(CrushedBitMap* pCBM){
 	// Update Extents
-	if(CBM.getExtents().left()   < mJobExtents.left()  ) mJobExtents.setLeft(  CBM.getExtents().left()); 		
-	if(CBM.getExtents().right()  > mJobExtents.right() ) mJobExtents.setRight( CBM.getExtents().right());
-	if(CBM.getExtents().bottom() > mJobExtents.bottom()) mJobExtents.setBottom(CBM.getExtents().bottom()); 
-	if(CBM.getExtents().top()    < mJobExtents.top()   ) mJobExtents.setTop(   CBM.getExtents().top());
+	if(pCBM->getExtents().left()   < mJobExtents.left()  ) mJobExtents.setLeft(  pCBM->getExtents().left()); 		
+	if(pCBM->getExtents().right()  > mJobExtents.right() ) mJobExtents.setRight( pCBM->getExtents().right());
+	if(pCBM->getExtents().bottom() > mJobExtents.bottom()) mJobExtents.setBottom(pCBM->getExtents().bottom()); 
+	if(pCBM->getExtents().top()    < mJobExtents.top()   ) mJobExtents.setTop(   pCBM->getExtents().top());
 	
 	// Update width and height
-	if(m_Width<CBM.getWidth())m_Width=CBM.getWidth();
-	if(m_Height<CBM.getHeight())m_Height=CBM.getHeight();
-	addCBM(CBM);
-	return true;
+	if(m_Width<pCBM->getWidth())m_Width=pCBM->getWidth();
+	if(m_Height<pCBM->getHeight())m_Height=pCBM->getHeight();
 }
 
 bool CrushedPrintJob::crushCurrentSlice(QImage* pImage){
@@ -629,7 +810,7 @@ bool CrushedPrintJob::isWhitePixel(QPoint qPoint, int iSlice){
 	return pCBM->isWhitePixel(qPoint);
 }
 
-void CrushedPrintJob::AddSupport(int iEndSlice, QPoint qCenter, int iSize, SupportType eType, int fastmode){
+SimpleSupport CrushedPrintJob::AddSupport(int iEndSlice, QPoint qCenter, int iSize, SupportType eType, int fastmode){
 	SimpleSupport support(qCenter, eType, iSize, 0-mBase, iEndSlice-mBase);
 	if(fastmode)
 	{
@@ -643,6 +824,28 @@ void CrushedPrintJob::AddSupport(int iEndSlice, QPoint qCenter, int iSize, Suppo
 		}
 	}
 	mSupports.append(support);
+	return support;
+}
+
+bool CrushedPrintJob::RemoveSupport(SimpleSupport support){
+	for(int i = mSupports.size()-1; i>=0; i--){
+		if(mSupports[i].getPoint() == support.getPoint() && mSupports[i].getStart() == support.getStart() && mSupports[i].getEnd() == support.getEnd()
+				&& mSupports[i].getSize() == support.getSize() && mSupports[i].getType() == support.getType())
+		{
+			mSupports.removeAt(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+QList<SimpleSupport> CrushedPrintJob::getSupports(int iSlice){
+	QList<SimpleSupport> vSupports;
+	for(int i=0; i<mSupports.size(); i++){
+		if((iSlice<mBase && mSupports[i].getStart()==0)||(iSlice >= mSupports[i].getStart() + mBase && iSlice <= mSupports[i].getEnd() + mBase))
+			vSupports.append(mSupports[i]);
+	}
+	return vSupports;
 }
 
 bool CrushedPrintJob::DeleteSupport(int iSlice, QPoint qCenter, int iRadius){
@@ -42,10 +42,14 @@
 #include <QPixmap>
 #include <QBitArray>
 #include <QFile>
+#include <QVector>
 
 
 enum SupportType {st_CIRCLE, st_SQUARE, st_TRIANGLE, st_DIAMOND};
 
+// A slice as lit runs: for every row, start and end (exclusive) x pairs, left to right
+typedef QVector< QVector<int> > SliceRuns;
+
 /******************************************************
 SimpleSupport is used to store and render simple
 support structures dynamically during slice decompression
@@ -67,6 +71,8 @@ public:
 	void setEnd(int end){mEnd = end;}
 	int getStart(){return mStart;}
 	int getEnd(){return mEnd;}
+	int getSize(){return mSize;}
+	SupportType getType(){return mType;}
 	QPoint getPoint(){return mPoint;}
 	QImage getCursorImage();
 
@@ -89,7 +95,7 @@ typically grouped together.
 class CrushedPrintJob;
 class CrushedBitMap {
 public:
-    CrushedBitMap() {mIndex = 0; uiWhitePixels=0;m_bIsBaseLayer=false; m_iWidth=0; m_iHeight=0;}
+    CrushedBitMap() {mIndex = 0; uiWhitePixels=0;m_bIsBaseLayer=false; m_iWidth=0; m_iHeight=0; m_xOffset=0; m_yOffset=0;}
 	CrushedBitMap(QImage* pImage);
 	CrushedBitMap(QPixmap* pPixmap);
     ~CrushedBitMap(){}
@@ -99,6 +105,8 @@ private:
 	bool crushSlice(QImage* pImage);
 	bool crushSlice(QPixmap* pPixmap);
 	void inflateSlice(QImage* pImage, int xOffset = 0, int yOffset = 0, bool bUseNaturalSize = false);
+	QSize inflateRuns(SliceRuns* pRows);
+	bool crushRuns(int iWidth, int iHeight, const SliceRuns &vRows);
 	bool saveCrushedBitMap(const QString &fileName);
 	void streamOutCMB(QDataStream* pOut);
 	bool loadCrushedBitMap(const QString &fileName);
@@ -139,6 +147,9 @@ public:
     int getTotalLayers() {return mSlices.size() + mBase;}  // total layers including the base standoff offset layers
     uint getTotalWhitePixels() {return mTotalWhitePixels;} // returns all white pixels (fast)
     uint getTotalWhitePixels(int iFirst, int iLast); // sums the layer range of white pixels (slower)
+    uint getWhitePixels(int iSlice);  // lit pixels of one layer, filled base layers count their extents, supports are not counted
+    QRect getExtents(int iSlice);     // bounding rectangle of those pixels, empty if none
+    uint getEdgePixels(int iSlice);   // pixel sides between lit and unlit in that layer, holes and islands included (inflates the rows)
 
 	bool loadCPJ(QFile* pFile); // returns false if unknown version or opening error
 	bool saveCPJ(QFile* pFile); // returns false if unable to write to file.
@@ -170,20 +181,42 @@ public:
     // inflates the raw image and then renders supports, filled base extents, etc.
 	void inflateCurrentSlice(QImage* pImage, int xOffset = 0, int yOffset = 0, bool bUseNaturalSize = false);
 
+    // render slice iSlice into pImage the same way as inflateCurrentSlice, but without touching any job state
+    // safe to call from several threads at once as long as nothing modifies the job meanwhile
+    void inflateSlice(int iSlice, QImage* pImage, int xOffset = 0, int yOffset = 0);
+
+    // a copy of slice iSlice's crushed data, cheap (the bit array is shared).  Taken on the thread that owns the job,
+    // it can then be inflated with inflateCopy on any thread while the job is edited
+    CrushedBitMap copySlice(int iSlice);
+    static void inflateCopy(CrushedBitMap CBM, QImage* pImage, int xOffset = 0, int yOffset = 0, bool bUseNaturalSize = false){CBM.inflateSlice(pImage, xOffset, yOffset, bUseNaturalSize);}
+    void renderSliceExtras(int iSlice, QImage* pImage, int xOffset, int yOffset);  // filled base extents and supports, what inflateCurrentSlice draws over the raw slice
+
     // attempts to replace the current slice with the crushed version of pImage stored at m_CurrentSlice.  Adjusts the job's width and height if needed
     bool crushCurrentSlice(QImage* pImage);
 
     // attempts to crushe and append pImage to the CBM array
     bool addImage(QImage* pImage);
 
+    // crushImage touches no job, so slices can be crushed on several threads and appended in order with addCrushed
+    static bool crushImage(QImage* pImage, CrushedBitMap* pCBM);
+    void addCrushed(const CrushedBitMap &CBM);
+
+    // The same as run lists, for work on whole rows without an image: inflateRuns on a copy
+    // returns the slice size, crushRuns touches no job and setCrushed puts the result back
+    static QSize inflateRuns(CrushedBitMap CBM, SliceRuns* pRows){return CBM.inflateRuns(pRows);}
+    static bool crushRuns(int iWidth, int iHeight, const SliceRuns &vRows, CrushedBitMap* pCBM){return pCBM->crushRuns(iWidth, iHeight, vRows);}
+    void setCrushed(int iSlice, const CrushedBitMap &CBM);  // replaces a slice above the base layers
+
     // Internal position index used for "current" function calls: m_CurrentSlice
     int getCurrentSlice() {return m_CurrentSlice;}
 	void setCurrentSlice(int iSlice) {m_CurrentSlice = iSlice;}
 
     // Manage job supports
-	void AddSupport(int iEndSlice, QPoint qCenter, int iSize = 10, SupportType eType=st_CIRCLE, int fastmode = true);
+	SimpleSupport AddSupport(int iEndSlice, QPoint qCenter, int iSize = 10, SupportType eType=st_CIRCLE, int fastmode = true); // returns the support added
     bool DeleteSupport(int iSlice, QPoint qCenter, int iRadius = 0);
+    bool RemoveSupport(SimpleSupport support);  // removes one support just like it, false if there is none
     void DeleteAllSupports(){mSupports.clear();}
+    QList<SimpleSupport> getSupports(int iSlice);  // the supports drawn on slice iSlice
 
 private:
     CrushedBitMap* getCBMSlice(int i);  // gets the zero based index CBM
@@ -196,6 +229,7 @@ private:
     QList <CrushedBitMap> mSlices;   // Slices, not including base offset layers
     QList <SimpleSupport> mSupports; // Supports to be rendered
     void addCBM(CrushedBitMap mCBM){mSlices.append(mCBM);}
+    void growJob(CrushedBitMap* pCBM);  // grows the job's extents and size to take in pCBM
 	uint mTotalWhitePixels;
 	QString mVersion, mName, mDescription, mXYPixel, mZLayer;
 	QString mReserved1, mReserved2, mReserved3, mReserved4, mReserved5;
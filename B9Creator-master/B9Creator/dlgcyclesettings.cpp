@@ -80,10 +80,20 @@ void DlgCycleSettings::updateDialog()
 
     ui->doubleSpinBoxHardZDown->setValue(m_pSettings->m_dHardZDownMM);
     ui->doubleSpinBoxZFlush->setValue(m_pSettings->m_dZFlushMM);
+
+    ui->checkBoxAreaAdaptive->setChecked(m_pSettings->m_CyclePlanner.isEnabled());
+    ui->plainTextEditAreaCurve->setPlainText(m_pSettings->m_CyclePlanner.curveText());
 }
 
-void DlgCycleSettings::stuffSettings()
+bool DlgCycleSettings::stuffSettings()
 {
+    QString sError;
+    if(!m_pSettings->m_CyclePlanner.setCurveText(ui->plainTextEditAreaCurve->toPlainText(), &sError)){
+        QMessageBox::warning(this, "Area Adaptive Release", sError);
+        return false;
+    }
+    m_pSettings->m_CyclePlanner.setEnabled(ui->checkBoxAreaAdaptive->isChecked());
+
     m_pSettings->m_iRSpd1 = ui->spinBoxRaiseSpd1->value();
     m_pSettings->m_iLSpd1 = ui->spinBoxLowerSpd1->value();
     m_pSettings->m_iCloseSpd1 = ui->spinBoxCloseSpd1->value();
@@ -104,11 +114,12 @@ void DlgCycleSettings::stuffSettings()
 
     m_pSettings->m_dHardZDownMM = ui->doubleSpinBoxHardZDown->value();
     m_pSettings->m_dZFlushMM = ui->doubleSpinBoxZFlush->value();
+    return true;
 }
 
 void DlgCycleSettings::on_buttonBox_accepted()
 {
-    stuffSettings();
+    if(!stuffSettings()) return;
     m_pSettings->saveSettings();
     close();
 }
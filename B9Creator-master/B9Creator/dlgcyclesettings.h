@@ -40,7 +40,7 @@
 #define DLGCYCLESETTINGS_H
 
 #include <QDialog>
-#include "b9terminal.h"
+#include "b9printer.h"
 
 namespace Ui {
 class DlgCycleSettings;
@@ -63,7 +63,7 @@ private:
     Ui::DlgCycleSettings *ui;
     PCycleSettings* m_pSettings;
     void updateDialog();
-    void stuffSettings();
+    bool stuffSettings(); // false if a value was rejected
 };
 
 #endif // DLGCYCLESETTINGS_H
@@ -40,6 +40,7 @@
 #include <QSettings>
 #include <QMessageBox>
 #include "dlgprintprep.h"
+#include "b9exposureplan.h"
 #include "ui_dlgprintprep.h"
 
 
@@ -172,7 +173,10 @@ void DlgPrintPrep::on_pushButtonResetPrintAll_clicked()
 void DlgPrintPrep::updateTimes()
 {
     QTime vTimeRemains, t;
-    int iTime = m_pTerminal->getEstCompleteTimeMS(0,m_iLastLayer,m_pCPJ->getZLayermm(),m_iTbaseMS+m_iToverMS);
+    // The same plan the print will index, so attach layers and planned cycles are counted
+    B9ExposurePlan vPlan;
+    vPlan.build(m_pTerminal->getPrinter(), m_pCPJ, m_iTbaseMS, m_iToverMS, m_iTattachMS, m_iNumAttach, m_iLastLayer, B9ExposurePlan::toverStepMS());
+    int iTime = (int)vPlan.totalMS();
     int iM = iTime/60000;
     int iH = iM/60;
     iM = (int)((double)iM+0.5) - iH*60;
@@ -37,6 +37,7 @@
 *************************************************************************************/
 
 #include "logfilemanager.h"
+#include "b9logwriter.h"
 #include <QTime>
 #include <QFile>
 #include <QTextStream>
@@ -45,62 +46,41 @@
 #include <QDebug>
 #include <QApplication>
 #include <QDesktopServices>
-
-bool bGlobalPrinting;
+#include <QSettings>
 
 QString sLogFileName;
+static B9LogWriter* s_pLogWriter = NULL;
+
 void messageHandler(QtMsgType type, const char *msg)
 {
-    QFile outFile(sLogFileName);
-    QTextStream ts;
-    QString txt;
-    txt = QDateTime::currentDateTime().toString("yy.MM.dd hh:mm:ss.zzz");
-    switch (type) {
-    case QtDebugMsg:
-        if(!bGlobalPrinting){
-            fprintf(stderr, "Debug: %s\n", msg);
-            txt += QString("  : %1").arg(msg);
-            outFile.open(QIODevice::WriteOnly | QIODevice::Append);
-            ts.setDevice(&outFile);
-            ts << txt << "\r" << endl;
-            outFile.close();
-        }
-        break;
-    case QtWarningMsg:
-        fprintf(stderr, "Warning: %s\n", msg);
-    break;
-    case QtCriticalMsg:
-        fprintf(stderr, "Critical: %s\n", msg);
-    break;
-    case QtFatalMsg:
-        fprintf(stderr, "Fatal: %s\n", msg);
-    }
-    if(type== QtFatalMsg)
+    // Cheap enough to leave on while printing, the writer thread does the file work
+    if(s_pLogWriter!=NULL) s_pLogWriter->post(type, msg);
+    else fprintf(stderr, "%s\n", msg);
+
+    if(type== QtFatalMsg){
+        if(s_pLogWriter!=NULL && !s_pLogWriter->flush())
+            fprintf(stderr, "%s\n", msg); // raised on the writer thread, the ring won't be drained again
         abort();
+    }
 }
 
 LogFileManager::LogFileManager(QString sLogFile, QString sHeader)
 {
-    bGlobalPrinting = false;
-    QFile::remove(sLogFile);
     sLogFileName = sLogFile;
 
-    QFile outFile(sLogFile);
-    outFile.open(QIODevice::WriteOnly | QIODevice::Append);
-    QTextStream ts(&outFile);
-    ts << sHeader << "\r\n\r" << endl;
-    outFile.close();
+    QSettings settings;
+    qint64 iMaxBytes = (qint64)settings.value("LogFileMaxKB",4096).toInt()*1024;
+    s_pLogWriter = new B9LogWriter(sLogFile, sHeader, iMaxBytes);
+    s_pLogWriter->start(QThread::LowPriority);
     qInstallMsgHandler(messageHandler);
 }
 
 LogFileManager::~LogFileManager()
 {
     qInstallMsgHandler(0);
-}
-
-void LogFileManager::setPrinting(bool bPrinting)
-{
-    bGlobalPrinting = bPrinting;
+    B9LogWriter* pWriter = s_pLogWriter;
+    s_pLogWriter = NULL;
+    delete pWriter; // stops the thread and writes out what is left
 }
 
 void LogFileManager::openLogFileInFolder()
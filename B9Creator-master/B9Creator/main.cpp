@@ -40,10 +40,27 @@
 #include <QSplashScreen>
 #include "b9nativeapp.h"
 #include "mainwindow.h"
+#include "b9firmwaresim.h"
+#include "b9printercomm.h"
 
 int main(int argc, char *argv[])
 {
     B9NativeApp a(argc, argv);
+
+    // "-simulate [timescale]" talks to a simulated printer on a pty instead of a B9Creator
+    B9FirmwareSim Simulator;
+    QStringList vArgs = a.arguments();
+    int iSim = vArgs.indexOf("-simulate");
+    if(iSim>=0){
+        bool bOk = false;
+        double dScale = vArgs.value(iSim+1).toDouble(&bOk);
+        if(bOk) Simulator.setTimeScale(dScale);
+        if(Simulator.openPort()){
+            B9PrinterComm::addVirtualPort(Simulator.portName(), Simulator.timeScale());
+            Simulator.start();
+        }
+    }
+
     MainWindow w;
     QPixmap pixmap(QCoreApplication::applicationDirPath()+"/"+"splash.png");
     QSplashScreen splash(pixmap,Qt::WindowStaysOnTopHint);
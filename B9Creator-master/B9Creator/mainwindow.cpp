@@ -158,7 +158,6 @@ void MainWindow::handleW4Hide()
 {
     this->show();  // Comment this out if not hiding mainwindow while showing this window
     ui->commandPrint->setChecked(false);
-    pLogManager->setPrinting(false);
     pTerminal->setIsPrinting(false);
 }
 
@@ -217,7 +216,28 @@ void MainWindow::on_commandPrint_clicked()
         int ret = msgBox.exec();
         if(ret==QMessageBox::No)return;
     }
+    pMW4->setJobFile(openFile);
 
+    // An interrupted print of this job can carry on where it stopped
+    B9PrintCheckpoint vCheckpoint;
+    if(B9PrintJournal::read(pMW4->getJournalFile(), &vCheckpoint) &&
+       QFileInfo(vCheckpoint.sJobFile).canonicalFilePath()==QFileInfo(openFile).canonicalFilePath()){
+        QMessageBox msgBox;
+        msgBox.setText("Resume Print?");
+        msgBox.setInformativeText("A print of this job stopped after layer "+QString::number(vCheckpoint.iLayer)+" of "+QString::number(vCheckpoint.iLastLayer)+
+                                  " ("+vCheckpoint.sState+", "+vCheckpoint.vTime.toString("MMM d hh:mm AP")+").\n\n"
+                                  "Do you wish to resume from layer "+QString::number(vCheckpoint.iLayer+1)+"?  The part is still on the build table so it will not be homed first.  "
+                                  "If the printer has been switched off since, the table must not have been moved.\n\n"
+                                  "Choose No to start over from the first layer.");
+        msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        msgBox.setDefaultButton(QMessageBox::Yes);
+        int ret = msgBox.exec();
+        if(ret==QMessageBox::Cancel)return;
+        if(ret==QMessageBox::Yes){
+            doResume(vCheckpoint);
+            return;
+        }
+    }
 
     m_pPrintPrep = new DlgPrintPrep(m_pCPJ, pTerminal, this);
     connect (m_pPrintPrep, SIGNAL(accepted()),this,SLOT(doPrint()));
@@ -229,9 +249,24 @@ void MainWindow::doPrint()
     // print using variables set by wizard...
     this->hide(); // Comment this out if not hiding mainwindow while showing this window
     pMW4->show();
-    pLogManager->setPrinting(false); // set to true to Stop logfile entries when printing
     pTerminal->setIsPrinting(true);
     pMW4->print3D(m_pCPJ, 0, 0, m_pPrintPrep->m_iTbaseMS, m_pPrintPrep->m_iToverMS, m_pPrintPrep->m_iTattachMS, m_pPrintPrep->m_iNumAttach, m_pPrintPrep->m_iLastLayer, m_pPrintPrep->m_bDryRun, m_pPrintPrep->m_bDryRun);
 
     return;
 }
+
+void MainWindow::doResume(B9PrintCheckpoint vCheckpoint)
+{
+    if(!pTerminal->isConnected()){
+        QMessageBox::information(this,"Resume Print","The B9Creator is not connected.");
+        return;
+    }
+    pTerminal->setIsPrinting(true);
+    if(!pMW4->resumePrint(m_pCPJ, vCheckpoint)){
+        pTerminal->setIsPrinting(false);
+        QMessageBox::information(this,"Resume Print","The saved checkpoint does not match this job file, it can not be resumed.");
+        return;
+    }
+    this->hide();
+    pMW4->show();
+}
@@ -90,6 +90,7 @@ private slots:
 
 private:
     void closeEvent ( QCloseEvent * event );
+    void doResume(B9PrintCheckpoint vCheckpoint);
     Ui::MainWindow *ui;
     LogFileManager *pLogManager;
     bool m_bOpenLogOnExit;
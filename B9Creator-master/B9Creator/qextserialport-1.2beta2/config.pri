@@ -0,0 +1,3 @@
+# B9Creator watches for printers being plugged in and pulled through the
+# enumerator's hotplug notifications, under linux these need udev (libudev-dev)
+QEXTSERIALPORT_WITH_UDEV = yes
@@ -155,15 +155,19 @@ QList<QextPortInfo> QextSerialEnumerator::getPorts()
 
 /*!
     Enable event-driven notifications of board discovery/removal.
+    Returns false if they could not be set up, the caller has to poll getPorts() instead.
 */
-void QextSerialEnumerator::setUpNotifications()
+bool QextSerialEnumerator::setUpNotifications()
 {
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC) && !(defined(Q_OS_LINUX) && !defined(QESP_NO_UDEV))
     qCritical("Notifications for *Nix/FreeBSD are not implemented yet");
 #endif
     Q_D(QextSerialEnumerator);
-    if (!d->setUpNotifications_sys(true))
+    if (!d->setUpNotifications_sys(true)) {
         QESP_WARNING("Setup Notification Failed...");
+        return false;
+    }
+    return true;
 }
 
 #include "moc_qextserialenumerator.cpp"
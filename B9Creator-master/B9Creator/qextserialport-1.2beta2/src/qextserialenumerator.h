@@ -55,7 +55,7 @@ public:
     ~QextSerialEnumerator();
 
     static QList<QextPortInfo> getPorts();
-    void setUpNotifications();
+    bool setUpNotifications();
 
 Q_SIGNALS:
     void deviceDiscovered(const QextPortInfo & info);